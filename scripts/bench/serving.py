@@ -0,0 +1,68 @@
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from onnx import load
+from refactor_graph.onnx import make_compiler
+import argparse
+import os
+import time
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Measure throughput of several executors driven by a Python thread pool."
+    )
+    parser.add_argument(
+        "--model", type=str, required=True, help="Path to the ONNX model file."
+    )
+    parser.add_argument(
+        "--threads",
+        type=int,
+        nargs="+",
+        default=[1, 2, 4, os.cpu_count()],
+        help="Thread counts to measure.",
+    )
+    parser.add_argument(
+        "--runs", type=int, default=32, help="Runs per thread for each measurement."
+    )
+    args = parser.parse_args()
+    print("arg setting: ", args)
+    return (
+        args.model,
+        sorted(set(args.threads)),
+        args.runs,
+    )
+
+
+def main():
+    model_path, threads, runs = parse_args()
+
+    model = load(model_path, load_external_data=False)
+    compiler = make_compiler(model, Path(model_path).parent.__str__())
+    executor = compiler.compile("cpu", "default", [])
+    for i, input in enumerate(compiler.zero_inputs()):
+        input[...] = np.random.random(input.shape).astype(input.dtype)
+        executor.set_input(i, input)
+    executor.run()
+
+    def serve(executor):
+        for _ in range(runs):
+            executor.run()
+
+    base = None
+    print(f"cpu count {os.cpu_count()}")
+    for n in threads:
+        # 分叉出的执行器共享权重，各自持有输入输出和栈
+        executors = [executor.fork() for _ in range(n)]
+        with ThreadPoolExecutor(max_workers=n) as pool:
+            begin = time.perf_counter()
+            list(pool.map(serve, executors))
+            elapsed = time.perf_counter() - begin
+        throughput = n * runs / elapsed
+        if base is None:
+            base = throughput / n
+        print(f"{n:>4} threads: {throughput:10.1f} runs/s, {throughput / base:5.2f}x")
+
+
+if __name__ == "__main__":
+    main()
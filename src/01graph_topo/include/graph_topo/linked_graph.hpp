@@ -39,6 +39,7 @@ namespace refactor::graph_topo {
         void eraseNode(Rc<Node>);
         size_t cleanup(bool useful(TE const &) = nullptr);
         bool sort();
+        bool reorder(std::vector<count_t> const &);
     };
 
     template<class TN, class TE>
@@ -231,6 +232,29 @@ namespace refactor::graph_topo {
         return true;
     }
 
+    // 按 `order` 重排节点，`order[i]` 是新的第 i 个节点原来的序号。
+    // 新的顺序不是拓扑序时不改变节点，返回 false。
+    LINKED_GRAPH_FN reorder(std::vector<count_t> const &order)->bool {
+        if (order.size() != _nodes.size()) { return false; }
+        std::vector<Rc<Node>> ans;
+        ans.reserve(_nodes.size());
+        std::unordered_set<Node *> mapped;
+        for (auto i : order) {
+            if (i >= _nodes.size()) { return false; }
+            auto const &n = _nodes[i];
+            if (mapped.contains(n.get()) ||
+                // ∃e ∈ n.inputs, e.source ∉ mapped
+                std::any_of(n->_inputs.begin(), n->_inputs.end(),
+                            [&mapped](auto const &e) { return e && e->_source && !mapped.contains(e->_source.get()); })) {
+                return false;
+            }
+            mapped.insert(n.get());
+            ans.push_back(n);
+        }
+        _nodes = std::move(ans);
+        return true;
+    }
+
     LINKED_GRAPH_FN Node::share(TN info, std::vector<Rc<Edge>> outputs)
         ->Rc<Node> {
         auto ans = Rc<Node>(new Node(std::move(info), std::move(outputs)));
@@ -27,8 +27,13 @@ namespace refactor::hardware {
             Device *_device;
             void *_ptr;
             size_t _size;
+            /// @brief 视图所引用的存储块或借用的宿主对象，保证视图存活期间它不被释放。
+            Arc<void const> _base;
+            /// @brief 视图和借用的主机内存不由此存储块释放。
+            bool _owned;
 
             Blob(decltype(_device) device, size_t);
+            Blob(decltype(_device) device, void *, size_t, Arc<void const>);
 
         public:
             ~Blob();
@@ -55,6 +60,11 @@ namespace refactor::hardware {
         virtual void setContext() const;
 
         Arc<Blob> malloc(size_t);
+        /// @brief 构造 `base` 中 [offset, offset + size) 的视图。
+        Arc<Blob> slice(Arc<Blob> base, size_t offset, size_t size);
+        /// @brief 将调用者持有的主机内存包装为存储块，仅 CPU 可用。
+        ///        `owner` 为空时调用者负责其生命周期，否则存储块存活期间持有 `owner`。
+        Arc<Blob> borrow(void *, size_t, Arc<void const> owner = nullptr);
         Arc<Blob> absorb(Arc<Blob> &&);
     };
 
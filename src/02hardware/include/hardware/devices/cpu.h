@@ -5,6 +5,36 @@
 
 namespace refactor::hardware {
 
+    /// @brief CPU 设备上大块内存的分配策略。
+    struct CpuMemoryPolicy {
+        enum class Pages : uint8_t {
+            /// @brief 由系统决定页大小。
+            Default,
+            /// @brief 按 2MB 对齐映射并建议系统使用透明大页。
+            Transparent,
+            /// @brief 使用预留的 2MB 大页，预留不足时退化为透明大页。
+            Huge,
+        } pages = Pages::Default;
+        /// @brief 绑定到的 NUMA 节点，-1 表示不绑定。
+        int32_t node = -1;
+        /// @brief 在所有在线 NUMA 节点之间交错分配页。
+        bool interleave = false;
+
+        /// @brief 解析形如 "pages=huge,numa=1" 的参数，
+        ///        pages 可取 default/transparent/huge，numa 可取节点号或 interleave。
+        static CpuMemoryPolicy parse(std::string_view);
+        std::string toString() const;
+        bool isDefault() const noexcept;
+    };
+
+    struct CpuMemoryStats {
+        CpuMemoryPolicy policy;
+        /// @brief 按策略映射、尚未释放的字节数，其中来自预留大页的字节数。
+        size_t mapped, huge;
+        /// @brief 系统拒绝了大页或 NUMA 请求而退化处理的次数。
+        size_t fallbacks;
+    };
+
     class Cpu final : public Device {
     public:
         Cpu();
@@ -12,6 +42,10 @@ namespace refactor::hardware {
         Type type() const noexcept final {
             return Type::Cpu;
         }
+
+        /// @brief 修改之后分配的内存使用的策略，已分配的内存不受影响。
+        void configure(std::string_view args);
+        CpuMemoryStats memoryStats() const;
     };
 
 }// namespace refactor::hardware
@@ -1,10 +1,11 @@
 #ifndef MEM_MANAGER_MEM_OFFSET_CALCULATOR_H
 #define MEM_MANAGER_MEM_OFFSET_CALCULATOR_H
 
+#include <array>
+#include <cstdint>
 #include <optional>
-#include <set>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace refactor::hardware {
 
@@ -16,20 +17,23 @@ namespace refactor::hardware {
 
         struct FreeBlockInfo {
             size_t addr, blockSize;
-
-            bool operator<(FreeBlockInfo const &) const noexcept;
         };
 
-        // free balanced tree, maintains all free memory blocks
-        std::set<FreeBlockInfo> _freeBlocks;
+        // all free memory blocks sorted by address,
+        // neighbours of a freed block are found by binary search for coalescing
+        std::vector<FreeBlockInfo> _byAddr;
+
+        // segregated size classes, bin i holds the free blocks whose size is in [2^i, 2^(i+1)),
+        // each bin is sorted by (blockSize, addr) so that the best fit is the first block not smaller than the request
+        std::array<std::vector<FreeBlockInfo>, 64> _bins;
 
-        // key: head address offset of the free memory block
-        // value: blockSize of the block
-        std::unordered_map<size_t, size_t> _headAddrToBlockSize;
+        // bit i is set if bin i is not empty
+        uint64_t _nonEmptyBins;
 
-        // key: tail address offset of the free memory block
-        // value: blockSize of the block
-        std::unordered_map<size_t, size_t> _tailAddrToBlockSize;
+        void insertFree(FreeBlockInfo);
+        void eraseFree(FreeBlockInfo);
+        // the smallest free block not smaller than size, ties broken by the lowest address
+        std::optional<FreeBlockInfo> bestFit(size_t size) const;
 
         struct TraceInfo {
             size_t allocTimes, freeTimes;
@@ -37,6 +41,7 @@ namespace refactor::hardware {
         std::optional<TraceInfo> _traceInfo;
         // trace format :
         // CALCULATOR this alloc/free begin end size allocTimes freeTimes peak rate freeCount minBlockSize maxBlockSize
+        // begin, end and size describe the block passed to or returned by the call, so a trace can be replayed
         void trace(std::string event);
 
     public:
@@ -48,6 +53,13 @@ namespace refactor::hardware {
         // return: head address offset of the allocated memory block
         size_t alloc(size_t size);
 
+        // function: simulate memory allocation inside a region of limited capacity
+        // arguments:
+        //     size: size of memory block to be allocated
+        //     limit: the allocated block must end at or below this offset
+        // return: head address offset of the allocated memory block, or nothing if it does not fit
+        std::optional<size_t> tryAlloc(size_t size, size_t limit);
+
         // function: simulate memory free
         // arguments:
         //     addr: head address offset of memory block to be free
@@ -55,6 +67,10 @@ namespace refactor::hardware {
         void free(size_t addr, size_t size);
 
         size_t peak() const noexcept;
+        // total size of the blocks currently allocated, padded to the alignment
+        size_t used() const noexcept;
+        // the largest free block below limit, including the untouched space above the peak
+        size_t largestFree(size_t limit) const noexcept;
     };
 
 }// namespace refactor::hardware
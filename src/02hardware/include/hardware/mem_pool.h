@@ -4,19 +4,77 @@
 #include "common.h"
 #include "mem_offset_calculator.h"
 #include "memory.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 namespace refactor::hardware {
 
+    struct MemPoolConfig {
+        // size of every arena chained after the first one, 0 means the size of the first arena
+        size_t arenaSize = 0;
+        // requests up to this size are served from per-thread size-class caches, 0 disables them
+        size_t smallLimit = 4ul << 10;
+        // size of the slabs small blocks are carved from
+        size_t slabSize = 256ul << 10;
+        // an empty chained arena goes back to the parent after staying idle this long
+        std::chrono::milliseconds idleRelease{30'000};
+    };
+
+    struct MemPoolStats {
+        // bytes handed out to callers, and the maximum of it since construction
+        size_t live, peak;
+        // bytes taken from the parent and the number of arenas holding them
+        size_t reserved, arenas;
+        // 1 - largest free block / free bytes over all arenas, 0 when nothing is free
+        double fragmentation;
+    };
+
+    // A thread-safe pool on top of another memory.
+    // Large blocks are placed in a chain of arenas taken from the parent, a new arena is chained
+    // when none of them has room, and chained arenas are returned once they stay empty for `idleRelease`.
+    // Small blocks are carved from slabs into power-of-two size classes and cached per thread,
+    // so the common path takes no lock; caches exchange blocks with a per-class central list in batches.
+    // Slabs are never returned, the arenas holding them stay alive with the pool.
     class MemPool final : public hardware::Memory {
+        using Clock = std::chrono::steady_clock;
+
+        struct Arena {
+            void *ptr;
+            size_t size;
+            OffsetCalculator calculator;
+            size_t blocks;
+            Clock::time_point idleSince;
+        };
+        struct Block {
+            Arena *arena;
+            size_t size;
+        };
+        struct Small;
+        struct Local;
+
         Arc<Memory> _parent;
-        size_t _memPoolSize;
+        size_t _memPoolSize, _alignment;
+        MemPoolConfig _config;
+        uint64_t _id;
+
+        // guards the arenas and the large blocks
+        mutable std::mutex _mutex;
+        std::vector<std::unique_ptr<Arena>> _arenas;
+        std::unordered_map<void *, Block> _blocks;
 
-        OffsetCalculator _calculator;
-        void *_ptr;
-        std::unordered_map<void *, size_t> _ptrToBlobsize;
+        Arc<Small> _small;
+        std::atomic_size_t _live, _peak;
+
+        void *allocLarge(size_t);
+        void freeLarge(void *);
+        size_t trimLocked(Clock::time_point, std::chrono::milliseconds);
+        Local &local();
+        void refill(Local &, size_t cls);
+        void count(ptrdiff_t) noexcept;
 
     public:
-        MemPool(decltype(_parent), decltype(_memPoolSize), size_t alignment);
+        MemPool(decltype(_parent), decltype(_memPoolSize), size_t alignment, MemPoolConfig = {});
         ~MemPool();
 
         void *malloc(size_t bytes) final;
@@ -24,6 +82,11 @@ namespace refactor::hardware {
         void *copyHD(void *dst, void const *src, size_t bytes) const noexcept final;
         void *copyDH(void *dst, void const *src, size_t bytes) const noexcept final;
         void *copyDD(void *dst, void const *src, size_t bytes) const noexcept final;
+
+        // returns the chained arenas that have been empty for at least `idle` to the parent,
+        // the result is the number of bytes returned
+        size_t trim(std::chrono::milliseconds idle = {});
+        MemPoolStats stats() const;
     };
 
 }// namespace refactor::hardware
@@ -3,12 +3,15 @@
 namespace refactor::hardware {
 
     Device::Blob::Blob(decltype(_device) device, size_t size)
-        : _device(device), _ptr(nullptr), _size(size) {
+        : _device(device), _ptr(nullptr), _size(size), _base(nullptr), _owned(true) {
         _device->setContext();
         _ptr = _device->_mem->malloc(size);
     }
+    Device::Blob::Blob(decltype(_device) device, void *ptr, size_t size, Arc<void const> base)
+        : _device(device), _ptr(ptr), _size(size), _base(std::move(base)), _owned(false) {}
 
     Device::Blob::~Blob() {
+        if (!_owned) { return; }
         _device->setContext();
         _device->_mem->free(std::exchange(_ptr, nullptr));
     }
@@ -60,6 +63,15 @@ namespace refactor::hardware {
     auto Device::malloc(size_t size) -> Arc<Blob> {
         return Arc<Blob>(new Blob(this, size));
     }
+    auto Device::slice(Arc<Blob> base, size_t offset, size_t size) -> Arc<Blob> {
+        ASSERT(offset <= base->_size && size <= base->_size - offset, "slice out of range");
+        auto ptr = base->get<uint8_t>() + offset;
+        return Arc<Blob>(new Blob(this, ptr, size, std::move(base)));
+    }
+    auto Device::borrow(void *ptr, size_t size, Arc<void const> owner) -> Arc<Blob> {
+        ASSERT(type() == Type::Cpu, "Only host memory can be borrowed");
+        return Arc<Blob>(new Blob(this, ptr, size, std::move(owner)));
+    }
     auto Device::absorb(Arc<Blob> &&blob) -> Arc<Blob> {
         if (blob->_device == this) {
             return std::move(blob);
@@ -2,6 +2,7 @@
 #include "hardware/devices/cpu.h"
 #include "hardware/devices/mlu.h"
 #include "hardware/devices/nvidia.h"
+#include <mutex>
 
 namespace refactor::hardware::device {
 
@@ -10,14 +11,28 @@ namespace refactor::hardware::device {
         return cpu;
     }
     static std::unordered_map<int32_t, std::unordered_map<int32_t, Arc<Device>>> DEVICES;
+    /// @brief 保护 `DEVICES`，多个线程可以同时编译或分发计算图。
+    static std::mutex MUTEX;
     constexpr static auto CPU_KEY = static_cast<int32_t>(Device::Type::Cpu);
 
+    static Arc<Device> find(int32_t type, int32_t card) {
+        if (auto kind = DEVICES.find(type); kind != DEVICES.end()) {
+            if (auto it = kind->second.find(card); it != kind->second.end()) {
+                return it->second;
+            }
+        }
+        return nullptr;
+    }
+
     Arc<Device> fetch(Device::Type type) {
         auto type_ = static_cast<int32_t>(type);
         if (type_ == CPU_KEY) { return cpu(); }
-        if (auto kind = DEVICES.find(type_); kind != DEVICES.end()) {
-            if (auto it = kind->second.begin(); it != kind->second.end()) {
-                return it->second;
+        {
+            std::lock_guard lock(MUTEX);
+            if (auto kind = DEVICES.find(type_); kind != DEVICES.end()) {
+                if (auto it = kind->second.begin(); it != kind->second.end()) {
+                    return it->second;
+                }
             }
         }
         return init(type, 0, "");
@@ -25,15 +40,19 @@ namespace refactor::hardware::device {
     Arc<Device> fetch(Device::Type type, int32_t card) {
         auto type_ = static_cast<int32_t>(type);
         if (type_ == CPU_KEY) { return cpu(); }
-        if (auto kind = DEVICES.find(type_); kind != DEVICES.end()) {
-            if (auto it = kind->second.find(card); it != kind->second.end()) {
-                return it->second;
-            }
-        }
-        return nullptr;
+        std::lock_guard lock(MUTEX);
+        return find(type_, card);
     }
     Arc<Device> init(Device::Type type, int32_t card, std::string_view args) {
-        if (auto device = fetch(type, card); device) { return device; }
+        auto type_ = static_cast<int32_t>(type);
+        if (type_ == CPU_KEY) {
+            // CPU 设备只有一个，参数修改它之后的分配策略
+            auto ans = cpu();
+            if (!args.empty()) { std::static_pointer_cast<Cpu>(ans)->configure(args); }
+            return ans;
+        }
+        std::lock_guard lock(MUTEX);
+        if (auto device = find(type_, card); device) { return device; }
 
         using T = Device::Type;
         // clang-format off
@@ -41,7 +60,7 @@ namespace refactor::hardware::device {
                     : type == T::Mlu    ? std::make_shared<Mlu>(card)
                     : UNREACHABLEX(Arc<Device>, "");
         // clang-format on
-        auto [kind, ok] = DEVICES.try_emplace(static_cast<int32_t>(type));
+        auto [kind, ok] = DEVICES.try_emplace(type_);
         return kind->second.emplace(card, std::move(device)).first->second;
     }
 
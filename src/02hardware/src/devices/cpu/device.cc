@@ -4,11 +4,19 @@
 
 namespace refactor::hardware {
 
-    static Arc<Memory> cpuMemory() {
+    static Arc<CpuMemory> cpuMemory() {
         static auto instance = std::make_shared<CpuMemory>();
         return instance;
     }
 
     Cpu::Cpu() : Device(0, cpuMemory()) {}
 
+    void Cpu::configure(std::string_view args) {
+        std::static_pointer_cast<CpuMemory>(_mem)->setPolicy(CpuMemoryPolicy::parse(args));
+    }
+
+    CpuMemoryStats Cpu::memoryStats() const {
+        return std::static_pointer_cast<CpuMemory>(_mem)->stats();
+    }
+
 }// namespace refactor::hardware
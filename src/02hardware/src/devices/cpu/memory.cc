@@ -1,14 +1,199 @@
 ﻿#include "memory.hh"
+#include "hardware/functions.h"
+#include <charconv>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace refactor::hardware {
     using M = CpuMemory;
 
+    /// @brief 按策略映射的最小内存块，更小的内存块直接从堆分配。
+    constexpr static size_t HUGE_PAGE = 2ul << 20;
+
+    CpuMemoryPolicy CpuMemoryPolicy::parse(std::string_view args) {
+        CpuMemoryPolicy ans;
+        while (!args.empty()) {
+            auto end = args.find(',');
+            auto item = args.substr(0, end);
+            args = end == std::string_view::npos ? "" : args.substr(end + 1);
+            if (item.empty()) { continue; }
+
+            auto eq = item.find('=');
+            ASSERT(eq != std::string_view::npos, "Invalid cpu memory argument \"{}\"", item);
+            auto key = item.substr(0, eq), value = item.substr(eq + 1);
+            if (key == "pages") {
+                if (value == "default") {
+                    ans.pages = Pages::Default;
+                } else if (value == "transparent") {
+                    ans.pages = Pages::Transparent;
+                } else if (value == "huge") {
+                    ans.pages = Pages::Huge;
+                } else {
+                    RUNTIME_ERROR(fmt::format("Unknown page policy \"{}\"", value));
+                }
+            } else if (key == "numa") {
+                if (value == "interleave") {
+                    ans.interleave = true;
+                    ans.node = -1;
+                } else {
+                    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), ans.node);
+                    ASSERT(ec == std::errc() && ptr == value.data() + value.size() && ans.node >= 0,
+                           "Invalid numa node \"{}\"", value);
+                    ans.interleave = false;
+                }
+            } else {
+                RUNTIME_ERROR(fmt::format("Unknown cpu memory argument \"{}\"", key));
+            }
+        }
+        return ans;
+    }
+
+    std::string CpuMemoryPolicy::toString() const {
+        constexpr static std::string_view PAGES[]{"default", "transparent", "huge"};
+        auto ans = fmt::format("pages={}", PAGES[static_cast<uint8_t>(pages)]);
+        if (interleave) {
+            ans += ",numa=interleave";
+        } else if (node >= 0) {
+            ans += fmt::format(",numa={}", node);
+        }
+        return ans;
+    }
+
+    bool CpuMemoryPolicy::isDefault() const noexcept {
+        return pages == Pages::Default && node < 0 && !interleave;
+    }
+
+#ifdef __linux__
+    /// @brief 读取在线 NUMA 节点的掩码，格式如 "0-1,3"。
+    static std::vector<unsigned long> onlineNodes() {
+        constexpr static size_t BITS = sizeof(unsigned long) * 8;
+        std::vector<unsigned long> ans;
+        auto set = [&](size_t i) {
+            if (ans.size() <= i / BITS) { ans.resize(i / BITS + 1); }
+            ans[i / BITS] |= 1ul << (i % BITS);
+        };
+        std::string line;
+        if (std::ifstream file("/sys/devices/system/node/online"); file) { std::getline(file, line); }
+        std::string_view list = line;
+        while (!list.empty()) {
+            auto end = list.find(',');
+            auto span = list.substr(0, end);
+            list = end == std::string_view::npos ? "" : list.substr(end + 1);
+            size_t first = 0, last = 0;
+            auto [ptr, ec] = std::from_chars(span.data(), span.data() + span.size(), first);
+            if (ec != std::errc()) { continue; }
+            last = first;
+            if (ptr != span.data() + span.size() && *ptr == '-') {
+                std::from_chars(ptr + 1, span.data() + span.size(), last);
+            }
+            for (auto i : range(first, last + 1)) { set(i); }
+        }
+        if (ans.empty()) { set(0); }
+        return ans;
+    }
+
+    /// @brief 映射按大页对齐的匿名内存，失败时返回空指针。
+    static void *mapAligned(size_t bytes) {
+        auto ptr = mmap(nullptr, bytes + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) { return nullptr; }
+        // 裁掉首尾多出的部分，使透明大页能覆盖整个内存块
+        auto begin = reinterpret_cast<uintptr_t>(ptr),
+             aligned = (begin + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+        if (auto head = aligned - begin; head) { munmap(ptr, head); }
+        if (auto tail = begin + HUGE_PAGE - aligned; tail) { munmap(reinterpret_cast<void *>(aligned + bytes), tail); }
+        return reinterpret_cast<void *>(aligned);
+    }
+#endif
+
+    M::CpuMemory(CpuMemoryPolicy policy)
+        : _mutex(), _policy(policy), _default(policy.isDefault()),
+          _mappings{}, _mapped(0), _huge(0), _fallbacks(0) {}
+
+    void M::setPolicy(CpuMemoryPolicy policy) {
+        std::lock_guard lock(_mutex);
+        _policy = policy;
+        _default = policy.isDefault();
+    }
+
+    CpuMemoryStats M::stats() const {
+        std::lock_guard lock(_mutex);
+        return {_policy, _mapped, _huge, _fallbacks};
+    }
+
     void *M::malloc(size_t size) {
+#ifdef __linux__
+        // 堆分配不经过锁，只有按策略映射时才需要互斥
+        if (_default || size < HUGE_PAGE) {
+            return std::malloc(size);
+        }
+        std::lock_guard lock(_mutex);
+        if (_policy.isDefault()) {
+            return std::malloc(size);
+        }
+        using Pages = CpuMemoryPolicy::Pages;
+        auto bytes = alignBytes(size, HUGE_PAGE);
+        void *ptr = nullptr;
+        bool huge = false;
+        if (_policy.pages == Pages::Huge) {
+            // 预留的大页不足时映射失败，退化为透明大页
+            ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+            if (ptr == MAP_FAILED) {
+                ptr = nullptr;
+                ++_fallbacks;
+            } else {
+                huge = true;
+            }
+        }
+        if (!ptr) {
+            if (ptr = mapAligned(bytes); !ptr) { return nullptr; }
+            if (_policy.pages != Pages::Default && madvise(ptr, bytes, MADV_HUGEPAGE)) { ++_fallbacks; }
+        }
+        // 页在首次写入时才分配，此时设置的 NUMA 策略对整个内存块生效
+        if (_policy.interleave || _policy.node >= 0) {
+            std::vector<unsigned long> mask;
+            if (_policy.interleave) {
+                mask = onlineNodes();
+            } else {
+                constexpr static size_t BITS = sizeof(unsigned long) * 8;
+                mask.resize(_policy.node / BITS + 1);
+                mask.back() |= 1ul << (_policy.node % BITS);
+            }
+            auto mode = _policy.interleave ? MPOL_INTERLEAVE : MPOL_BIND;
+            if (syscall(SYS_mbind, ptr, bytes, mode, mask.data(), mask.size() * sizeof(unsigned long) * 8 + 1, 0)) {
+                ++_fallbacks;
+            }
+        }
+        _mappings.emplace(ptr, Mapping{bytes, huge});
+        _mapped += bytes;
+        if (huge) { _huge += bytes; }
+        return ptr;
+#else
         return std::malloc(size);
+#endif
     }
     void M::free(void *ptr) {
+#ifdef __linux__
+        // 映射的内存块在分配返回前已计入，释放它的线程一定能看到非零计数
+        if (_mapped) {
+            std::lock_guard lock(_mutex);
+            if (auto it = _mappings.find(ptr); it != _mappings.end()) {
+                auto [size, huge] = it->second;
+                _mappings.erase(it);
+                _mapped -= size;
+                if (huge) { _huge -= size; }
+                munmap(ptr, size);
+                return;
+            }
+        }
+#endif
         std::free(ptr);
     }
     void *M::copyHD(void *dst, void const *src, size_t bytes) const {
@@ -1,16 +1,40 @@
 ﻿#ifndef HARDWARE_DEVICES_CPU_MEMORY_HH
 #define HARDWARE_DEVICES_CPU_MEMORY_HH
 
+#include "hardware/devices/cpu.h"
 #include "hardware/memory.h"
+#include <atomic>
+#include <mutex>
 
 namespace refactor::hardware {
 
     class CpuMemory final : public Memory {
+        struct Mapping {
+            size_t size;
+            bool huge;
+        };
+
+        mutable std::mutex _mutex;
+        CpuMemoryPolicy _policy;
+        /// @brief 策略是否为默认，默认策略下分配不需要加锁。
+        std::atomic_bool _default;
+        /// @brief 按策略映射的内存块，其余内存块来自堆。
+        std::unordered_map<void *, Mapping> _mappings;
+        /// @brief 没有映射的内存块时释放不需要加锁。
+        std::atomic_size_t _mapped;
+        size_t _huge, _fallbacks;
+
         void *malloc(size_t) final;
         void free(void *) final;
         void *copyHD(void *dst, void const *src, size_t bytes) const final;
         void *copyDH(void *dst, void const *src, size_t bytes) const final;
         void *copyDD(void *dst, void const *src, size_t bytes) const final;
+
+    public:
+        explicit CpuMemory(CpuMemoryPolicy = {});
+
+        void setPolicy(CpuMemoryPolicy);
+        CpuMemoryStats stats() const;
     };
 
 }// namespace refactor::hardware
@@ -1,23 +1,31 @@
 #include "hardware/mem_offset_calculator.h"
 #include "common.h"
 #include "hardware/functions.h"
+#include <algorithm>
+#include <bit>
 #include <fmtlog.h>
 
 namespace refactor::hardware {
 
-    auto OffsetCalculator::FreeBlockInfo::
-    operator<(const FreeBlockInfo &rhs) const noexcept -> bool {
-        // most likely the two blockSizes are not equal
-        return blockSize < rhs.blockSize || (blockSize == rhs.blockSize && addr < rhs.addr);
+    static size_t binOf(size_t size) noexcept {
+        return size ? std::bit_width(size) - 1 : 0;
     }
 
+    constexpr static auto BY_ADDR = [](auto const &a, auto const &b) {
+        return a.addr < b.addr;
+    };
+    constexpr static auto BY_SIZE = [](auto const &a, auto const &b) {
+        // most likely the two blockSizes are not equal
+        return a.blockSize < b.blockSize || (a.blockSize == b.blockSize && a.addr < b.addr);
+    };
+
     OffsetCalculator::OffsetCalculator(size_t alignment, bool trace)
         : _used(0),
           _peak(0),
           _alignment(alignment),
-          _freeBlocks{},
-          _headAddrToBlockSize{},
-          _tailAddrToBlockSize{},
+          _byAddr{},
+          _bins{},
+          _nonEmptyBins(0),
 #ifndef NDEBUG
           _traceInfo(trace ? std::make_optional(TraceInfo{0, 0}) : std::nullopt)
 #else
@@ -26,28 +34,48 @@ namespace refactor::hardware {
     {
     }
 
+    void OffsetCalculator::insertFree(FreeBlockInfo block) {
+        _byAddr.insert(std::upper_bound(_byAddr.begin(), _byAddr.end(), block, BY_ADDR), block);
+        auto bin = binOf(block.blockSize);
+        auto &blocks = _bins[bin];
+        blocks.insert(std::upper_bound(blocks.begin(), blocks.end(), block, BY_SIZE), block);
+        _nonEmptyBins |= 1ull << bin;
+    }
+
+    void OffsetCalculator::eraseFree(FreeBlockInfo block) {
+        _byAddr.erase(std::lower_bound(_byAddr.begin(), _byAddr.end(), block, BY_ADDR));
+        auto bin = binOf(block.blockSize);
+        auto &blocks = _bins[bin];
+        blocks.erase(std::lower_bound(blocks.begin(), blocks.end(), block, BY_SIZE));
+        if (blocks.empty()) { _nonEmptyBins &= ~(1ull << bin); }
+    }
+
+    auto OffsetCalculator::bestFit(size_t size) const -> std::optional<FreeBlockInfo> {
+        auto bin = binOf(size);
+        // blocks in the same bin may still be smaller than the request
+        if (auto const &blocks = _bins[bin]; !blocks.empty()) {
+            auto it = std::lower_bound(blocks.begin(), blocks.end(), FreeBlockInfo{0, size}, BY_SIZE);
+            if (it != blocks.end()) { return *it; }
+        }
+        // every block in a higher bin fits, the smallest one is at the front of the lowest non-empty bin
+        if (auto higher = bin < 63 ? _nonEmptyBins & (~0ull << (bin + 1)) : 0; higher) {
+            return _bins[std::countr_zero(higher)].front();
+        }
+        return std::nullopt;
+    }
+
     size_t OffsetCalculator::alloc(size_t size) {
         // pad the size to the multiple of alignment
         size = alignBytes(size, _alignment);
         _used += size;
 
         // found an alvailable free memory block for allocation
-        if (auto it = _freeBlocks.lower_bound(FreeBlockInfo{0ul, size}); it != _freeBlocks.end()) {
-
-            auto [addr, blockSize] = *it;
-            auto head = addr,
-                 tail = head + blockSize;
-            // update the map of head and tail address offset of memory blocks
-            _freeBlocks.erase(it);
-            _headAddrToBlockSize.erase(head);
-            _tailAddrToBlockSize.erase(tail);
+        if (auto block = bestFit(size); block) {
+            auto [addr, blockSize] = *block;
+            eraseFree(*block);
             // memory block splitting
             if (blockSize > size) {
-                auto newSize = blockSize - size;
-                head += size;
-                _headAddrToBlockSize.emplace(head, newSize);
-                _tailAddrToBlockSize.emplace(tail, newSize);
-                _freeBlocks.insert({head, newSize});
+                insertFree({addr + size, blockSize - size});
             }
             if (_traceInfo) {
                 ++_traceInfo->allocTimes;
@@ -56,15 +84,12 @@ namespace refactor::hardware {
             return addr;
         }
         // found an free memory block for allocation located at the end of the currently allocated memory
-        if (auto it = _tailAddrToBlockSize.find(_peak); it != _tailAddrToBlockSize.end()) {
-
-            auto blockSize = it->second,
-                 addr = _peak - blockSize;
-            ASSERT(blockSize < size, "the available free block's size should less than size");
-            _freeBlocks.erase({addr, blockSize});
-            _headAddrToBlockSize.erase(addr);
-            _tailAddrToBlockSize.erase(it);
-            _peak += size - blockSize;
+        if (!_byAddr.empty() && _byAddr.back().addr + _byAddr.back().blockSize == _peak) {
+            auto block = _byAddr.back();
+            auto addr = block.addr;
+            ASSERT(block.blockSize < size, "the available free block's size should less than size");
+            eraseFree(block);
+            _peak += size - block.blockSize;
             if (_traceInfo) {
                 ++_traceInfo->allocTimes;
                 trace(fmt::format("alloc {:>#10} {:>#10} {:<#10}", addr, addr + size, size));
@@ -83,34 +108,45 @@ namespace refactor::hardware {
         }
     }
 
+    std::optional<size_t> OffsetCalculator::tryAlloc(size_t size, size_t limit) {
+        // a free block below the peak always fits, otherwise the block grows the peak
+        if (auto aligned = alignBytes(size, _alignment); !bestFit(aligned)) {
+            size_t tail = 0;
+            if (!_byAddr.empty() && _byAddr.back().addr + _byAddr.back().blockSize == _peak) {
+                tail = _byAddr.back().blockSize;
+            }
+            if (_peak - tail + aligned > limit) { return std::nullopt; }
+        }
+        return alloc(size);
+    }
+
     void OffsetCalculator::free(size_t addr, size_t size) {
         // pad the size to the multiple of alignment
         size = alignBytes(size, _alignment);
         _used -= size;
 
-        auto head = addr,
-             tail = addr + size;
-        if (auto it = _tailAddrToBlockSize.find(head); it != _tailAddrToBlockSize.end()) {
-            head -= it->second;
-            size += it->second;
-            _freeBlocks.erase({head, it->second});
-            _headAddrToBlockSize.erase(head);
-            _tailAddrToBlockSize.erase(it);
+        FreeBlockInfo merged{addr, size};
+        // the free blocks adjacent to the freed one are its neighbours in address order
+        auto next = std::lower_bound(_byAddr.begin(), _byAddr.end(), merged, BY_ADDR);
+        std::optional<FreeBlockInfo> prev, succ;
+        if (next != _byAddr.begin()) {
+            if (auto block = *std::prev(next); block.addr + block.blockSize == addr) { prev = block; }
+        }
+        if (next != _byAddr.end() && next->addr == addr + size) { succ = *next; }
+        if (prev) {
+            eraseFree(*prev);
+            merged.addr = prev->addr;
+            merged.blockSize += prev->blockSize;
         }
-        if (auto it = _headAddrToBlockSize.find(tail); it != _headAddrToBlockSize.end()) {
-            tail += it->second;
-            size += it->second;
-            _freeBlocks.erase({it->first, it->second});
-            _headAddrToBlockSize.erase(it);
-            _tailAddrToBlockSize.erase(tail);
+        if (succ) {
+            eraseFree(*succ);
+            merged.blockSize += succ->blockSize;
         }
-        _freeBlocks.insert({head, size});
-        _headAddrToBlockSize.emplace(head, size);
-        _tailAddrToBlockSize.emplace(tail, size);
+        insertFree(merged);
 
         if (_traceInfo) {
             ++_traceInfo->freeTimes;
-            trace(fmt::format("free  {:>#10} {:>#10} -{:<#9}", head, tail, size));
+            trace(fmt::format("free  {:>#10} {:>#10} -{:<#9}", addr, addr + size, size));
         }
     }
 
@@ -118,15 +154,30 @@ namespace refactor::hardware {
         return _peak;
     }
 
+    size_t OffsetCalculator::used() const noexcept {
+        return _used;
+    }
+
+    size_t OffsetCalculator::largestFree(size_t limit) const noexcept {
+        size_t inner = 0, tail = 0;
+        if (_nonEmptyBins) {
+            inner = _bins[63 - std::countl_zero(_nonEmptyBins)].back().blockSize;
+        }
+        if (!_byAddr.empty() && _byAddr.back().addr + _byAddr.back().blockSize == _peak) {
+            tail = _byAddr.back().blockSize;
+        }
+        return std::max(inner, limit > _peak ? limit - _peak + tail : tail);
+    }
+
     void OffsetCalculator::trace(std::string event) {
         logd("CALCULATOR {} {} {:>5} {:>5} {:>#10} {:>#6f} {:>5} {:>#10} {:>#10}",
              reinterpret_cast<void *>(this),
              event,
              _traceInfo->allocTimes, _traceInfo->freeTimes,
              _peak, static_cast<double>(_used) / _peak,
-             _freeBlocks.size(),
-             _freeBlocks.empty() ? 0 : _freeBlocks.begin()->blockSize,
-             _freeBlocks.empty() ? 0 : _freeBlocks.rbegin()->blockSize);
+             _byAddr.size(),
+             _nonEmptyBins ? _bins[std::countr_zero(_nonEmptyBins)].front().blockSize : 0,
+             _nonEmptyBins ? _bins[63 - std::countl_zero(_nonEmptyBins)].back().blockSize : 0);
     }
 
 }// namespace refactor::hardware
@@ -1,31 +1,150 @@
 #include "hardware/mem_pool.h"
+#include "hardware/functions.h"
+#include <algorithm>
+#include <bit>
 
 namespace refactor::hardware {
 
-    MemPool::MemPool(decltype(_parent) parent, decltype(_memPoolSize) size, size_t alignment)
+    // blocks moved between a thread cache and the central list at a time
+    constexpr static size_t BATCH = 32;
+    constexpr static size_t NONE = SIZE_MAX;
+
+    static std::atomic_uint64_t NEXT_ID{1};
+
+    struct MemPool::Small {
+        struct Slab {
+            uint8_t const *begin;
+            size_t cls;
+        };
+        struct Class {
+            std::mutex mutex;
+            std::vector<void *> free;
+        };
+
+        // class i holds blocks of `minSize << i` bytes
+        size_t minSize, slabSize;
+        std::vector<Class> classes;
+        // slabs sorted by address, replaced as a whole when a slab is added,
+        // so that thread caches can search their own snapshot without locking
+        std::mutex slabsMutex;
+        std::shared_ptr<std::vector<Slab> const> slabs;
+        std::atomic_uint64_t version;
+
+        Small(size_t alignment, size_t limit, size_t slabSize_)
+            : minSize(std::bit_ceil(alignment)),
+              slabSize(0),
+              classes(),
+              slabsMutex(),
+              slabs(std::make_shared<std::vector<Slab> const>()),
+              version(1) {
+            size_t n = 0;
+            while ((minSize << n) <= limit) { ++n; }
+            classes = std::vector<Class>(n);
+            slabSize = n ? std::max(slabSize_, minSize << (n - 1)) : 0;
+        }
+
+        size_t classOf(size_t bytes) const noexcept {
+            if (classes.empty() || bytes > sizeOf(classes.size() - 1)) { return NONE; }
+            return std::bit_width((bytes - 1) / minSize);
+        }
+        size_t sizeOf(size_t cls) const noexcept {
+            return minSize << cls;
+        }
+    };
+
+    struct MemPool::Local {
+        std::weak_ptr<Small> small;
+        std::vector<std::vector<void *>> free;
+        uint64_t version = 0;
+        std::shared_ptr<std::vector<Small::Slab> const> slabs;
+
+        ~Local() {
+            // blocks cached by an exiting thread go back to the pool if it is still alive
+            if (auto s = small.lock(); s) {
+                for (auto i : range0_(free.size())) {
+                    std::lock_guard lock(s->classes[i].mutex);
+                    auto &central = s->classes[i].free;
+                    central.insert(central.end(), free[i].begin(), free[i].end());
+                }
+            }
+        }
+
+        // the size class of the slab holding `ptr`, NONE if it is not a small block
+        size_t find(Small &s, void const *ptr) {
+            if (s.version.load(std::memory_order_acquire) != version) {
+                std::lock_guard lock(s.slabsMutex);
+                slabs = s.slabs;
+                version = s.version.load(std::memory_order_relaxed);
+            }
+            auto p = static_cast<uint8_t const *>(ptr);
+            auto it = std::upper_bound(slabs->begin(), slabs->end(), p,
+                                       [](auto p, auto const &slab) { return p < slab.begin; });
+            if (it == slabs->begin() || p >= (--it)->begin + s.slabSize) { return NONE; }
+            return it->cls;
+        }
+    };
+
+    MemPool::MemPool(decltype(_parent) parent, decltype(_memPoolSize) size, size_t alignment, MemPoolConfig config)
         : _parent(std::move(parent)),
           _memPoolSize(size),
-          _calculator(OffsetCalculator(alignment)),
-          _ptr(_parent->malloc(size)),
-          _ptrToBlobsize{} {}
+          _alignment(alignment),
+          _config(config),
+          _id(NEXT_ID++),
+          _mutex(),
+          _arenas(),
+          _blocks{},
+          _small(std::make_shared<Small>(alignment, config.smallLimit, config.slabSize)),
+          _live(0),
+          _peak(0) {
+        auto ptr = _parent->malloc(size);
+        ASSERT(ptr, "out of memory");
+        _arenas.push_back(std::make_unique<Arena>(Arena{ptr, size, OffsetCalculator(alignment), 0, Clock::now()}));
+    }
     MemPool::~MemPool() {
-        _parent->free(_ptr);
+        for (auto const &arena : _arenas) {
+            _parent->free(arena->ptr);
+        }
     }
+
     void *MemPool::malloc(size_t const bytes) {
         if (bytes == 0) { return nullptr; }
-        auto offset = _calculator.alloc(bytes);
-        ASSERT(_calculator.peak() < _memPoolSize, "out of memory");
-        void *ans = static_cast<uint8_t *>(_ptr) + offset;
-        _ptrToBlobsize.emplace(ans, bytes);
+        if (auto cls = _small->classOf(bytes); cls != NONE) {
+            auto &local = this->local();
+            auto &free = local.free[cls];
+            if (free.empty()) { refill(local, cls); }
+            auto ans = free.back();
+            free.pop_back();
+            count(_small->sizeOf(cls));
+            return ans;
+        }
+        void *ans;
+        {
+            std::lock_guard lock(_mutex);
+            ans = allocLarge(bytes);
+        }
+        count(alignBytes(bytes, _alignment));
         return ans;
     }
     void MemPool::free(void *const ptr) {
         if (!ptr) { return; }
-        auto it = _ptrToBlobsize.find(ptr);
-        ASSERT(it != _ptrToBlobsize.end(), "invalid ptr");
-        auto offset = static_cast<uint8_t *>(ptr) - static_cast<uint8_t *>(_ptr);
-        _calculator.free(offset, it->second);
-        _ptrToBlobsize.erase(it);
+        if (!_small->classes.empty()) {
+            auto &local = this->local();
+            if (auto cls = local.find(*_small, ptr); cls != NONE) {
+                auto &free = local.free[cls];
+                free.push_back(ptr);
+                count(-static_cast<ptrdiff_t>(_small->sizeOf(cls)));
+                // a thread that frees more than it allocates hands a batch back
+                if (free.size() > 2 * BATCH) {
+                    auto &central = _small->classes[cls];
+                    std::lock_guard lock(central.mutex);
+                    central.free.insert(central.free.end(), free.begin(), free.begin() + BATCH);
+                    free.erase(free.begin(), free.begin() + BATCH);
+                }
+                return;
+            }
+        }
+        std::lock_guard lock(_mutex);
+        freeLarge(ptr);
     }
     void *MemPool::copyHD(void *dst, void const *src, size_t bytes) const noexcept {
         return _parent->copyHD(dst, src, bytes);
@@ -37,4 +156,132 @@ namespace refactor::hardware {
         return _parent->copyDD(dst, src, bytes);
     }
 
+    size_t MemPool::trim(std::chrono::milliseconds idle) {
+        std::lock_guard lock(_mutex);
+        return trimLocked(Clock::now(), idle);
+    }
+
+    MemPoolStats MemPool::stats() const {
+        std::lock_guard lock(_mutex);
+        size_t reserved = 0, free = 0, largest = 0;
+        for (auto const &arena : _arenas) {
+            reserved += arena->size;
+            free += arena->size - arena->calculator.used();
+            largest = std::max(largest, arena->calculator.largestFree(arena->size));
+        }
+        return {
+            _live.load(std::memory_order_relaxed),
+            _peak.load(std::memory_order_relaxed),
+            reserved,
+            _arenas.size(),
+            free ? 1 - static_cast<double>(largest) / free : 0,
+        };
+    }
+
+    void *MemPool::allocLarge(size_t bytes) {
+        auto place = [&](Arena &arena, size_t offset) {
+            ++arena.blocks;
+            void *ans = static_cast<uint8_t *>(arena.ptr) + offset;
+            _blocks.emplace(ans, Block{&arena, bytes});
+            return ans;
+        };
+        for (auto const &arena : _arenas) {
+            if (auto offset = arena->calculator.tryAlloc(bytes, arena->size); offset) {
+                return place(*arena, *offset);
+            }
+        }
+        // no arena has room, chain a new one large enough for this block
+        auto size = std::max(_config.arenaSize ? _config.arenaSize : _memPoolSize, alignBytes(bytes, _alignment));
+        auto ptr = _parent->malloc(size);
+        ASSERT(ptr, "out of memory");
+        auto &arena = *_arenas.emplace_back(std::make_unique<Arena>(Arena{ptr, size, OffsetCalculator(_alignment), 0, Clock::now()}));
+        return place(arena, *arena.calculator.tryAlloc(bytes, size));
+    }
+
+    void MemPool::freeLarge(void *ptr) {
+        auto it = _blocks.find(ptr);
+        ASSERT(it != _blocks.end(), "invalid ptr");
+        auto [arena, size] = it->second;
+        _blocks.erase(it);
+        arena->calculator.free(static_cast<uint8_t *>(ptr) - static_cast<uint8_t *>(arena->ptr), size);
+        auto now = Clock::now();
+        if (!--arena->blocks) { arena->idleSince = now; }
+        count(-static_cast<ptrdiff_t>(alignBytes(size, _alignment)));
+        trimLocked(now, _config.idleRelease);
+    }
+
+    size_t MemPool::trimLocked(Clock::time_point now, std::chrono::milliseconds idle) {
+        size_t ans = 0;
+        // the first arena stays with the pool
+        for (auto it = _arenas.begin() + 1; it != _arenas.end();) {
+            if (auto const &arena = **it; !arena.blocks && now - arena.idleSince >= idle) {
+                _parent->free(arena.ptr);
+                ans += arena.size;
+                it = _arenas.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return ans;
+    }
+
+    auto MemPool::local() -> Local & {
+        thread_local std::unordered_map<uint64_t, Local> locals;
+        thread_local uint64_t lastId = 0;
+        thread_local Local *last = nullptr;
+        if (lastId != _id) {
+            auto it = locals.find(_id);
+            if (it == locals.end()) {
+                // entries of destroyed pools are dropped as new ones come in, so the map stays bounded
+                std::erase_if(locals, [](auto const &pair) { return pair.second.small.expired(); });
+                it = locals.try_emplace(_id).first;
+                it->second.small = _small;
+                it->second.free.resize(_small->classes.size());
+            }
+            lastId = _id;
+            last = &it->second;
+        }
+        return *last;
+    }
+
+    void MemPool::refill(Local &local, size_t cls) {
+        auto &small = *_small;
+        auto &central = small.classes[cls];
+        auto &free = local.free[cls];
+        {
+            std::lock_guard lock(central.mutex);
+            auto n = std::min(BATCH, central.free.size());
+            free.insert(free.end(), central.free.end() - n, central.free.end());
+            central.free.resize(central.free.size() - n);
+        }
+        if (!free.empty()) { return; }
+
+        // carve a new slab, it is published before any of its blocks is handed out
+        uint8_t *slab;
+        {
+            std::lock_guard lock(_mutex);
+            slab = static_cast<uint8_t *>(allocLarge(small.slabSize));
+        }
+        {
+            std::lock_guard lock(small.slabsMutex);
+            auto slabs = std::make_shared<std::vector<Small::Slab>>(*small.slabs);
+            auto pos = std::upper_bound(slabs->begin(), slabs->end(), slab,
+                                        [](auto p, auto const &s) { return p < s.begin; });
+            slabs->insert(pos, {slab, cls});
+            small.slabs = std::move(slabs);
+            small.version.fetch_add(1, std::memory_order_release);
+        }
+        auto size = small.sizeOf(cls), n = small.slabSize / size;
+        auto keep = std::min(n, BATCH);
+        for (auto i : range0_(keep)) { free.push_back(slab + i * size); }
+        std::lock_guard lock(central.mutex);
+        for (auto i : range(keep, n)) { central.free.push_back(slab + i * size); }
+    }
+
+    void MemPool::count(ptrdiff_t delta) noexcept {
+        auto live = _live.fetch_add(static_cast<size_t>(delta), std::memory_order_relaxed) + static_cast<size_t>(delta);
+        auto peak = _peak.load(std::memory_order_relaxed);
+        while (live > peak && !_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
 }// namespace refactor::hardware
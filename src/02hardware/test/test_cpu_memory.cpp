@@ -0,0 +1,99 @@
+#include "../src/devices/cpu/memory.hh"
+#include "hardware/device_manager.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+using namespace refactor;
+using namespace hardware;
+
+TEST(CpuMemory, testParsePolicy) {
+    using Pages = CpuMemoryPolicy::Pages;
+    EXPECT_TRUE(CpuMemoryPolicy::parse("").isDefault());
+
+    auto policy = CpuMemoryPolicy::parse("pages=huge,numa=1");
+    EXPECT_EQ(policy.pages, Pages::Huge);
+    EXPECT_EQ(policy.node, 1);
+    EXPECT_FALSE(policy.interleave);
+    EXPECT_EQ(policy.toString(), "pages=huge,numa=1");
+
+    policy = CpuMemoryPolicy::parse("numa=interleave,pages=transparent");
+    EXPECT_EQ(policy.pages, Pages::Transparent);
+    EXPECT_TRUE(policy.interleave);
+    EXPECT_EQ(CpuMemoryPolicy::parse(policy.toString()).toString(), policy.toString());
+
+    EXPECT_THROW(CpuMemoryPolicy::parse("pages=tiny"), std::runtime_error);
+    EXPECT_THROW(CpuMemoryPolicy::parse("numa=-1"), std::runtime_error);
+    EXPECT_THROW(CpuMemoryPolicy::parse("swap=on"), std::runtime_error);
+}
+
+TEST(CpuMemory, testMappedBlocks) {
+    constexpr static size_t SIZE = 5ul << 20;
+    CpuMemory memory(CpuMemoryPolicy::parse("pages=huge,numa=0"));
+    Memory &mem = memory;
+
+    // small blocks still come from the heap
+    auto small = mem.malloc(4096);
+    EXPECT_EQ(memory.stats().mapped, 0);
+    // explicit huge pages may not be reserved, the block is usable either way
+    auto large = static_cast<uint8_t *>(mem.malloc(SIZE));
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(large) % (2ul << 20), 0);
+    std::memset(large, 1, SIZE);
+    auto stats = memory.stats();
+    EXPECT_EQ(stats.policy.toString(), "pages=huge,numa=0");
+    EXPECT_EQ(stats.mapped, 6ul << 20);
+    EXPECT_TRUE(stats.huge == 0 || stats.huge == stats.mapped);
+    EXPECT_TRUE(stats.huge || stats.fallbacks);
+
+    mem.free(large);
+    mem.free(small);
+    EXPECT_EQ(memory.stats().mapped, 0);
+    EXPECT_EQ(memory.stats().huge, 0);
+}
+
+TEST(CpuMemory, testDeviceInit) {
+    auto &cpu = dynamic_cast<Cpu &>(*device::init(Device::Type::Cpu, 0, "pages=transparent"));
+    EXPECT_EQ(cpu.memoryStats().policy.toString(), "pages=transparent");
+    // blocks allocated under one policy are freed correctly after the policy changes
+    auto blob = cpu.malloc(4ul << 20);
+    EXPECT_EQ(cpu.memoryStats().mapped, 4ul << 20);
+    device::init(Device::Type::Cpu, 0, "pages=default");
+    blob = nullptr;
+    EXPECT_EQ(cpu.memoryStats().mapped, 0);
+    EXPECT_TRUE(cpu.memoryStats().policy.isDefault());
+}
+
+TEST(CpuMemory, DISABLED_testPolicyBenchmark) {
+    constexpr static size_t SIZE = 256ul << 20, STEPS = 1ul << 21;
+    // a random cycle over the buffer, every step touches another page
+    constexpr static size_t SLOTS = SIZE / sizeof(uint32_t), STRIDE = 4096 / sizeof(uint32_t);
+    std::vector<uint32_t> order(SLOTS / STRIDE);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+    fmt::println("random page walk over {} MiB, {} steps", SIZE >> 20, STEPS);
+    for (auto args : {"pages=default", "pages=transparent", "pages=huge", "pages=transparent,numa=interleave"}) {
+        CpuMemory memory(CpuMemoryPolicy::parse(args));
+        Memory &mem = memory;
+        auto data = static_cast<uint32_t *>(mem.malloc(SIZE));
+        for (auto i : range0_(order.size())) {
+            data[order[i] * STRIDE] = order[(i + 1) % order.size()] * STRIDE;
+        }
+
+        using namespace std::chrono;
+        uint32_t p = order[0] * STRIDE;
+        auto t0 = high_resolution_clock::now();
+        for (size_t i = 0; i < STEPS; ++i) { p = data[p]; }
+        auto t1 = high_resolution_clock::now();
+        EXPECT_LT(p, SLOTS);
+
+        auto stats = memory.stats();
+        fmt::println("  {:<35} {:6.2f} ns/step, mapped {:>3} MiB, huge {:>3} MiB, fallbacks {}",
+                     stats.policy.toString(),
+                     duration_cast<duration<double, std::nano>>(t1 - t0).count() / STEPS,
+                     stats.mapped >> 20, stats.huge >> 20, stats.fallbacks);
+        mem.free(data);
+    }
+}
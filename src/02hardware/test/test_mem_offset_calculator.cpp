@@ -1,5 +1,12 @@
 #include "hardware/mem_offset_calculator.h"
+#include "hardware/functions.h"
+#include <chrono>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <sstream>
+#include <unordered_map>
 
 using namespace refactor;
 using namespace hardware;
@@ -60,3 +67,162 @@ TEST(MemOffsetCalculator, testAllocWithEndFreeBlock) {
     // expected to be a->b->d, with no free block between b and d
     EXPECT_EQ(offsetC, offsetD);
 }
+
+// the previous implementation with a balanced tree and two hash maps, used as the reference of best-fit and coalescing
+class ReferenceCalculator {
+    size_t _peak = 0, _alignment;
+    std::set<std::pair<size_t, size_t>> _freeBlocks;// (blockSize, addr)
+    std::unordered_map<size_t, size_t> _head, _tail;
+
+public:
+    explicit ReferenceCalculator(size_t alignment) : _alignment(alignment) {}
+
+    size_t alloc(size_t size) {
+        size = alignBytes(size, _alignment);
+        if (auto it = _freeBlocks.lower_bound({size, 0}); it != _freeBlocks.end()) {
+            auto [blockSize, addr] = *it;
+            _freeBlocks.erase(it);
+            _head.erase(addr);
+            _tail.erase(addr + blockSize);
+            if (blockSize > size) {
+                _head.emplace(addr + size, blockSize - size);
+                _tail.emplace(addr + blockSize, blockSize - size);
+                _freeBlocks.insert({blockSize - size, addr + size});
+            }
+            return addr;
+        }
+        if (auto it = _tail.find(_peak); it != _tail.end()) {
+            auto blockSize = it->second, addr = _peak - blockSize;
+            _freeBlocks.erase({blockSize, addr});
+            _head.erase(addr);
+            _tail.erase(it);
+            _peak += size - blockSize;
+            return addr;
+        }
+        auto addr = _peak;
+        _peak += size;
+        return addr;
+    }
+
+    void free(size_t addr, size_t size) {
+        size = alignBytes(size, _alignment);
+        auto head = addr, tail = addr + size;
+        if (auto it = _tail.find(head); it != _tail.end()) {
+            head -= it->second;
+            size += it->second;
+            _freeBlocks.erase({it->second, head});
+            _head.erase(head);
+            _tail.erase(it);
+        }
+        if (auto it = _head.find(tail); it != _head.end()) {
+            tail += it->second;
+            size += it->second;
+            _freeBlocks.erase({it->second, it->first});
+            _head.erase(it);
+            _tail.erase(tail);
+        }
+        _freeBlocks.insert({size, head});
+        _head.emplace(head, size);
+        _tail.emplace(tail, size);
+    }
+
+    size_t peak() const noexcept { return _peak; }
+};
+
+// an alloc/free trace, a free refers to the alloc at position `target`
+struct TraceOp {
+    bool alloc;
+    size_t size, target;
+};
+
+// tensors of a few typical sizes with mostly short and occasionally long lifetimes, like a transformer graph
+static std::vector<TraceOp> syntheticTrace(size_t allocs, uint32_t seed) {
+    std::mt19937 rng(seed);
+    constexpr static size_t SIZES[]{4096, 16384, 65536, 65536 * 3, 1 << 20, 4 << 20, 100, 7000};
+    std::vector<TraceOp> ans;
+    std::vector<std::pair<size_t, size_t>> live;// (death, alloc position)
+    for (size_t i = 0; i < allocs; ++i) {
+        auto size = SIZES[rng() % std::size(SIZES)] * (1 + rng() % 4);
+        auto lifetime = rng() % 16 == 0 ? 1 + rng() % 2048 : 1 + rng() % 8;
+        live.emplace_back(i + lifetime, ans.size());
+        ans.push_back({true, size, 0});
+        for (auto j = live.size(); j-- > 0;) {
+            if (live[j].first == i) {
+                ans.push_back({false, ans[live[j].second].size, live[j].second});
+                live[j] = live.back();
+                live.pop_back();
+            }
+        }
+    }
+    for (auto [_, alloc] : live) { ans.push_back({false, ans[alloc].size, alloc}); }
+    return ans;
+}
+
+template<class T>
+static std::vector<size_t> replay(T &calculator, std::vector<TraceOp> const &trace) {
+    std::vector<size_t> ans(trace.size());
+    for (size_t i = 0; i < trace.size(); ++i) {
+        auto const &op = trace[i];
+        if (op.alloc) {
+            ans[i] = calculator.alloc(op.size);
+        } else {
+            calculator.free(ans[op.target], op.size);
+        }
+    }
+    return ans;
+}
+
+// parse the "CALCULATOR" lines logged by a calculator constructed with `trace = true`
+static std::vector<TraceOp> recordedTrace(char const *path) {
+    std::vector<TraceOp> ans;
+    std::unordered_map<size_t, size_t> allocAt;// begin -> alloc position
+    std::ifstream is(path);
+    std::string line;
+    while (std::getline(is, line)) {
+        auto pos = line.find("CALCULATOR ");
+        if (pos == std::string::npos) { continue; }
+        std::istringstream ss(line.substr(pos));
+        std::string tag, self, event;
+        size_t begin, end;
+        ss >> tag >> self >> event >> begin >> end;
+        if (event == "alloc") {
+            allocAt[begin] = ans.size();
+            ans.push_back({true, end - begin, 0});
+        } else if (auto it = allocAt.find(begin); it != allocAt.end()) {
+            ans.push_back({false, end - begin, it->second});
+            allocAt.erase(it);
+        }
+    }
+    return ans;
+}
+
+TEST(MemOffsetCalculator, testSameAsReference) {
+    for (auto seed : {1u, 2u, 3u}) {
+        auto trace = syntheticTrace(20000, seed);
+        OffsetCalculator calculator(256);
+        ReferenceCalculator reference(256);
+        EXPECT_EQ(replay(calculator, trace), replay(reference, trace));
+        EXPECT_EQ(calculator.peak(), reference.peak());
+    }
+}
+
+TEST(MemOffsetCalculator, DISABLED_testReplayBenchmark) {
+    // set OFFSET_CALCULATOR_TRACE to a debug log of a compilation to replay a recorded trace
+    auto path = std::getenv("OFFSET_CALCULATOR_TRACE");
+    auto trace = path ? recordedTrace(path) : syntheticTrace(200000, 0);
+    ASSERT_FALSE(trace.empty());
+
+    using namespace std::chrono;
+    auto measure = [&](auto &&calculator) {
+        auto t0 = high_resolution_clock::now();
+        auto offsets = replay(calculator, trace);
+        auto t1 = high_resolution_clock::now();
+        return std::make_pair(duration_cast<duration<double, std::nano>>(t1 - t0).count() / trace.size(),
+                              std::move(offsets));
+    };
+    auto [flat, a] = measure(OffsetCalculator(256));
+    auto [tree, b] = measure(ReferenceCalculator(256));
+    EXPECT_EQ(a, b);
+    fmt::println("replay {} ops from {}: flat bins {:.1f} ns/op, tree and hash maps {:.1f} ns/op, {:.2f}x",
+                 trace.size(), path ? path : "a synthetic trace", flat, tree, tree / flat);
+}
@@ -1,6 +1,8 @@
 #include "../src/devices/cpu/memory.hh"
 #include "hardware/mem_pool.h"
+#include <cstring>
 #include <gtest/gtest.h>
+#include <thread>
 
 using namespace refactor;
 using namespace hardware;
@@ -30,3 +32,137 @@ TEST(MemPool, testMallocFreeCpu) {
     auto ePtr = memPool.malloc(b + c);
     EXPECT_EQ(ePtr, bPtr);
 }
+
+// counts the bytes held from the system so that tests can see arenas come and go
+class CountingMemory final : public Memory {
+public:
+    std::atomic_size_t held = 0;
+
+    void *malloc(size_t bytes) final {
+        held += bytes;
+        auto ans = std::malloc(bytes + sizeof(size_t));
+        *static_cast<size_t *>(ans) = bytes;
+        return static_cast<size_t *>(ans) + 1;
+    }
+    void free(void *ptr) final {
+        auto base = static_cast<size_t *>(ptr) - 1;
+        held -= *base;
+        std::free(base);
+    }
+    void *copyHD(void *dst, void const *src, size_t bytes) const noexcept final {
+        return std::memcpy(dst, src, bytes);
+    }
+    void *copyDH(void *dst, void const *src, size_t bytes) const noexcept final {
+        return std::memcpy(dst, src, bytes);
+    }
+    void *copyDD(void *dst, void const *src, size_t bytes) const noexcept final {
+        return std::memcpy(dst, src, bytes);
+    }
+};
+
+TEST(MemPool, testGrowAndRelease) {
+    auto parent = std::make_shared<CountingMemory>();
+    MemPool memPool(parent, 1 << 20, 8, {.idleRelease = std::chrono::hours(1)});
+    EXPECT_EQ(parent->held, 1 << 20);
+
+    // the first arena is full, so the pool chains more instead of failing
+    std::vector<void *> blocks;
+    for (auto i : range0_(5)) {
+        blocks.push_back(memPool.malloc(768 << 10));
+        std::memset(blocks.back(), i, 768 << 10);
+    }
+    auto stats = memPool.stats();
+    EXPECT_EQ(stats.arenas, 5);
+    EXPECT_EQ(stats.reserved, 5 << 20);
+    EXPECT_EQ(stats.live, 5 * (768 << 10));
+    EXPECT_EQ(parent->held, 5 << 20);
+    // a block larger than an arena gets an arena of its own
+    auto huge = memPool.malloc(3 << 20);
+    EXPECT_EQ(memPool.stats().arenas, 6);
+    memPool.free(huge);
+
+    for (auto i : range0_(5)) {
+        EXPECT_EQ(static_cast<uint8_t *>(blocks[i])[(768 << 10) - 1], i);
+        memPool.free(blocks[i]);
+    }
+    // empty arenas stay until they have been idle long enough
+    EXPECT_EQ(memPool.trim(std::chrono::hours(1)), 0);
+    EXPECT_EQ(memPool.trim(), (4 << 20) + (3 << 20));
+    stats = memPool.stats();
+    EXPECT_EQ(stats.arenas, 1);
+    EXPECT_EQ(stats.live, 0);
+    EXPECT_EQ(stats.peak, 5 * (768 << 10) + (3 << 20));
+    EXPECT_EQ(parent->held, 1 << 20);
+}
+
+TEST(MemPool, testIdleRelease) {
+    auto parent = std::make_shared<CountingMemory>();
+    MemPool memPool(parent, 1 << 20, 8, {.idleRelease = {}});
+    auto a = memPool.malloc(1 << 20),
+         b = memPool.malloc(1 << 20);
+    EXPECT_EQ(parent->held, 2 << 20);
+    // with no idle time, a chained arena goes back as soon as it is empty
+    memPool.free(b);
+    EXPECT_EQ(parent->held, 1 << 20);
+    memPool.free(a);
+    EXPECT_EQ(parent->held, 1 << 20);
+}
+
+TEST(MemPool, testFragmentation) {
+    MemPool memPool(std::make_shared<CpuMemory>(), 1 << 20, 8, {.smallLimit = 0});
+    EXPECT_EQ(memPool.stats().fragmentation, 0);
+    std::vector<void *> blocks;
+    for (auto i = 0; i < 16; ++i) { blocks.push_back(memPool.malloc(64 << 10)); }
+    EXPECT_EQ(memPool.stats().fragmentation, 0);
+    // every other block freed, the free bytes are split into 64 KiB holes
+    for (auto i = 0; i < 16; i += 2) { memPool.free(blocks[i]); }
+    auto stats = memPool.stats();
+    EXPECT_EQ(stats.live, 8 * (64 << 10));
+    EXPECT_DOUBLE_EQ(stats.fragmentation, 1 - 1. / 8);
+    for (auto i = 1; i < 16; i += 2) { memPool.free(blocks[i]); }
+    EXPECT_EQ(memPool.stats().fragmentation, 0);
+}
+
+TEST(MemPool, testSmallBlocksAcrossThreads) {
+    constexpr static size_t THREADS = 4, ROUNDS = 64, BLOCKS = 256;
+    MemPool memPool(std::make_shared<CpuMemory>(), 16 << 20, 8);
+
+    // every thread frees the blocks the previous one allocated in the last round,
+    // so blocks keep migrating between thread caches
+    std::vector<std::vector<std::pair<uint32_t *, size_t>>> handoff(THREADS);
+    std::mutex mutex;
+    std::atomic_bool overlapped = false;
+    auto work = [&](size_t id) {
+        std::vector<std::pair<uint32_t *, size_t>> mine;
+        for (auto round : range0_(ROUNDS)) {
+            for (auto i : range0_(BLOCKS)) {
+                auto n = 1 + (round * BLOCKS + i + id) % 1000;
+                auto ptr = static_cast<uint32_t *>(memPool.malloc(n * sizeof(uint32_t)));
+                auto tag = static_cast<uint32_t>(id << 24 | round << 12 | i);
+                std::fill_n(ptr, n, tag);
+                mine.emplace_back(ptr, n);
+            }
+            for (auto [ptr, n] : mine) {
+                if (std::any_of(ptr, ptr + n, [v = ptr[0]](auto x) { return x != v; })) { overlapped = true; }
+            }
+            decltype(mine) theirs;
+            {
+                std::lock_guard lock(mutex);
+                std::swap(theirs, handoff[(id + 1) % THREADS]);
+                handoff[id].insert(handoff[id].end(), mine.begin(), mine.end());
+            }
+            for (auto [ptr, n] : theirs) { memPool.free(ptr); }
+            mine.clear();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (auto i : range0_(THREADS)) { threads.emplace_back(work, i); }
+    for (auto &t : threads) { t.join(); }
+    for (auto &blocks : handoff) {
+        for (auto [ptr, n] : blocks) { memPool.free(ptr); }
+    }
+    EXPECT_FALSE(overlapped);
+    auto stats = memPool.stats();
+    EXPECT_EQ(stats.live, 0);
+    EXPECT_GT(stats.peak, 0);
+}
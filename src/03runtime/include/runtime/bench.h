@@ -0,0 +1,66 @@
+﻿#ifndef RUNTIME_BENCH_H
+#define RUNTIME_BENCH_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace refactor::runtime {
+    using Duration = std::chrono::nanoseconds;
+
+    /// @brief 一组计时样本的统计量。
+    struct Percentiles {
+        Duration min, median, p99, max, mean;
+
+        /// @brief 统计一组样本，样本为空时所有统计量为 0。
+        static Percentiles of(std::vector<Duration>);
+    };
+
+    /// @brief 硬件性能计数器的读数。
+    struct PerfCounts {
+        uint64_t cycles, instructions, cacheReferences, cacheMisses, branches, branchMisses;
+
+        PerfCounts &operator+=(PerfCounts const &) noexcept;
+        PerfCounts operator-(PerfCounts const &) const noexcept;
+
+        double ipc() const noexcept;
+        double cacheMissRate() const noexcept;
+        double branchMissRate() const noexcept;
+    };
+
+    /// @brief 调用线程上的一组硬件性能计数器，目前只在 Linux 上通过 perf_event 实现。
+    ///        计数器无法打开时（不支持的平台、虚拟机或 `perf_event_paranoid` 限制），
+    ///        `available` 返回 false，读数恒为 0。单独打开失败的计数器读数也为 0。
+    ///        只统计调用线程，例程内部启动的线程不计入。
+    class PerfCounters {
+        std::array<int, 6> _fds;
+        /// @brief 每个打开成功的计数器在组读数中的位置。
+        std::array<int, 6> _slots;
+        int _count;
+
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        PerfCounters(PerfCounters const &) = delete;
+        PerfCounters &operator=(PerfCounters const &) = delete;
+
+        bool available() const noexcept;
+        /// @brief 读取累计值，计数器被复用时按实际计数的时间比例缩放。
+        PerfCounts read() const noexcept;
+    };
+
+    /// @brief 基准测试的原始样本。
+    struct BenchResult {
+        /// @brief 每个节点在每次迭代中的耗时，按节点序号索引。
+        std::vector<std::vector<Duration>> nodes;
+        /// @brief 每次迭代中各节点耗时之和，不含读取计数器的时间。
+        std::vector<Duration> total;
+        /// @brief 每个节点在所有迭代中累计的计数器读数，未开启或计数器不可用时为空。
+        std::vector<PerfCounts> counters;
+    };
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_BENCH_H
@@ -0,0 +1,40 @@
+﻿#ifndef RUNTIME_JSON_H
+#define RUNTIME_JSON_H
+
+#include "common.h"
+
+namespace refactor::runtime {
+
+    /// @brief 转义为 JSON 字符串字面量。
+    inline std::string jsonString(std::string_view s) {
+        std::string ans("\"");
+        for (auto c : s) {
+            switch (c) {
+                case '"':
+                    ans += "\\\"";
+                    break;
+                case '\\':
+                    ans += "\\\\";
+                    break;
+                case '\n':
+                    ans += "\\n";
+                    break;
+                case '\t':
+                    ans += "\\t";
+                    break;
+                default:
+                    if (static_cast<uint8_t>(c) < 0x20) {
+                        ans += fmt::format("\\u{:04x}", static_cast<int>(c));
+                    } else {
+                        ans += c;
+                    }
+                    break;
+            }
+        }
+        ans += '"';
+        return ans;
+    }
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_JSON_H
@@ -0,0 +1,52 @@
+﻿#ifndef RUNTIME_MEMORY_REPORT_H
+#define RUNTIME_MEMORY_REPORT_H
+
+#include "graph_topo.h"
+#include <ostream>
+
+namespace refactor::runtime {
+    struct Node;
+    struct Edge;
+
+    /// @brief 栈上的一个缓冲区。
+    struct MemoryBuffer {
+        enum class Kind : uint8_t {
+            Edge,
+            Workspace,
+        } kind;
+        /// @brief 边或工作空间所属节点的序号。
+        count_t index;
+        std::string name;
+        size_t offset, size;
+        /// @brief 第一次和最后一次使用它的节点在拓扑序中的位置，包含两端。
+        count_t first, last;
+    };
+
+    /// @brief 一个流的内存规划。
+    ///        每一步的存活字节数是当步存活的缓冲区覆盖的字节数，
+    ///        原地执行和子缓冲区共享的存储只计一次。
+    struct MemoryReport {
+        /// @brief 栈的大小。
+        size_t stack;
+        /// @brief 存活字节数的最大值，以及第一次达到它的步。
+        size_t peak;
+        count_t peakStep;
+        /// @brief 栈中在峰值时也不被使用的比例：1 - peak / stack，栈为空时为 0。
+        double fragmentation;
+        /// @brief 按拓扑序每一步的存活字节数。
+        std::vector<size_t> live;
+        std::vector<MemoryBuffer> buffers;
+
+        static MemoryReport build(graph_topo::Graph<Node, Edge> const &, size_t stack);
+
+        /// @brief 峰值时存活的缓冲区在 `buffers` 中的序号，从大到小排列。
+        std::vector<count_t> atPeak() const;
+        void writeJson(std::ostream &) const;
+        /// @brief 写出包含 SVG 生存期图的 HTML 页面：
+        ///        横轴是拓扑序，纵轴是栈中的偏移，每个缓冲区是一个矩形，下方是存活字节数的曲线。
+        void writeHtml(std::ostream &) const;
+    };
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_MEMORY_REPORT_H
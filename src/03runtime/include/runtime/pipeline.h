@@ -0,0 +1,64 @@
+﻿#ifndef RUNTIME_PIPELINE_H
+#define RUNTIME_PIPELINE_H
+
+#include "stream.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace refactor::runtime {
+
+    /// @brief 异步推理流水线。
+    ///        持有一个流的 `depth` 个分叉（称为槽），提交的槽在专用的执行线程上按提交顺序运行，
+    ///        调用线程可以在前一批运行时向空闲的槽写入下一批输入。
+    ///        同时在飞的推理不超过 `depth` 个：所有槽都被占用时 `acquire` 阻塞。
+    ///        一个槽的生命周期是 `acquire` -> 写入输入 -> `submit`，
+    ///        执行线程运行推理并调用完成回调取走输出后自动归还槽。
+    class Pipeline {
+    public:
+        /// @brief 完成回调，在执行线程上以槽对应的流调用，用于取走输出。
+        using Finish = std::function<void(Stream &)>;
+
+    private:
+        struct Task {
+            count_t slot;
+            Finish finish;
+            std::promise<void> promise;
+        };
+
+        std::vector<Stream> _streams;
+        std::vector<count_t> _free;
+        std::deque<Task> _queue;
+        std::mutex _mutex;
+        std::condition_variable _released, _submitted;
+        bool _stop;
+        std::thread _worker;
+
+        void loop();
+
+    public:
+        /// @brief 从 `stream` 分叉出 `depth` 个槽，权重和只读资源共享。
+        Pipeline(Stream const &stream, count_t depth);
+        ~Pipeline();
+
+        Pipeline(Pipeline const &) = delete;
+        Pipeline &operator=(Pipeline const &) = delete;
+
+        auto depth() const noexcept -> count_t;
+        /// @brief 取得一个空闲的槽，所有槽都被占用时阻塞。
+        auto acquire() -> count_t;
+        /// @brief 槽对应的流，只能在取得槽之后、提交之前访问。
+        auto stream(count_t) -> Stream &;
+        /// @brief 提交槽，返回完成回调结束时就绪的 future。
+        ///        例程或回调抛出的异常由 future 重新抛出，此时槽同样被归还。
+        auto submit(count_t, Finish = nullptr) -> std::future<void>;
+        /// @brief 归还取得后没有提交的槽。
+        void release(count_t);
+    };
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_PIPELINE_H
@@ -12,18 +12,22 @@ namespace refactor::runtime {
         virtual ~Resource() = default;
         virtual size_t resourceTypeId() const = 0;
         virtual std::string_view description() const = 0;
+        /// @brief 资源在运行时是否只读。只读资源可以被分叉出的流共享。
+        virtual bool shareable() const noexcept { return false; }
         bool is(size_t) const noexcept;
     };
 
     using ResourceBox = std::unique_ptr<Resource>;
 
     class Resources {
-        std::unordered_map<size_t, std::unique_ptr<Resource>> _internal;
+        std::unordered_map<size_t, std::shared_ptr<Resource>> _internal;
 
     public:
         Resource *fetch(size_t) noexcept;
         Resource *fetchOrStore(ResourceBox) noexcept;
         Resource *fetchOrStore(size_t, std::function<ResourceBox()>);
+        /// @brief 复制资源表，只共享只读的资源，其他资源由新表在需要时重新构造。
+        Resources fork() const;
 
         template<class T> T *fetch() noexcept {
             return dynamic_cast<T *>(fetch(T::typeId()));
@@ -0,0 +1,69 @@
+#ifndef RUNTIME_SCHEDULER_H
+#define RUNTIME_SCHEDULER_H
+
+#include "stream.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace refactor::runtime {
+
+    /// @brief 在 CPU 上按依赖关系并行执行计算图的调度器。
+    ///        依赖既来自数据边，也来自内存复用：
+    ///        两个步骤访问的地址区间重叠且至少一个写入时，按拓扑序保持先后，
+    ///        因此结果与顺序执行逐位一致。
+    ///        并行执行时，例程不能修改 `Resources`。
+    class DagScheduler {
+        /// @brief 每个工作线程持有一个就绪队列，自己从队尾取，其他线程从队首窃取。
+        struct Queue {
+            std::mutex mutex;
+            std::deque<count_t> steps;
+        };
+
+        /// @brief 依赖图，以压缩行的形式存储每个步骤的后继。
+        std::vector<count_t> _successorsOffset, _successors, _predecessorsCount;
+        std::unique_ptr<std::atomic<count_t>[]> _counters;
+
+        std::vector<Queue> _queues;
+        std::vector<std::thread> _helpers;
+
+        ExecutionPlan const *_plan;
+        Resources *_resources;
+        Timeline *_timeline;
+        count_t _run;
+        std::exception_ptr _exception;
+        std::atomic<count_t> _remaining, _queued, _sleeping, _active;
+        std::mutex _mutex;
+        std::condition_variable _start, _ready, _done;
+        size_t _generation;
+        bool _stop;
+
+        void loop(count_t);
+        void work(count_t);
+        bool pop(count_t, count_t &);
+        void push(count_t, count_t);
+        void execute(count_t, count_t);
+
+    public:
+        /// @brief 创建调度器，调用 `run` 的线程也参与执行，因此只额外启动 `threads - 1` 个线程。
+        explicit DagScheduler(count_t threads);
+        ~DagScheduler();
+
+        DagScheduler(DagScheduler const &) = delete;
+        DagScheduler &operator=(DagScheduler const &) = delete;
+
+        auto threads() const noexcept -> count_t;
+        /// @brief 根据执行计划中的地址建立依赖图，执行计划重建后必须重新调用。
+        void build(ExecutionPlan const &, graph_topo::Graph<Node, Edge> const &);
+        /// @brief 返回步骤的前驱数量，步骤按执行计划中的顺序编号。
+        auto predecessors(count_t) const noexcept -> count_t;
+        /// @brief 执行计划。`timeline` 非空时，由执行各步骤的线程以序号 `run` 记录起止时间。
+        void run(ExecutionPlan const &, Resources &, Timeline *timeline = nullptr, count_t run = 0);
+    };
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_SCHEDULER_H
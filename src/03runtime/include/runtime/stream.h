@@ -1,37 +1,111 @@
 ﻿#ifndef RUNTIME_STREAM_H
 #define RUNTIME_STREAM_H
 
+#include "bench.h"
 #include "graph_topo.h"
 #include "hardware/device.h"
+#include "memory_report.h"
 #include "resource.h"
+#include "timeline.h"
 #include <chrono>
+#include <optional>
 
 namespace refactor::runtime {
     using Routine = std::function<void(runtime::Resources &, void *, void const *const *, void *const *)>;
 
     void emptyRoutine(runtime::Resources &, void *, void const *const *, void *const *);
 
+    /// @brief 节点一侧的每个张量都是另一侧第 0 个张量中的一段连续区间：
+    ///        拼接的各输入是输出的区间，切分的各输出是输入的区间。
+    ///        内存规划把它们直接放在对应的位置上时，例程不必复制。
+    struct SubBuffers {
+        enum class Side : uint8_t {
+            None,
+            Inputs,
+            Outputs,
+        } side = Side::None;
+        /// @brief 各张量在另一侧第 0 个张量中的字节偏移。
+        std::vector<size_t> offsets;
+    };
+
     struct Node {
         Routine routine;
         size_t workspaceOffset;
+        /// @brief 工作空间的大小，分配器改写 `workspaceOffset` 后仍然保留。
+        size_t workspaceSize;
+        /// @brief 节点的名字和生成例程的内核的描述，用于性能分析。
+        std::string name, description;
+        /// @brief 节点的浮点运算量和访存字节数，用于屋顶线分析。
+        size_t flops, bytesRead, bytesWritten;
+        /// @brief 第 0 个输出可以原地复用其存储的输入序号，按优先顺序排列。
+        std::vector<count_t> inplace;
+        SubBuffers subBuffers;
 
         template<class T>
         Node(T &&r, size_t wso = 0) noexcept
             : routine(std::forward<T>(r)),
-              workspaceOffset(wso) {}
+              workspaceOffset(wso),
+              workspaceSize(wso),
+              name(),
+              description(),
+              flops(0),
+              bytesRead(0),
+              bytesWritten(0),
+              inplace(),
+              subBuffers() {}
     };
 
     struct Edge {
         Arc<hardware::Device::Blob> blob;
         size_t stackOffset;
+        size_t size;
         std::string name;
     };
 
+    /// @brief 预编译的执行计划。
+    ///        所有节点的例程、工作空间和输入输出地址按拓扑序展平到连续的数组中，
+    ///        运行时不必再逐个边查询地址。
+    class ExecutionPlan {
+    public:
+        struct Step {
+            count_t node;
+            Routine const *routine;
+            void *workspace;
+            void const *const *inputs;
+            void *const *outputs;
+        };
+
+    private:
+        std::vector<void *> _addresses;
+        std::vector<Step> _steps;
+
+    public:
+        ExecutionPlan(graph_topo::Graph<Node, Edge> const &, void *stack);
+
+        auto steps() const noexcept -> std::vector<Step> const & { return _steps; }
+        auto begin() const noexcept { return _steps.begin(); }
+        auto end() const noexcept { return _steps.end(); }
+    };
+
+    class DagScheduler;
+
     class Stream {
         Arc<hardware::Device> _device;
         Arc<hardware::Device::Blob> _stack;
         Resources _resources;
         graph_topo::Graph<Node, Edge> _graph;
+        /// @brief 执行计划在首次运行时构造，重新绑定边时失效。
+        std::optional<ExecutionPlan> _plan;
+        /// @brief 并行调度器，仅在 CPU 上设置了多个线程时存在。
+        std::unique_ptr<DagScheduler> _scheduler;
+        /// @brief 时间线记录器，为空时不记录。分叉出的流共享同一个记录器。
+        Arc<Timeline> _timeline;
+
+        /// @brief 栈上为第 i 条边预留的位置的视图，没有预留位置时为空。
+        auto stackSlot(count_t) const -> Arc<hardware::Device::Blob>;
+        /// @brief 将栈上有固定位置的全局输入输出绑定为栈的视图。
+        void bindStack();
+        bool onStack(count_t) const noexcept;
 
     public:
         Stream(decltype(_resources),
@@ -40,15 +114,38 @@ namespace refactor::runtime {
                std::vector<Node>,
                std::vector<Edge>,
                decltype(_device));
+        Stream(Stream &&) noexcept;
+        Stream &operator=(Stream &&) noexcept;
+        ~Stream();
 
         decltype(_graph) const &graph() const noexcept { return _graph; }
+        auto plan() -> ExecutionPlan const &;
+        /// @brief 分叉出一个可以与当前流并发运行的流。
+        ///        新流共享权重和只读资源，拥有独立的栈和全局输入输出。
+        ///        已绑定的全局输入会被复制到新流。
+        auto fork() const -> Stream;
+        /// @brief 设置并行执行的线程数，仅支持 CPU 设备。
+        ///        线程数为 0 或 1 时按拓扑序顺序执行。
+        void setParallelism(count_t);
+        auto parallelism() const noexcept -> count_t;
+        /// @brief 设置时间线记录器，之后每次 `run` 都记录各节点的起止时间。
+        void setTimeline(Arc<Timeline>);
+        auto timeline() const noexcept -> Arc<Timeline> const &;
+        /// @brief 栈上每条边和每个工作空间的位置与生存期，以及每一步的存活字节数。
+        auto memoryReport() const -> MemoryReport;
         auto setData(count_t, size_t) -> Arc<hardware::Device::Blob>;
         void setData(count_t, Arc<hardware::Device::Blob>);
         auto getData(count_t) const -> Arc<hardware::Device::Blob>;
+        /// @brief 设置全局输入的数据。
+        ///        已绑定的存储块足够大时直接复制到其中，不分配内存，也不使执行计划失效。
+        ///        输入曾被重新绑定时，数据放得下就写回栈上预留的位置。
         void setData(count_t, void const *, size_t);
         bool copyData(count_t, void *, size_t) const;
         void run();
-        auto bench(void (*sync)()) -> std::vector<std::chrono::nanoseconds>;
+        /// @brief 预热 `warmup` 次后，逐节点计时 `iterations` 次。
+        ///        `sync` 非空时在每个节点之后调用，端到端耗时也包含这些同步。
+        ///        `counters` 为 true 时同时读取调用线程的硬件性能计数器。
+        auto bench(void (*sync)(), count_t warmup = 0, count_t iterations = 1, bool counters = false) -> BenchResult;
         void trace(std::function<void(count_t, void const *const *, void const *const *)>);
     };
 
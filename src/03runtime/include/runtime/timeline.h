@@ -0,0 +1,67 @@
+﻿#ifndef RUNTIME_TIMELINE_H
+#define RUNTIME_TIMELINE_H
+
+#include "graph_topo.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace refactor::runtime {
+    struct Node;
+    struct Edge;
+
+    /// @brief 记录每次运行中各节点起止时间的时间线。
+    ///        每个线程写入自己的缓冲区，记录时不加锁；
+    ///        只有线程第一次向某个时间线记录时需要加锁注册缓冲区。
+    ///        事件由调用例程的线程记录，因此例程内部再启动的线程（如 `std::execution::par_unseq`）
+    ///        不影响记录，其耗时计入发起它的节点。
+    class Timeline {
+    public:
+        using Clock = std::chrono::steady_clock;
+        /// @brief 表示整次运行而非某个节点的事件。
+        constexpr static count_t RUN = std::numeric_limits<count_t>::max();
+
+        struct Event {
+            count_t run, node;
+            Clock::time_point begin, end;
+        };
+
+    private:
+        struct Buffer {
+            count_t thread;
+            std::vector<Event> events;
+        };
+
+        Clock::time_point _origin;
+        std::atomic<count_t> _runs;
+        mutable std::mutex _mutex;
+        /// @brief 线程局部缓存以弱引用指向这些缓冲区，时间线销毁后缓存项随之失效。
+        std::vector<std::shared_ptr<Buffer>> _buffers;
+
+        Buffer &buffer();
+
+    public:
+        Timeline();
+
+        Timeline(Timeline const &) = delete;
+        Timeline &operator=(Timeline const &) = delete;
+
+        /// @brief 分配一个新的运行序号。
+        count_t beginRun() noexcept;
+        /// @brief 向调用线程的缓冲区追加一个事件。
+        void record(count_t run, count_t node, Clock::time_point begin, Clock::time_point end);
+
+        // 以下方法要求没有线程正在记录
+
+        /// @brief 按线程分组返回所有事件，分组的序号即线程编号。
+        auto events() const -> std::vector<std::vector<Event>>;
+        void clear();
+        /// @brief 以 Chrome trace 格式写出时间线，可以用 Perfetto 或 chrome://tracing 打开。
+        void writeChromeTrace(std::ostream &, graph_topo::Graph<Node, Edge> const &) const;
+    };
+
+}// namespace refactor::runtime
+
+#endif// RUNTIME_TIMELINE_H
@@ -0,0 +1,126 @@
+﻿#include "runtime/bench.h"
+#include "common.h"
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace refactor::runtime {
+
+    Percentiles Percentiles::of(std::vector<Duration> samples) {
+        if (samples.empty()) { return {}; }
+        std::sort(samples.begin(), samples.end());
+        auto n = samples.size();
+        // 最近秩法，p99 取不小于 99% 样本的最小样本
+        auto rank = [&](size_t p) { return samples[std::max<size_t>((n * p + 99) / 100, 1) - 1]; };
+        return {
+            samples.front(),
+            rank(50),
+            rank(99),
+            samples.back(),
+            std::accumulate(samples.begin(), samples.end(), Duration::zero()) / n,
+        };
+    }
+
+    PerfCounts &PerfCounts::operator+=(PerfCounts const &rhs) noexcept {
+        cycles += rhs.cycles;
+        instructions += rhs.instructions;
+        cacheReferences += rhs.cacheReferences;
+        cacheMisses += rhs.cacheMisses;
+        branches += rhs.branches;
+        branchMisses += rhs.branchMisses;
+        return *this;
+    }
+    PerfCounts PerfCounts::operator-(PerfCounts const &rhs) const noexcept {
+        // 缩放后的读数可能轻微回退，差值截断到 0
+        auto sub = [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; };
+        return {
+            sub(cycles, rhs.cycles),
+            sub(instructions, rhs.instructions),
+            sub(cacheReferences, rhs.cacheReferences),
+            sub(cacheMisses, rhs.cacheMisses),
+            sub(branches, rhs.branches),
+            sub(branchMisses, rhs.branchMisses),
+        };
+    }
+    static double ratio(uint64_t a, uint64_t b) noexcept {
+        return b ? static_cast<double>(a) / static_cast<double>(b) : 0;
+    }
+    double PerfCounts::ipc() const noexcept { return ratio(instructions, cycles); }
+    double PerfCounts::cacheMissRate() const noexcept { return ratio(cacheMisses, cacheReferences); }
+    double PerfCounts::branchMissRate() const noexcept { return ratio(branchMisses, branches); }
+
+#ifdef __linux__
+
+    PerfCounters::PerfCounters() : _fds{}, _slots{}, _count(0) {
+        // 顺序与 `PerfCounts` 的字段一致
+        constexpr static uint64_t CONFIGS[]{
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_REFERENCES,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        _fds.fill(-1);
+        _slots.fill(-1);
+        for (auto i : range0_(_fds.size())) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = CONFIGS[i];
+            attr.disabled = _fds[0] == -1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            auto fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, _fds[0], 0));
+            if (fd < 0) {
+                // 没有周期计数器作为组长时，整组不可用
+                if (i == 0) { return; }
+                continue;
+            }
+            _fds[i] = fd;
+            _slots[i] = _count++;
+        }
+        ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    PerfCounters::~PerfCounters() {
+        for (auto fd : _fds) {
+            if (fd >= 0) { close(fd); }
+        }
+    }
+
+    bool PerfCounters::available() const noexcept { return _count; }
+
+    PerfCounts PerfCounters::read() const noexcept {
+        if (!_count) { return {}; }
+        uint64_t buffer[3 + std::tuple_size_v<decltype(_fds)>];
+        if (::read(_fds[0], buffer, sizeof(buffer)) < 0 || !buffer[2]) { return {}; }
+        auto [nr, enabled, running] = std::tuple{buffer[0], buffer[1], buffer[2]};
+        uint64_t values[std::tuple_size_v<decltype(_fds)>]{};
+        for (auto i : range0_(_slots.size())) {
+            if (auto slot = _slots[i]; slot >= 0 && static_cast<uint64_t>(slot) < nr) {
+                values[i] = static_cast<uint64_t>(static_cast<double>(buffer[3 + slot]) * enabled / running);
+            }
+        }
+        return {values[0], values[1], values[2], values[3], values[4], values[5]};
+    }
+
+#else
+
+    PerfCounters::PerfCounters() : _fds{}, _slots{}, _count(0) {}
+    PerfCounters::~PerfCounters() = default;
+    bool PerfCounters::available() const noexcept { return false; }
+    PerfCounts PerfCounters::read() const noexcept { return {}; }
+
+#endif// __linux__
+
+}// namespace refactor::runtime
@@ -0,0 +1,213 @@
+﻿#include "runtime/memory_report.h"
+#include "runtime/json.h"
+#include "runtime/stream.h"
+#include <numeric>
+
+namespace refactor::runtime {
+    using Kind = MemoryBuffer::Kind;
+
+    MemoryReport MemoryReport::build(graph_topo::Graph<Node, Edge> const &graph, size_t stack) {
+        auto const &topology = graph.topology;
+        auto steps = static_cast<count_t>(topology.nodeCount());
+        constexpr static auto NONE = std::numeric_limits<count_t>::max();
+
+        // 每条栈上的边的首次和最后一次使用
+        std::vector<count_t> first(graph.edges.size(), NONE), last(graph.edges.size(), 0);
+        auto onStack = [&](count_t i) {
+            auto const &edge = graph.edges[i];
+            return edge.stackOffset != SIZE_MAX && edge.stackOffset + edge.size <= stack;
+        };
+        for (auto i : topology.globalInputs()) { first[i] = 0; }
+        std::vector<MemoryBuffer> buffers;
+        count_t step = 0;
+        for (auto [nodeIdx, inputs, outputs] : topology) {
+            for (auto i : inputs) { last[i] = std::max(last[i], step); }
+            for (auto i : outputs) {
+                first[i] = std::min(first[i], step);
+                last[i] = std::max(last[i], step);
+            }
+            auto const &node = graph.nodes[nodeIdx];
+            if (node.workspaceSize) {
+                buffers.push_back({
+                    Kind::Workspace,
+                    nodeIdx,
+                    node.name.empty() ? fmt::format("node {} workspace", nodeIdx) : node.name + " workspace",
+                    node.workspaceOffset,
+                    node.workspaceSize,
+                    step,
+                    step,
+                });
+            }
+            ++step;
+        }
+        for (auto i : topology.globalOutputs()) {
+            if (steps) { last[i] = steps - 1; }
+        }
+        for (auto i : range0_(graph.edges.size())) {
+            auto const &edge = graph.edges[i];
+            if (first[i] == NONE || !edge.size || !onStack(i)) { continue; }
+            buffers.push_back({
+                Kind::Edge,
+                static_cast<count_t>(i),
+                edge.name.empty() ? fmt::format("edge {}", i) : edge.name,
+                edge.stackOffset,
+                edge.size,
+                first[i],
+                std::max(first[i], last[i]),
+            });
+        }
+        std::sort(buffers.begin(), buffers.end(), [](auto const &a, auto const &b) {
+            return std::tie(a.first, a.offset) < std::tie(b.first, b.offset);
+        });
+
+        // 每一步存活的缓冲区覆盖的字节数，区间重叠的部分只计一次。
+        // 按步扫描缓冲区的开始和结束事件，用线段树维护偏移轴上被覆盖的长度
+        std::vector<size_t> bounds;
+        bounds.reserve(2 * buffers.size());
+        for (auto const &b : buffers) {
+            bounds.push_back(b.offset);
+            bounds.push_back(b.offset + b.size);
+        }
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+        struct Coverage {
+            std::vector<size_t> const &bounds;
+            std::vector<count_t> count;
+            std::vector<size_t> covered;
+
+            // 区间 [bounds[l], bounds[r]) 上每个位置的覆盖次数加 `delta`
+            void update(size_t node, size_t l, size_t r, size_t ql, size_t qr, int delta) {
+                if (qr <= l || r <= ql) { return; }
+                if (ql <= l && r <= qr) {
+                    count[node] += delta;
+                } else {
+                    auto mid = (l + r) / 2;
+                    update(2 * node, l, mid, ql, qr, delta);
+                    update(2 * node + 1, mid, r, ql, qr, delta);
+                }
+                covered[node] = count[node]  ? bounds[r] - bounds[l]
+                                : r - l == 1 ? 0
+                                             : covered[2 * node] + covered[2 * node + 1];
+            }
+        };
+        auto segments = bounds.empty() ? 0 : bounds.size() - 1;
+        Coverage coverage{bounds, std::vector<count_t>(4 * segments + 1, 0), std::vector<size_t>(4 * segments + 1, 0)};
+        auto update = [&](MemoryBuffer const &b, int delta) {
+            auto l = std::lower_bound(bounds.begin(), bounds.end(), b.offset) - bounds.begin(),
+                 r = std::lower_bound(bounds.begin(), bounds.end(), b.offset + b.size) - bounds.begin();
+            coverage.update(1, 0, segments, l, r, delta);
+        };
+
+        // 缓冲区已按开始的步排序，结束的步另行排序
+        std::vector<count_t> ends(buffers.size());
+        std::iota(ends.begin(), ends.end(), 0);
+        std::sort(ends.begin(), ends.end(), [&](auto a, auto b) { return buffers[a].last < buffers[b].last; });
+        std::vector<size_t> live(steps, 0);
+        auto begin = buffers.begin();
+        auto end = ends.begin();
+        for (auto s : range0_(steps)) {
+            for (; end != ends.end() && buffers[*end].last < s; ++end) { update(buffers[*end], -1); }
+            for (; begin != buffers.end() && begin->first <= s; ++begin) { update(*begin, +1); }
+            live[s] = segments ? coverage.covered[1] : 0;
+        }
+        auto peak = std::max_element(live.begin(), live.end());
+        auto peak_ = peak == live.end() ? 0 : *peak;
+        return {
+            stack,
+            peak_,
+            static_cast<count_t>(peak - live.begin()),
+            stack ? 1 - static_cast<double>(peak_) / stack : 0,
+            std::move(live),
+            std::move(buffers),
+        };
+    }
+
+    std::vector<count_t> MemoryReport::atPeak() const {
+        std::vector<count_t> ans;
+        for (auto i : range0_(buffers.size())) {
+            if (buffers[i].first <= peakStep && peakStep <= buffers[i].last) { ans.push_back(i); }
+        }
+        std::stable_sort(ans.begin(), ans.end(), [this](auto a, auto b) {
+            return buffers[a].size > buffers[b].size;
+        });
+        return ans;
+    }
+
+    void MemoryReport::writeJson(std::ostream &os) const {
+        os << fmt::format(R"({{"stack": {}, "peak": {}, "peak_step": {}, "fragmentation": {:.6f},)",
+                          stack, peak, peakStep, fragmentation)
+           << fmt::format("\n\"live\": [{}],", fmt::join(live, ", "))
+           << "\n\"buffers\": [";
+        for (auto i : range0_(buffers.size())) {
+            auto const &b = buffers[i];
+            os << (i ? ",\n" : "\n")
+               << fmt::format(R"({{"kind": "{}", "index": {}, "name": {}, "offset": {}, "size": {}, "first": {}, "last": {}}})",
+                              b.kind == Kind::Edge ? "edge" : "workspace",
+                              b.index, jsonString(b.name), b.offset, b.size, b.first, b.last);
+        }
+        os << "\n]}\n";
+    }
+
+    static std::string xmlString(std::string_view s) {
+        std::string ans;
+        for (auto c : s) {
+            switch (c) {
+                case '<': ans += "&lt;"; break;
+                case '>': ans += "&gt;"; break;
+                case '&': ans += "&amp;"; break;
+                case '"': ans += "&quot;"; break;
+                default: ans += c; break;
+            }
+        }
+        return ans;
+    }
+
+    void MemoryReport::writeHtml(std::ostream &os) const {
+        constexpr static double WIDTH = 1200, CHART = 600, CURVE = 150, MARGIN = 60;
+        auto steps = std::max<size_t>(live.size(), 1);
+        auto top = std::max<size_t>(stack, 1);
+        auto x = [&](double step) { return MARGIN + step * WIDTH / steps; };
+        auto y = [&](double offset) { return MARGIN + offset * CHART / top; };
+        auto mib = [](size_t bytes) { return bytes / 1048576.; };
+
+        os << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>memory plan</title></head><body>\n"
+           << fmt::format("<p>stack {:.2f} MiB, peak {:.2f} MiB at step {}, fragmentation {:.1f}%</p>\n",
+                          mib(stack), mib(peak), peakStep, fragmentation * 100)
+           << fmt::format(R"(<svg xmlns="http://www.w3.org/2000/svg" width="{}" height="{}" font-family="sans-serif" font-size="12">)",
+                          WIDTH + 2 * MARGIN, CHART + CURVE + 3 * MARGIN)
+           << '\n';
+
+        // 生存期图：边为蓝色，工作空间为橙色，峰值时存活的加深
+        os << fmt::format(R"(<rect x="{}" y="{}" width="{}" height="{}" fill="none" stroke="#888"/>)",
+                          MARGIN, MARGIN, WIDTH, CHART)
+           << '\n';
+        for (auto const &b : buffers) {
+            auto atPeak = b.first <= peakStep && peakStep <= b.last;
+            auto color = b.kind == Kind::Edge ? (atPeak ? "#1f5fa8" : "#7fb0e0")
+                                              : (atPeak ? "#c0601a" : "#f0b070");
+            os << fmt::format(R"(<rect x="{:.2f}" y="{:.2f}" width="{:.2f}" height="{:.2f}" fill="{}" stroke="#fff" stroke-width="0.5">)",
+                              x(b.first), y(b.offset), x(b.last + 1) - x(b.first), std::max(y(b.offset + b.size) - y(b.offset), .5), color)
+               << fmt::format("<title>{} [{}, {}) steps {}..{}</title></rect>\n",
+                              xmlString(b.name), b.offset, b.offset + b.size, b.first, b.last);
+        }
+        os << fmt::format(R"(<line x1="{0:.2f}" y1="{1}" x2="{0:.2f}" y2="{2}" stroke="red" stroke-dasharray="4 2"/>)",
+                          x(peakStep + .5), MARGIN, MARGIN + CHART)
+           << '\n'
+           << fmt::format(R"(<text x="{}" y="{}">offset (0 at top, {:.2f} MiB at bottom)</text>)", MARGIN, MARGIN - 8, mib(stack))
+           << '\n';
+
+        // 存活字节数的曲线
+        auto base = CHART + 2 * MARGIN + CURVE;
+        auto height = [&](size_t bytes) { return base - bytes * CURVE / static_cast<double>(top); };
+        os << fmt::format(R"(<rect x="{}" y="{}" width="{}" height="{}" fill="none" stroke="#888"/>)",
+                          MARGIN, base - CURVE, WIDTH, CURVE)
+           << "\n<polyline fill=\"none\" stroke=\"#1f5fa8\" points=\"";
+        for (auto s : range0_(live.size())) {
+            os << fmt::format("{:.2f},{:.2f} {:.2f},{:.2f} ", x(s), height(live[s]), x(s + 1), height(live[s]));
+        }
+        os << "\"/>\n"
+           << fmt::format(R"(<text x="{}" y="{}">live bytes per step, peak {:.2f} MiB</text>)", MARGIN, base - CURVE - 8, mib(peak))
+           << "\n</svg>\n</body></html>\n";
+    }
+
+}// namespace refactor::runtime
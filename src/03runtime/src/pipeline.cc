@@ -0,0 +1,99 @@
+﻿#include "runtime/pipeline.h"
+
+namespace refactor::runtime {
+
+    Pipeline::Pipeline(Stream const &stream, count_t depth)
+        : _streams(),
+          _free(),
+          _queue(),
+          _mutex(),
+          _released(),
+          _submitted(),
+          _stop(false),
+          _worker() {
+        ASSERT(depth > 0, "Pipeline depth must be positive");
+        _streams.reserve(depth);
+        _free.reserve(depth);
+        for (auto i : range0_(depth)) {
+            _streams.push_back(stream.fork());
+            // 倒序压入，使槽按 0, 1, 2, ... 的顺序被取得
+            _free.push_back(depth - 1 - i);
+        }
+        _worker = std::thread(&Pipeline::loop, this);
+    }
+
+    Pipeline::~Pipeline() {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _submitted.notify_one();
+        _worker.join();
+    }
+
+    auto Pipeline::depth() const noexcept -> count_t {
+        return static_cast<count_t>(_streams.size());
+    }
+
+    auto Pipeline::acquire() -> count_t {
+        std::unique_lock lock(_mutex);
+        _released.wait(lock, [this] { return !_free.empty(); });
+        auto slot = _free.back();
+        _free.pop_back();
+        return slot;
+    }
+
+    auto Pipeline::stream(count_t slot) -> Stream & {
+        return _streams.at(slot);
+    }
+
+    auto Pipeline::submit(count_t slot, Finish finish) -> std::future<void> {
+        ASSERT(slot < _streams.size(), "Pipeline slot out of range");
+        std::promise<void> promise;
+        auto ans = promise.get_future();
+        {
+            std::lock_guard lock(_mutex);
+            _queue.push_back({slot, std::move(finish), std::move(promise)});
+        }
+        _submitted.notify_one();
+        return ans;
+    }
+
+    void Pipeline::release(count_t slot) {
+        ASSERT(slot < _streams.size(), "Pipeline slot out of range");
+        {
+            std::lock_guard lock(_mutex);
+            _free.push_back(slot);
+        }
+        _released.notify_one();
+    }
+
+    void Pipeline::loop() {
+        while (true) {
+            std::unique_lock lock(_mutex);
+            _submitted.wait(lock, [this] { return _stop || !_queue.empty(); });
+            // 析构前提交的推理仍然会运行完，等待它们的 future 不会永远阻塞
+            if (_queue.empty()) { return; }
+            auto task = std::move(_queue.front());
+            _queue.pop_front();
+            lock.unlock();
+
+            std::exception_ptr exception = nullptr;
+            try {
+                auto &stream = _streams[task.slot];
+                stream.run();
+                if (task.finish) { task.finish(stream); }
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            // 先归还槽再通知，等待 future 的线程醒来后一定能取得槽
+            release(task.slot);
+            if (exception) {
+                task.promise.set_exception(exception);
+            } else {
+                task.promise.set_value();
+            }
+        }
+    }
+
+}// namespace refactor::runtime
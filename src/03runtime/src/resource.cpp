@@ -21,5 +21,14 @@ namespace refactor::runtime {
         }
         return it->second.get();
     }
+    auto Resources::fork() const -> Resources {
+        Resources ans;
+        for (auto const &[id, resource] : _internal) {
+            if (resource->shareable()) {
+                ans._internal.emplace(id, resource);
+            }
+        }
+        return ans;
+    }
 
 }// namespace refactor::runtime
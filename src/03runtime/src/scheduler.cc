@@ -0,0 +1,262 @@
+#include "runtime/scheduler.h"
+#include <map>
+#include <numeric>
+
+namespace refactor::runtime {
+
+    DagScheduler::DagScheduler(count_t threads)
+        : _successorsOffset{0},
+          _successors(),
+          _predecessorsCount(),
+          _counters(nullptr),
+          _queues(std::max<count_t>(threads, 1)),
+          _helpers(),
+          _plan(nullptr),
+          _resources(nullptr),
+          _timeline(nullptr),
+          _run(0),
+          _exception(nullptr),
+          _remaining(0),
+          _queued(0),
+          _sleeping(0),
+          _active(0),
+          _mutex(),
+          _start(),
+          _ready(),
+          _done(),
+          _generation(0),
+          _stop(false) {
+        _helpers.reserve(_queues.size() - 1);
+        for (auto i : range(1ul, _queues.size())) {
+            _helpers.emplace_back(&DagScheduler::loop, this, static_cast<count_t>(i));
+        }
+    }
+
+    DagScheduler::~DagScheduler() {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _start.notify_all();
+        for (auto &helper : _helpers) { helper.join(); }
+    }
+
+    auto DagScheduler::threads() const noexcept -> count_t {
+        return static_cast<count_t>(_queues.size());
+    }
+
+    auto DagScheduler::predecessors(count_t step) const noexcept -> count_t {
+        return _predecessorsCount[step];
+    }
+
+    void DagScheduler::build(ExecutionPlan const &plan, graph_topo::Graph<Node, Edge> const &graph) {
+        constexpr static auto NONE = std::numeric_limits<count_t>::max();
+
+        auto const &steps = plan.steps();
+        auto n = steps.size();
+
+        // 地址空间被切分成若干连续的单元，每个单元记录最后一个写入者和此后的读取者。
+        // 初始时整个地址空间是一个空单元。
+        struct Cell {
+            count_t writer = NONE;
+            std::vector<count_t> readers;
+        };
+        std::map<uintptr_t, Cell> cells{{0, {}}};
+        auto split = [&](uintptr_t addr) {
+            auto it = std::prev(cells.upper_bound(addr));
+            return it->first == addr ? it : cells.emplace_hint(std::next(it), addr, it->second);
+        };
+
+        std::vector<std::vector<count_t>> predecessors(n);
+        std::vector<count_t> mark(n, NONE);
+        auto depend = [&](count_t step, count_t pred) {
+            if (pred != NONE && pred != step && mark[pred] != step) {
+                mark[pred] = step;
+                predecessors[step].push_back(pred);
+            }
+        };
+        auto access = [&](count_t step, void const *ptr, size_t size, bool write) {
+            if (!size) { return; }
+            auto begin = reinterpret_cast<uintptr_t>(ptr);
+            auto first = split(begin),
+                 last = split(begin + size);
+            for (auto it = first; it != last; ++it) {
+                auto &[writer, readers] = it->second;
+                depend(step, writer);
+                if (write) {
+                    for (auto reader : readers) { depend(step, reader); }
+                    writer = step;
+                    readers.clear();
+                } else if (readers.empty() || readers.back() != step) {
+                    readers.push_back(step);
+                }
+            }
+        };
+        // 未分配的边不会被访问
+        auto sizeOf = [&](count_t i) -> size_t {
+            auto const &edge = graph.edges[i];
+            return !edge.blob && edge.stackOffset == SIZE_MAX ? 0 : edge.size;
+        };
+
+        count_t step = 0;
+        for (auto const [nodeIdx, i, o] : graph.topology) {
+            auto const &s = steps[step];
+            for (auto j : range0_(i.size())) {
+                access(step, s.inputs[j], sizeOf(i[j]), false);
+            }
+            for (auto j : range0_(o.size())) {
+                access(step, s.outputs[j], sizeOf(o[j]), true);
+            }
+            access(step, s.workspace, graph.nodes[nodeIdx].workspaceSize, true);
+            ++step;
+        }
+
+        _predecessorsCount.resize(n);
+        _successorsOffset.assign(n + 1, 0);
+        for (auto i : range0_(n)) {
+            _predecessorsCount[i] = static_cast<count_t>(predecessors[i].size());
+            for (auto pred : predecessors[i]) { ++_successorsOffset[pred + 1]; }
+        }
+        std::partial_sum(_successorsOffset.begin(), _successorsOffset.end(), _successorsOffset.begin());
+        _successors.resize(_successorsOffset.back());
+        auto cursor = std::vector<count_t>(_successorsOffset.begin(), _successorsOffset.end() - 1);
+        for (auto i : range0_(n)) {
+            for (auto pred : predecessors[i]) { _successors[cursor[pred]++] = static_cast<count_t>(i); }
+        }
+        _counters = std::make_unique<std::atomic<count_t>[]>(n);
+    }
+
+    void DagScheduler::run(ExecutionPlan const &plan, Resources &resources, Timeline *timeline, count_t run) {
+        auto n = plan.steps().size();
+        ASSERT(n == _predecessorsCount.size(), "Scheduler is not built for this plan");
+        if (!n) { return; }
+
+        _plan = &plan;
+        _resources = &resources;
+        _timeline = timeline;
+        _run = run;
+        _remaining.store(static_cast<count_t>(n));
+        for (auto i : range0_(n)) {
+            _counters[i].store(_predecessorsCount[i], std::memory_order_relaxed);
+        }
+        // 没有前驱的步骤轮流分给各个线程
+        count_t worker = 0;
+        for (auto i : range0_(n)) {
+            if (!_predecessorsCount[i]) {
+                _queues[worker].steps.push_back(static_cast<count_t>(i));
+                _queued.fetch_add(1);
+                worker = (worker + 1) % _queues.size();
+            }
+        }
+        {
+            std::lock_guard lock(_mutex);
+            _active.store(static_cast<count_t>(_helpers.size()));
+            ++_generation;
+        }
+        _start.notify_all();
+
+        work(0);
+
+        {
+            std::unique_lock lock(_mutex);
+            _done.wait(lock, [this] { return !_active.load(); });
+        }
+        _plan = nullptr;
+        _resources = nullptr;
+        _timeline = nullptr;
+        if (_exception) {
+            std::rethrow_exception(std::exchange(_exception, nullptr));
+        }
+    }
+
+    void DagScheduler::loop(count_t worker) {
+        size_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(_mutex);
+                _start.wait(lock, [&] { return _stop || _generation != generation; });
+                if (_stop) { return; }
+                generation = _generation;
+            }
+            work(worker);
+            if (_active.fetch_sub(1) == 1) {
+                std::lock_guard lock(_mutex);
+                _done.notify_one();
+            }
+        }
+    }
+
+    void DagScheduler::work(count_t worker) {
+        count_t step;
+        while (_remaining.load()) {
+            if (pop(worker, step)) {
+                execute(worker, step);
+                continue;
+            }
+            // `_sleeping` 与 `_queued` 的顺序一致性保证入队的线程一定能看到睡眠者，或睡眠者一定能看到新任务
+            std::unique_lock lock(_mutex);
+            _sleeping.fetch_add(1);
+            _ready.wait(lock, [this] { return _queued.load() || !_remaining.load(); });
+            _sleeping.fetch_sub(1);
+        }
+    }
+
+    bool DagScheduler::pop(count_t worker, count_t &step) {
+        auto n = _queues.size();
+        for (auto i : range0_(n)) {
+            auto &queue = _queues[(worker + i) % n];
+            std::lock_guard lock(queue.mutex);
+            if (queue.steps.empty()) { continue; }
+            // 取自己最新放入的任务，数据更可能还在缓存中；窃取时取最早放入的任务
+            if (i == 0) {
+                step = queue.steps.back();
+                queue.steps.pop_back();
+            } else {
+                step = queue.steps.front();
+                queue.steps.pop_front();
+            }
+            _queued.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void DagScheduler::push(count_t worker, count_t step) {
+        {
+            auto &queue = _queues[worker];
+            std::lock_guard lock(queue.mutex);
+            queue.steps.push_back(step);
+        }
+        _queued.fetch_add(1);
+        if (_sleeping.load()) {
+            std::lock_guard lock(_mutex);
+            _ready.notify_one();
+        }
+    }
+
+    void DagScheduler::execute(count_t worker, count_t step) {
+        auto const &[node, routine, workspace, inputs, outputs] = _plan->steps()[step];
+        try {
+            if (_timeline) {
+                auto t0 = Timeline::Clock::now();
+                (*routine)(*_resources, workspace, inputs, outputs);
+                _timeline->record(_run, node, t0, Timeline::Clock::now());
+            } else {
+                (*routine)(*_resources, workspace, inputs, outputs);
+            }
+        } catch (...) {
+            std::lock_guard lock(_mutex);
+            if (!_exception) { _exception = std::current_exception(); }
+        }
+        for (auto i : range(_successorsOffset[step], _successorsOffset[step + 1])) {
+            if (auto next = _successors[i]; _counters[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                push(worker, next);
+            }
+        }
+        if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard lock(_mutex);
+            _ready.notify_all();
+        }
+    }
+
+}// namespace refactor::runtime
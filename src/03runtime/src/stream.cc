@@ -1,8 +1,43 @@
 ﻿#include "runtime/stream.h"
+#include "runtime/scheduler.h"
 
 namespace refactor::runtime {
     void emptyRoutine(runtime::Resources &, void *, void const *const *, void *const *) {}
 
+    ExecutionPlan::ExecutionPlan(graph_topo::Graph<Node, Edge> const &graph, void *stack)
+        : _addresses(), _steps() {
+        size_t addressesCount = 0;
+        for (auto const [nodeIdx, i, o] : graph.topology) {
+            addressesCount += i.size() + o.size();
+        }
+        _addresses.resize(addressesCount);
+        _steps.reserve(graph.nodes.size());
+
+        auto address = [&](count_t i) -> void * {
+            if (auto const &edge = graph.edges[i]; edge.blob) {
+                return edge.blob->get();
+            } else {
+                return reinterpret_cast<uint8_t *>(stack) + edge.stackOffset;
+            }
+        };
+        // 地址数组一次分配完毕，之后不再扩容，各步骤可以直接持有指针
+        auto it = _addresses.data();
+        for (auto const [nodeIdx, i, o] : graph.topology) {
+            auto inputs = it,
+                 outputs = std::transform(i.begin(), i.end(), inputs, address);
+            it = std::transform(o.begin(), o.end(), outputs, address);
+
+            auto const &node = graph.nodes[nodeIdx];
+            _steps.push_back({
+                nodeIdx,
+                &node.routine,
+                reinterpret_cast<uint8_t *>(stack) + node.workspaceOffset,
+                const_cast<void const *const *>(inputs),
+                outputs,
+            });
+        }
+    }
+
     Stream::Stream(decltype(_resources) resources,
                    size_t stackSize,
                    graph_topo::GraphTopo topology,
@@ -16,18 +51,132 @@ namespace refactor::runtime {
               std::move(topology),
               std::move(nodes),
               std::move(edges),
-          } {}
+          },
+          _plan(std::nullopt),
+          _scheduler(nullptr),
+          _timeline(nullptr) {
+        bindStack();
+    }
+    Stream::Stream(Stream &&) noexcept = default;
+    Stream &Stream::operator=(Stream &&) noexcept = default;
+    Stream::~Stream() = default;
+
+    auto Stream::stackSlot(count_t i) const -> Arc<hardware::Device::Blob> {
+        auto const &edge = _graph.edges[i];
+        if (edge.stackOffset > _stack->size() || edge.size > _stack->size() - edge.stackOffset) {
+            return nullptr;
+        }
+        return _device->slice(_stack, edge.stackOffset, edge.size);
+    }
+    void Stream::bindStack() {
+        auto bind = [this](count_t i) {
+            if (auto &blob = _graph.edges[i].blob; !blob) { blob = stackSlot(i); }
+        };
+        for (auto i : _graph.topology.globalInputs()) { bind(i); }
+        for (auto i : _graph.topology.globalOutputs()) { bind(i); }
+    }
+    bool Stream::onStack(count_t i) const noexcept {
+        auto const &edge = _graph.edges[i];
+        return edge.blob && edge.blob->get() == _stack->get<uint8_t>() + edge.stackOffset;
+    }
+
+    auto Stream::plan() -> ExecutionPlan const & {
+        if (!_plan) {
+            _plan.emplace(_graph, _stack->get());
+            if (_scheduler) { _scheduler->build(*_plan, _graph); }
+        }
+        return *_plan;
+    }
+
+    auto Stream::fork() const -> Stream {
+        auto edges = _graph.edges;
+        auto const &topology = _graph.topology;
+        // 绑定在栈上的输入输出由新流重新绑定到它自己的栈上
+        std::vector<count_t> stacked;
+        for (auto i : topology.globalInputs()) {
+            if (onStack(i)) {
+                edges[i].blob = nullptr;
+                stacked.push_back(i);
+            }
+        }
+        for (auto i : topology.globalOutputs()) {
+            if (onStack(i)) { edges[i].blob = nullptr; }
+        }
+        for (auto i : topology.globalInputs()) {
+            if (auto &blob = edges[i].blob; blob) {
+                auto copy = _device->malloc(blob->size());
+                copy->copyFrom(*blob);
+                blob = std::move(copy);
+            }
+        }
+        for (auto i : topology.globalOutputs()) {
+            // 同时是全局输入的边已经复制过了
+            if (auto &blob = edges[i].blob; blob && i >= topology.globalInputsCount()) {
+                blob = _device->malloc(blob->size());
+            }
+        }
+        Stream ans(
+            _resources.fork(),
+            _stack->size(),
+            topology,
+            _graph.nodes,
+            std::move(edges),
+            _device);
+        for (auto i : stacked) {
+            ans._graph.edges[i].blob->copyFrom(*_graph.edges[i].blob);
+        }
+        ans.setParallelism(parallelism());
+        ans.setTimeline(_timeline);
+        return ans;
+    }
+
+    void Stream::setParallelism(count_t threads) {
+        if (threads <= 1) {
+            _scheduler = nullptr;
+            return;
+        }
+        ASSERT(_device->type() == hardware::Device::Type::Cpu, "Parallel scheduling is only supported on CPU");
+        if (_scheduler && _scheduler->threads() == threads) { return; }
+        _scheduler = std::make_unique<DagScheduler>(threads);
+        if (_plan) { _scheduler->build(*_plan, _graph); }
+    }
+    auto Stream::parallelism() const noexcept -> count_t {
+        return _scheduler ? _scheduler->threads() : 1;
+    }
+
+    void Stream::setTimeline(Arc<Timeline> timeline) {
+        _timeline = std::move(timeline);
+    }
+    auto Stream::timeline() const noexcept -> Arc<Timeline> const & {
+        return _timeline;
+    }
+    auto Stream::memoryReport() const -> MemoryReport {
+        return MemoryReport::build(_graph, _stack->size());
+    }
 
     auto Stream::setData(count_t i, size_t size) -> Arc<hardware::Device::Blob> {
+        _plan.reset();
         return _graph.edges[i].blob = _device->malloc(size);
     }
     void Stream::setData(count_t i, Arc<hardware::Device::Blob> blob) {
+        _plan.reset();
         _graph.edges[i].blob = std::move(blob);
     }
     void Stream::setData(count_t i, void const *data, size_t size) {
-        auto blob = _device->malloc(size);
+        // 只有绑定在本流栈上的输入可以原地写入，
+        // 其他数据块可能属于调用者，或由权重缓存在多个流之间共享
+        auto &edge = _graph.edges[i];
+        if (onStack(i) && size <= edge.blob->size()) {
+            edge.blob->copyFromHost(data, size);
+            return;
+        }
+        // 输入曾被重新绑定到别处时，放得下就切回栈上预留的位置，之后的调用不再分配
+        Arc<hardware::Device::Blob> blob;
+        if (i < _graph.topology.globalInputsCount() && size <= edge.size) { blob = stackSlot(i); }
+        if (!blob) { blob = _device->malloc(size); }
         blob->copyFromHost(data, size);
-        _graph.edges[i].blob = std::move(blob);
+        _plan.reset();
+        edge.blob = std::move(blob);
     }
     auto Stream::getData(count_t i) const -> Arc<hardware::Device::Blob> {
         return _graph.edges[i].blob;
@@ -38,61 +187,91 @@ namespace refactor::runtime {
         return true;
     }
 
-    template<class I, class O>
-    std::pair<void const **, void **> collectAddress(
-        void *stack,
-        std::vector<Edge> const &edges,
-        std::vector<void *> &buffer,
-        I i, O o) {
-        auto fn = [&](auto i) -> void * {
-            if (edges[i].blob) {
-                return edges[i].blob->get();
+    void Stream::run() {
+        auto const &plan = this->plan();
+        _device->setContext();
+        if (_timeline) {
+            using Clock = Timeline::Clock;
+            auto run = _timeline->beginRun();
+            auto begin = Clock::now();
+            if (_scheduler) {
+                _scheduler->run(plan, _resources, _timeline.get(), run);
+            } else {
+                for (auto const &[nodeIdx, routine, workspace, inputs, outputs] : plan) {
+                    auto t0 = Clock::now();
+                    (*routine)(_resources, workspace, inputs, outputs);
+                    _timeline->record(run, nodeIdx, t0, Clock::now());
+                }
             }
-            return reinterpret_cast<uint8_t *>(stack) + edges[i].stackOffset;
-        };
-        buffer.resize(i.size() + o.size());
-        auto inputs = buffer.data(),
-             outputs = std::transform(i.begin(), i.end(), inputs, fn);
-        /* alignnnnn*/ std::transform(o.begin(), o.end(), outputs, fn);
-        return {const_cast<void const **>(inputs), outputs};
+            _timeline->record(run, Timeline::RUN, begin, Clock::now());
+            return;
+        }
+        if (_scheduler) {
+            _scheduler->run(plan, _resources);
+            return;
+        }
+        for (auto const &[nodeIdx, routine, workspace, inputs, outputs] : plan) {
+            (*routine)(_resources, workspace, inputs, outputs);
+        }
     }
 
-    void Stream::run() {
-        std::vector<void *> buffer(16);
-        auto stack = _stack->get<uint8_t>();
-        for (auto const [nodeIdx, i, o] : _graph.topology) {
-            auto [inputs, outputs] = collectAddress(stack, _graph.edges, buffer, i, o);
-            auto const &[routine, workspaceOffset] = _graph.nodes[nodeIdx];
-            _device->setContext();
-            routine(_resources, stack + workspaceOffset, inputs, outputs);
-        }
-    }
-
-    auto Stream::bench(void (*sync)()) -> std::vector<std::chrono::nanoseconds> {
-        std::vector<void *> buffer(16);
-        std::vector<std::chrono::nanoseconds> ans(_graph.nodes.size());
-        auto stack = _stack->get<uint8_t>();
-        for (auto const [nodeIdx, i, o] : _graph.topology) {
-            auto [inputs, outputs] = collectAddress(stack, _graph.edges, buffer, i, o);
-            auto t0 = std::chrono::high_resolution_clock::now();
-            auto const &[routine, workspaceOffset] = _graph.nodes[nodeIdx];
-            _device->setContext();
-            routine(_resources, stack + workspaceOffset, inputs, outputs);
+    auto Stream::bench(void (*sync)(), count_t warmup, count_t iterations, bool counters) -> BenchResult {
+        using Clock = std::chrono::high_resolution_clock;
+
+        BenchResult ans{
+            std::vector<std::vector<Duration>>(_graph.nodes.size()),
+            {},
+            {},
+        };
+        for (auto &samples : ans.nodes) { samples.reserve(iterations); }
+        ans.total.reserve(iterations);
+
+        auto const &plan = this->plan();
+        _device->setContext();
+        for (count_t i = 0; i < warmup; ++i) {
+            for (auto const &[nodeIdx, routine, workspace, inputs, outputs] : plan) {
+                (*routine)(_resources, workspace, inputs, outputs);
+            }
             if (sync) { sync(); }
-            auto t1 = std::chrono::high_resolution_clock::now();
-            ans[nodeIdx] = t1 - t0;
+        }
+        std::optional<PerfCounters> perf;
+        if (counters) {
+            if (perf.emplace(); perf->available()) {
+                ans.counters.resize(_graph.nodes.size(), PerfCounts{});
+            } else {
+                perf.reset();
+            }
+        }
+        for (count_t i = 0; i < iterations; ++i) {
+            auto c0 = perf ? perf->read() : PerfCounts{};
+            auto t0 = Clock::now();
+            Duration total{};
+            for (auto const &[nodeIdx, routine, workspace, inputs, outputs] : plan) {
+                (*routine)(_resources, workspace, inputs, outputs);
+                if (sync) { sync(); }
+                auto t1 = Clock::now();
+                ans.nodes[nodeIdx].push_back(t1 - t0);
+                total += t1 - t0;
+                if (perf) {
+                    auto c1 = perf->read();
+                    ans.counters[nodeIdx] += c1 - c0;
+                    c0 = c1;
+                    // 读取计数器的系统调用不计入下一个节点的耗时
+                    t0 = Clock::now();
+                } else {
+                    t0 = t1;
+                }
+            }
+            ans.total.push_back(total);
         }
         return ans;
     }
 
     void Stream::trace(std::function<void(count_t, void const *const *, void const *const *)> record) {
-        std::vector<void *> buffer(16);
-        auto stack = _stack->get<uint8_t>();
-        for (auto const [nodeIdx, i, o] : _graph.topology) {
-            auto [inputs, outputs] = collectAddress(stack, _graph.edges, buffer, i, o);
-            auto const &[routine, workspaceOffset] = _graph.nodes[nodeIdx];
-            _device->setContext();
-            routine(_resources, stack + workspaceOffset, inputs, outputs);
+        auto const &plan = this->plan();
+        _device->setContext();
+        for (auto const &[nodeIdx, routine, workspace, inputs, outputs] : plan) {
+            (*routine)(_resources, workspace, inputs, outputs);
             record(nodeIdx, inputs, outputs);
         }
     }
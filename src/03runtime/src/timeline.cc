@@ -0,0 +1,98 @@
+﻿#include "runtime/timeline.h"
+#include "runtime/json.h"
+#include "runtime/stream.h"
+
+namespace refactor::runtime {
+
+    Timeline::Timeline()
+        : _origin(Clock::now()),
+          _runs(0),
+          _mutex(),
+          _buffers() {}
+
+    auto Timeline::buffer() -> Buffer & {
+        struct Entry {
+            Timeline const *owner;
+            std::weak_ptr<Buffer> alive;
+            Buffer *buffer;
+        };
+        // 缓存项的生命周期跟随缓冲区，所属的时间线销毁后即失效；
+        // 新的时间线可能复用旧的地址，因此匹配时也要检查缓存项仍然有效
+        thread_local std::vector<Entry> cache;
+        for (auto const &entry : cache) {
+            if (entry.owner == this && !entry.alive.expired()) { return *entry.buffer; }
+        }
+        std::erase_if(cache, [](auto const &entry) { return entry.alive.expired(); });
+        std::lock_guard lock(_mutex);
+        auto const &buffer = _buffers.emplace_back(std::make_shared<Buffer>());
+        buffer->thread = static_cast<count_t>(_buffers.size() - 1);
+        buffer->events.reserve(4096);
+        cache.push_back({this, buffer, buffer.get()});
+        return *buffer;
+    }
+
+    count_t Timeline::beginRun() noexcept {
+        return _runs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Timeline::record(count_t run, count_t node, Clock::time_point begin, Clock::time_point end) {
+        buffer().events.push_back({run, node, begin, end});
+    }
+
+    auto Timeline::events() const -> std::vector<std::vector<Event>> {
+        std::lock_guard lock(_mutex);
+        std::vector<std::vector<Event>> ans(_buffers.size());
+        for (auto const &buffer : _buffers) {
+            ans[buffer->thread] = buffer->events;
+        }
+        return ans;
+    }
+
+    void Timeline::clear() {
+        std::lock_guard lock(_mutex);
+        for (auto &buffer : _buffers) { buffer->events.clear(); }
+        _runs.store(0, std::memory_order_relaxed);
+    }
+
+    void Timeline::writeChromeTrace(std::ostream &os, graph_topo::Graph<Node, Edge> const &graph) const {
+        std::vector<std::pair<size_t, size_t>> bytes(graph.nodes.size());
+        for (auto const [nodeIdx, inputs, outputs] : graph.topology) {
+            auto sum = [&](auto const &edges) {
+                size_t ans = 0;
+                for (auto i : edges) { ans += graph.edges[i].size; }
+                return ans;
+            };
+            bytes[nodeIdx] = {sum(inputs), sum(outputs)};
+        }
+        auto us = [this](Clock::time_point t) {
+            return std::chrono::duration<double, std::micro>(t - _origin).count();
+        };
+
+        auto threads = events();
+        os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        auto first = true;
+        auto separator = [&] { return std::exchange(first, false) ? "\n" : ",\n"; };
+        for (auto thread : range0_(threads.size())) {
+            os << separator()
+               << fmt::format(R"({{"name": "thread_name", "ph": "M", "pid": 0, "tid": {}, "args": {{"name": "worker {}"}}}})",
+                              thread, thread);
+            for (auto const &[run, node, begin, end] : threads[thread]) {
+                os << separator();
+                if (node == RUN) {
+                    os << fmt::format(R"({{"name": "run {}", "cat": "run", "ph": "X", "pid": 0, "tid": {}, "ts": {:.3f}, "dur": {:.3f}}})",
+                                      run, thread, us(begin), us(end) - us(begin));
+                    continue;
+                }
+                auto const &node_ = graph.nodes[node];
+                auto [inputBytes, outputBytes] = bytes[node];
+                os << fmt::format(R"({{"name": {}, "cat": "node", "ph": "X", "pid": 0, "tid": {}, "ts": {:.3f}, "dur": {:.3f}, )"
+                                  R"("args": {{"run": {}, "node": {}, "kernel": {}, "input_bytes": {}, "output_bytes": {}}}}})",
+                                  jsonString(node_.name.empty() ? fmt::format("node {}", node) : node_.name),
+                                  thread, us(begin), us(end) - us(begin),
+                                  run, node, jsonString(node_.description), inputBytes, outputBytes);
+            }
+        }
+        os << "\n]}\n";
+    }
+
+}// namespace refactor::runtime
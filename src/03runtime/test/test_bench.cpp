@@ -0,0 +1,85 @@
+#include "hardware/device_manager.h"
+#include "runtime/stream.h"
+#include <gtest/gtest.h>
+#include <numeric>
+
+using namespace refactor;
+using namespace runtime;
+
+TEST(runtime, Percentiles) {
+    std::vector<Duration> samples(200);
+    for (auto i : range0_(samples.size())) {
+        samples[i] = Duration(samples.size() - i);
+    }
+    auto p = Percentiles::of(std::move(samples));
+    EXPECT_EQ(p.min, Duration(1));
+    EXPECT_EQ(p.median, Duration(100));
+    EXPECT_EQ(p.p99, Duration(198));
+    EXPECT_EQ(p.max, Duration(200));
+    EXPECT_EQ(p.mean, Duration(100));
+
+    EXPECT_EQ(Percentiles::of({}).max, Duration::zero());
+    EXPECT_EQ(Percentiles::of({Duration(7)}).p99, Duration(7));
+}
+
+TEST(runtime, StreamBench) {
+    constexpr static count_t NODES = 4, WARMUP = 3, ITERATIONS = 8;
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {}, {NODES}, {}, {}};
+    size_t calls = 0;
+    for (auto i : range0_(NODES)) {
+        builder.topology.insert({i, {{}, {i + 1}}});
+        builder.nodes.insert({i, Node([&](Resources &, void *, void const *const *, void *const *) { ++calls; })});
+        builder.edges.insert({i + 1, {nullptr, 0, 0, ""}});
+    }
+    auto [topology, nodes, edges] = builder.build();
+    Stream stream(
+        {},
+        0,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+
+    auto result = stream.bench(nullptr, WARMUP, ITERATIONS);
+    EXPECT_EQ(calls, NODES * (WARMUP + ITERATIONS));
+    ASSERT_EQ(result.nodes.size(), NODES);
+    ASSERT_EQ(result.total.size(), ITERATIONS);
+    for (auto i : range0_(ITERATIONS)) {
+        auto sum = std::accumulate(result.nodes.begin(), result.nodes.end(), Duration::zero(),
+                                   [i](auto acc, auto const &samples) { return acc + samples[i]; });
+        // 节点耗时首尾相接，合计恰好是端到端耗时
+        EXPECT_EQ(sum, result.total[i]);
+    }
+}
+
+TEST(runtime, StreamBenchCounters) {
+    constexpr static size_t LEN = 1 << 16;
+    std::vector<float> data(LEN, 1);
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {}, {1}, {}, {}};
+    builder.topology.insert({0, {{}, {1}}});
+    builder.nodes.insert({0, Node([&](Resources &, void *, void const *const *, void *const *) {
+                              for (auto &x : data) { x = x * 1.0001f + 1; }
+                          })});
+    builder.edges.insert({1, {nullptr, 0, 0, ""}});
+    auto [topology, nodes, edges] = builder.build();
+    Stream stream(
+        {},
+        0,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+
+    auto result = stream.bench(nullptr, 1, 4, true);
+    ASSERT_EQ(result.total.size(), 4);
+    if (!PerfCounters().available()) {
+        // 计数器不可用时照常计时，只是没有读数
+        EXPECT_TRUE(result.counters.empty());
+        GTEST_SKIP() << "perf_event is not available";
+    }
+    ASSERT_EQ(result.counters.size(), 1);
+    auto const &c = result.counters[0];
+    fmt::println("cycles {}, instructions {}, IPC {:.2f}, LLC miss rate {:.2f}%, branch miss rate {:.2f}%",
+                 c.cycles, c.instructions, c.ipc(), c.cacheMissRate() * 100, c.branchMissRate() * 100);
+    EXPECT_GE(c.instructions, 4 * LEN);
+}
@@ -0,0 +1,142 @@
+#include "hardware/device_manager.h"
+#include "runtime/stream.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace refactor;
+using namespace runtime;
+
+constexpr static size_t LEN = 4096, BYTES = LEN * sizeof(float);
+
+// x 是全局输入，w 是权重；DEPTH 个节点串联：e_{i+1} = f(e_i, w)
+static Stream buildChain(count_t depth, Routine routine) {
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {0}, {depth + 1}, {}, {}};
+    builder.edges.insert({0, {nullptr, SIZE_MAX, BYTES, "x"}});
+    builder.edges.insert({1, {nullptr, SIZE_MAX, BYTES, "w"}});
+    for (auto i : range0_(depth)) {
+        auto input = i ? i + 1 : 0;
+        builder.topology.insert({i, {{input, 1}, {i + 2}}});
+        builder.nodes.insert({i, Node(routine)});
+        builder.edges.insert({i + 2, {nullptr, i % 2 * BYTES, BYTES, fmt::format("e{}", i + 1)}});
+    }
+    builder.edges[depth + 1] = {nullptr, SIZE_MAX, BYTES, "y"};
+    auto [topology, nodes, edges] = builder.build();
+    return Stream(
+        {},
+        2 * BYTES,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+}
+
+static count_t edgeNamed(Stream const &stream, std::string_view name) {
+    auto const &edges = stream.graph().edges;
+    return static_cast<count_t>(std::find_if(edges.begin(), edges.end(), [&](auto const &e) { return e.name == name; }) - edges.begin());
+}
+
+static void axpy(Resources &, void *, void const *const *inputs, void *const *outputs) {
+    auto x = reinterpret_cast<float const *>(inputs[0]),
+         w = reinterpret_cast<float const *>(inputs[1]);
+    auto y = reinterpret_cast<float *>(outputs[0]);
+    for (auto i : range0_(LEN)) { y[i] = x[i] * w[i] + 1; }
+}
+
+struct SharedResource final : public Resource {
+    static size_t typeId() noexcept {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+    size_t resourceTypeId() const noexcept final { return typeId(); }
+    std::string_view description() const noexcept final { return "SharedResource"; }
+    bool shareable() const noexcept final { return true; }
+};
+
+struct PrivateResource final : public Resource {
+    static size_t typeId() noexcept {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+    size_t resourceTypeId() const noexcept final { return typeId(); }
+    std::string_view description() const noexcept final { return "PrivateResource"; }
+};
+
+TEST(runtime, ResourcesFork) {
+    Resources res;
+    auto shared = res.fetchOrStore(std::make_unique<SharedResource>());
+    ASSERT_TRUE(res.fetchOrStore(std::make_unique<PrivateResource>()));
+    auto forked = res.fork();
+    EXPECT_EQ(forked.fetch(SharedResource::typeId()), shared);
+    EXPECT_FALSE(forked.fetch(PrivateResource::typeId()));
+}
+
+TEST(runtime, StreamFork) {
+    constexpr static count_t DEPTH = 3;
+    auto stream = buildChain(DEPTH, axpy);
+    auto x = edgeNamed(stream, "x"),
+         w = edgeNamed(stream, "w"),
+         y = edgeNamed(stream, "y");
+    std::vector<float> data(LEN, 2);
+    stream.setData(x, data.data(), BYTES);
+    stream.setData(w, data.data(), BYTES);
+    stream.setData(y, BYTES);
+
+    auto fork = stream.fork();
+    // 权重共享，输入输出各自独立
+    EXPECT_EQ(fork.getData(w), stream.getData(w));
+    EXPECT_NE(fork.getData(x), stream.getData(x));
+    EXPECT_NE(fork.getData(y), stream.getData(y));
+    EXPECT_NE(fork.plan().steps()[0].workspace, stream.plan().steps()[0].workspace);
+
+    // 分叉时已绑定的输入被复制，之后再绑定互不影响
+    std::fill(data.begin(), data.end(), 1.f);
+    fork.setData(x, data.data(), BYTES);
+    fork.run();
+    stream.run();
+
+    std::vector<float> a(LEN), b(LEN);
+    ASSERT_TRUE(stream.copyData(y, a.data(), BYTES));
+    ASSERT_TRUE(fork.copyData(y, b.data(), BYTES));
+    // 2 -> 5 -> 11 -> 23; 1 -> 3 -> 7 -> 15
+    EXPECT_EQ(a, std::vector<float>(LEN, 23));
+    EXPECT_EQ(b, std::vector<float>(LEN, 15));
+}
+
+TEST(runtime, DISABLED_StreamForkThroughput) {
+    constexpr static count_t DEPTH = 16, RUNS = 64;
+    auto stream = buildChain(DEPTH, [](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        auto x = reinterpret_cast<float const *>(inputs[0]),
+             w = reinterpret_cast<float const *>(inputs[1]);
+        auto y = reinterpret_cast<float *>(outputs[0]);
+        for (auto i : range0_(LEN)) { y[i] = std::sin(x[i] * w[i]) + 1; }
+    });
+    std::vector<float> data(LEN, .5f);
+    stream.setData(edgeNamed(stream, "x"), data.data(), BYTES);
+    stream.setData(edgeNamed(stream, "w"), data.data(), BYTES);
+    stream.setData(edgeNamed(stream, "y"), BYTES);
+
+    using namespace std::chrono;
+    fmt::println("concurrent inference of {} nodes, hardware concurrency {}",
+                 DEPTH, std::thread::hardware_concurrency());
+    double base = 0;
+    for (auto threads : {1u, 2u, 4u, 8u}) {
+        std::vector<Stream> forks;
+        forks.reserve(threads);
+        for (count_t i = 0; i < threads; ++i) { forks.push_back(stream.fork()); }
+
+        auto t0 = high_resolution_clock::now();
+        std::vector<std::thread> workers;
+        for (auto &fork : forks) {
+            workers.emplace_back([&fork] {
+                for (count_t i = 0; i < RUNS; ++i) { fork.run(); }
+            });
+        }
+        for (auto &worker : workers) { worker.join(); }
+        auto t1 = high_resolution_clock::now();
+
+        auto throughput = threads * RUNS / duration_cast<duration<double>>(t1 - t0).count();
+        if (threads == 1) { base = throughput; }
+        fmt::println("  {} threads: {:.0f} runs/s, {:.2f}x", threads, throughput, throughput / base);
+    }
+}
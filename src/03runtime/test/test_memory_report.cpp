@@ -0,0 +1,82 @@
+#include "hardware/device_manager.h"
+#include "runtime/stream.h"
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace refactor;
+using namespace runtime;
+
+// x -> n0 -> a -> n1 -> b，n2 (a, b) -> c -> n3 -> y，n1 带工作空间
+static Stream buildStream(size_t cOffset) {
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {0}, {4}, {}, {}};
+    builder.topology.insert({0, {{0}, {1}}});
+    builder.topology.insert({1, {{1}, {2}}});
+    builder.topology.insert({2, {{1, 2}, {3}}});
+    builder.topology.insert({3, {{3}, {4}}});
+    for (auto i : range0_(4)) {
+        Node node(emptyRoutine);
+        node.name = fmt::format("n{}", i);
+        builder.nodes.insert({i, std::move(node)});
+    }
+    builder.nodes.at(1).workspaceOffset = 1024;
+    builder.nodes.at(1).workspaceSize = 512;
+    builder.edges.insert({0, {nullptr, SIZE_MAX, 1024, "x"}});
+    builder.edges.insert({1, {nullptr, 0, 1024, "a"}});
+    builder.edges.insert({2, {nullptr, 2048, 1024, "b"}});
+    builder.edges.insert({3, {nullptr, cOffset, 1024, "c"}});
+    builder.edges.insert({4, {nullptr, SIZE_MAX, 1024, "y"}});
+    auto [topology, nodes, edges] = builder.build();
+    return Stream({}, 4096, std::move(topology), std::move(nodes), std::move(edges),
+                  hardware::device::fetch(hardware::Device::Type::Cpu));
+}
+
+TEST(runtime, MemoryReport) {
+    auto report = buildStream(1024).memoryReport();
+    EXPECT_EQ(report.stack, 4096);
+    EXPECT_EQ(report.live, (std::vector<size_t>{1024, 2560, 3072, 1024}));
+    EXPECT_EQ(report.peak, 3072);
+    EXPECT_EQ(report.peakStep, 2);
+    EXPECT_DOUBLE_EQ(report.fragmentation, .25);
+
+    // 全局输入输出不在栈上，不出现在报告中
+    ASSERT_EQ(report.buffers.size(), 4);
+    auto find = [&](std::string_view name) {
+        return *std::find_if(report.buffers.begin(), report.buffers.end(),
+                             [&](auto const &b) { return b.name == name; });
+    };
+    auto a = find("a"), ws = find("n1 workspace"), c = find("c");
+    EXPECT_EQ(a.kind, MemoryBuffer::Kind::Edge);
+    EXPECT_EQ(a.first, 0);
+    EXPECT_EQ(a.last, 2);
+    EXPECT_EQ(ws.kind, MemoryBuffer::Kind::Workspace);
+    EXPECT_EQ(ws.offset, 1024);
+    EXPECT_EQ(ws.first, 1);
+    EXPECT_EQ(ws.last, 1);
+    EXPECT_EQ(c.first, 2);
+    EXPECT_EQ(c.last, 3);
+
+    auto peak = report.atPeak();
+    ASSERT_EQ(peak.size(), 3);
+    EXPECT_EQ(report.buffers[peak[0]].size, 1024);
+}
+
+TEST(runtime, MemoryReportAliases) {
+    // c 原地复用 a 的存储，重叠的字节只计一次
+    auto report = buildStream(0).memoryReport();
+    EXPECT_EQ(report.live, (std::vector<size_t>{1024, 2560, 2048, 1024}));
+    EXPECT_EQ(report.peak, 2560);
+    EXPECT_EQ(report.peakStep, 1);
+}
+
+TEST(runtime, MemoryReportExport) {
+    auto report = buildStream(1024).memoryReport();
+    std::stringstream json, html;
+    report.writeJson(json);
+    report.writeHtml(html);
+    EXPECT_NE(json.str().find(R"("peak": 3072, "peak_step": 2)"), std::string::npos);
+    EXPECT_NE(json.str().find(R"("live": [1024, 2560, 3072, 1024])"), std::string::npos);
+    EXPECT_NE(json.str().find(R"({"kind": "workspace", "index": 1, "name": "n1 workspace", "offset": 1024, "size": 512, "first": 1, "last": 1})"),
+              std::string::npos);
+    EXPECT_NE(html.str().find("<svg"), std::string::npos);
+    EXPECT_NE(html.str().find("<title>c [1024, 2048) steps 2..3</title>"), std::string::npos);
+}
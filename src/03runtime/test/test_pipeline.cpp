@@ -0,0 +1,148 @@
+#include "hardware/device_manager.h"
+#include "runtime/pipeline.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace refactor;
+using namespace runtime;
+
+constexpr static size_t LEN = 4096, BYTES = LEN * sizeof(float);
+
+// x 是全局输入，y 是全局输出；DEPTH 个节点串联：e_{i+1} = f(e_i)
+static Stream buildChain(count_t depth, Routine routine) {
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {0}, {depth}, {}, {}};
+    builder.edges.insert({0, {nullptr, SIZE_MAX, BYTES, "x"}});
+    for (auto i : range0_(depth)) {
+        builder.topology.insert({i, {{i}, {i + 1}}});
+        builder.nodes.insert({i, Node(routine)});
+        builder.edges.insert({i + 1, {nullptr, i % 2 * BYTES, BYTES, fmt::format("e{}", i + 1)}});
+    }
+    builder.edges[depth] = {nullptr, SIZE_MAX, BYTES, "y"};
+    auto [topology, nodes, edges] = builder.build();
+    Stream ans(
+        {},
+        2 * BYTES,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+    ans.setData(0, BYTES);
+    ans.setData(depth, BYTES);
+    return ans;
+}
+
+static void increase(Resources &, void *, void const *const *inputs, void *const *outputs) {
+    auto x = reinterpret_cast<float const *>(inputs[0]);
+    auto y = reinterpret_cast<float *>(outputs[0]);
+    for (auto i : range0_(LEN)) { y[i] = x[i] + 1; }
+}
+
+TEST(runtime, Pipeline) {
+    constexpr static count_t DEPTH = 3, RUNS = 8;
+    auto stream = buildChain(DEPTH, increase);
+    auto x = stream.graph().topology.globalInputs()[0],
+         y = stream.graph().topology.globalOutputs()[0];
+
+    Pipeline pipeline(stream, 2);
+    EXPECT_EQ(pipeline.depth(), 2);
+
+    std::vector<std::future<void>> futures;
+    std::vector<std::vector<float>> results(RUNS, std::vector<float>(LEN));
+    std::vector<float> data(LEN);
+    for (auto run : range0_(RUNS)) {
+        // 槽在推理结束后自动归还，连续提交超过深度时在这里等待
+        auto slot = pipeline.acquire();
+        std::fill(data.begin(), data.end(), static_cast<float>(run));
+        pipeline.stream(slot).setData(x, data.data(), BYTES);
+        futures.push_back(pipeline.submit(slot, [&, run](Stream &s) {
+            ASSERT_TRUE(s.copyData(y, results[run].data(), BYTES));
+        }));
+    }
+    for (auto run : range0_(RUNS)) {
+        futures[run].get();
+        EXPECT_EQ(results[run], std::vector<float>(LEN, static_cast<float>(run + DEPTH)));
+    }
+}
+
+TEST(runtime, PipelineDepthBound) {
+    auto stream = buildChain(1, increase);
+    Pipeline pipeline(stream, 2);
+    auto a = pipeline.acquire(),
+         b = pipeline.acquire();
+    EXPECT_NE(a, b);
+
+    // 所有槽都被占用时 acquire 阻塞，直到有槽被归还
+    auto c = std::async(std::launch::async, [&] { return pipeline.acquire(); });
+    EXPECT_EQ(c.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+    pipeline.submit(b).get();
+    EXPECT_EQ(c.get(), b);
+    pipeline.release(a);
+    pipeline.release(b);
+}
+
+TEST(runtime, PipelineException) {
+    auto stream = buildChain(1, [](Resources &, void *, void const *const *, void *const *) {
+        throw std::runtime_error("routine failed");
+    });
+    Pipeline pipeline(stream, 1);
+    auto slot = pipeline.acquire();
+    EXPECT_THROW(pipeline.submit(slot).get(), std::runtime_error);
+    // 失败的推理同样归还槽
+    EXPECT_EQ(pipeline.acquire(), slot);
+    pipeline.release(slot);
+}
+
+TEST(runtime, DISABLED_PipelineThroughput) {
+    constexpr static count_t DEPTH = 16, RUNS = 64;
+    auto routine = [](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        auto x = reinterpret_cast<float const *>(inputs[0]);
+        auto y = reinterpret_cast<float *>(outputs[0]);
+        for (auto i : range0_(LEN)) { y[i] = std::sin(x[i]) + 1; }
+    };
+    auto stream = buildChain(DEPTH, routine);
+    auto x = stream.graph().topology.globalInputs()[0],
+         y = stream.graph().topology.globalOutputs()[0];
+
+    // 宿主准备一批输入的开销与一次推理相当
+    std::vector<float> data(LEN), result(LEN);
+    auto prepare = [&](count_t run) {
+        for (auto i : range0_(LEN)) {
+            auto v = static_cast<float>(run + i);
+            for (count_t j = 0; j < DEPTH; ++j) { v = std::sin(v) + 1; }
+            data[i] = v;
+        }
+    };
+
+    using namespace std::chrono;
+    auto t0 = high_resolution_clock::now();
+    for (auto run : range0_(RUNS)) {
+        prepare(run);
+        stream.setData(x, data.data(), BYTES);
+        stream.run();
+        stream.copyData(y, result.data(), BYTES);
+    }
+    auto t1 = high_resolution_clock::now();
+    auto base = RUNS / duration_cast<duration<double>>(t1 - t0).count();
+    fmt::println("pipelined inference of {} nodes with host-side input preparation, hardware concurrency {}",
+                 DEPTH, std::thread::hardware_concurrency());
+    fmt::println("  synchronous: {:.0f} runs/s", base);
+
+    for (auto depth : {1u, 2u, 4u}) {
+        Pipeline pipeline(stream, depth);
+        std::deque<std::future<void>> inflight;
+        auto t0 = high_resolution_clock::now();
+        for (auto run : range0_(RUNS)) {
+            prepare(run);
+            auto slot = pipeline.acquire();
+            pipeline.stream(slot).setData(x, data.data(), BYTES);
+            inflight.push_back(pipeline.submit(slot, [&](Stream &s) {
+                s.copyData(y, result.data(), BYTES);
+            }));
+        }
+        for (auto &future : inflight) { future.get(); }
+        auto t1 = high_resolution_clock::now();
+
+        auto throughput = RUNS / duration_cast<duration<double>>(t1 - t0).count();
+        fmt::println("  depth {}: {:.0f} runs/s, {:.2f}x", depth, throughput, throughput / base);
+    }
+}
@@ -0,0 +1,190 @@
+#include "hardware/device_manager.h"
+#include "hardware/mem_offset_calculator.h"
+#include "runtime/scheduler.h"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+#include <thread>
+
+using namespace refactor;
+using namespace runtime;
+using Linked = graph_topo::LinkedGraph<Node, Edge>;
+
+constexpr static size_t LEN = 1024, BYTES = LEN * sizeof(float);
+
+static Routine elementwise(float (*f)(float, float), std::chrono::milliseconds delay = {}) {
+    return [=](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        std::this_thread::sleep_for(delay);
+        auto a = reinterpret_cast<float const *>(inputs[0]),
+             b = reinterpret_cast<float const *>(inputs[1]);
+        auto y = reinterpret_cast<float *>(outputs[0]);
+        for (auto i : range0_(LEN)) { y[i] = f(a[i], b[i]); }
+    };
+}
+
+// 按节点加入的顺序生成拓扑序，栈上的偏移量按这个顺序规划
+static Stream buildStream(Linked const &linked, size_t stackSize) {
+    auto [topology, nodes, edges] = linked.intoGraph();
+    return Stream(
+        {},
+        stackSize,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+}
+
+static Rc<Linked::Node> push(Linked &g, Routine routine, std::vector<Rc<Linked::Edge>> inputs, Edge output) {
+    auto node = g.pushNode(Node(std::move(routine)), {Linked::shareEdge(std::move(output))});
+    for (auto i : range0_(inputs.size())) { node->connect(i, std::move(inputs[i])); }
+    return node;
+}
+
+static std::vector<float> runWith(Stream &stream, count_t threads) {
+    auto const &graph = stream.graph();
+    stream.setParallelism(threads);
+    EXPECT_EQ(stream.parallelism(), std::max(threads, 1u));
+    std::vector<float> x(LEN);
+    std::iota(x.begin(), x.end(), 1.f);
+    stream.setData(graph.topology.globalInputs()[0], x.data(), BYTES);
+    std::vector<float> ans;
+    for (auto i : graph.topology.globalOutputs()) {
+        stream.setData(i, BYTES);
+    }
+    stream.run();
+    for (auto i : graph.topology.globalOutputs()) {
+        ans.resize(ans.size() + LEN);
+        stream.copyData(i, ans.data() + ans.size() - LEN, BYTES);
+    }
+    return ans;
+}
+
+TEST(runtime, SchedulerMemoryHazard) {
+    // x -> A -> a ┐
+    // x -> B -> b ┴ C -> c ┐
+    // x -> D -> d ─────────┴ E -> y
+    // d 复用 a 的空间，因此 D 虽然与 A、B、C 没有数据依赖，也必须在 C 之后执行
+    using namespace std::chrono_literals;
+    Linked g;
+    auto x = Linked::shareEdge({nullptr, SIZE_MAX, BYTES, "x"});
+    g.setInputs({x});
+    auto a = push(g, elementwise([](float x, float) { return x * 2 + 1; }, 20ms), {x, x}, {nullptr, 0, BYTES, "a"})->outputs()[0],
+         b = push(g, elementwise([](float x, float) { return x * 3 - 1; }, 20ms), {x, x}, {nullptr, BYTES, BYTES, "b"})->outputs()[0],
+         c = push(g, elementwise([](float a, float b) { return a * b; }), {a, b}, {nullptr, 2 * BYTES, BYTES, "c"})->outputs()[0],
+         d = push(g, elementwise([](float x, float) { return x + 5; }), {x, x}, {nullptr, 0, BYTES, "d"})->outputs()[0],
+         y = push(g, elementwise([](float c, float d) { return c - d; }), {c, d}, {nullptr, SIZE_MAX, BYTES, "y"})->outputs()[0];
+    g.setOutputs({y});
+    auto stream = buildStream(g, 3 * BYTES);
+    auto expect = runWith(stream, 1);
+    for (auto i : range0_(LEN)) {
+        auto x = static_cast<float>(i + 1);
+        ASSERT_EQ(expect[i], (x * 2 + 1) * (x * 3 - 1) - (x + 5));
+    }
+    auto ans = runWith(stream, 4);
+    EXPECT_EQ(std::memcmp(ans.data(), expect.data(), ans.size() * sizeof(float)), 0);
+
+    // A 没有前驱；D 复用 a 的空间，前驱是 A（写后写）和 C（读后写）；E 的前驱是 C 和 D
+    auto const &graph = stream.graph();
+    DagScheduler scheduler(2);
+    scheduler.build(stream.plan(), graph);
+    count_t step = 0;
+    for (auto const [nodeIdx, i, o] : graph.topology) {
+        auto const &name = graph.edges[o[0]].name;
+        if (name == "a") { EXPECT_EQ(scheduler.predecessors(step), 0); }
+        if (name == "d") { EXPECT_EQ(scheduler.predecessors(step), 2); }
+        if (name == "y") { EXPECT_EQ(scheduler.predecessors(step), 2); }
+        ++step;
+    }
+}
+
+TEST(runtime, SchedulerRandomDag) {
+    // 随机生成的图按引用计数复用栈空间，并行执行的结果必须与顺序执行逐位一致
+    constexpr static count_t NODES = 256;
+    static constexpr float (*FNS[])(float, float){
+        [](float a, float b) { return a + b; },
+        [](float a, float b) { return a * 0.5f - b; },
+        [](float a, float b) { return std::sqrt(a * a + b * b); },
+    };
+    std::mt19937 rng(2023);
+    std::vector<count_t> inputs(2 * NODES), refs(NODES + 1, 0);
+    for (auto i : range0_(NODES)) {
+        std::uniform_int_distribution<count_t> pick(i < 8 ? 0 : i - 7, i);
+        ++refs[inputs[2 * i] = pick(rng)];
+        ++refs[inputs[2 * i + 1] = pick(rng)];
+    }
+
+    hardware::OffsetCalculator calculator(sizeof(float));
+    Linked g;
+    std::vector<Rc<Linked::Edge>> edges{Linked::shareEdge({nullptr, SIZE_MAX, BYTES, "x"})}, outputs;
+    std::vector<size_t> offsets{SIZE_MAX};
+    g.setInputs({edges[0]});
+    for (auto i : range0_(NODES)) {
+        auto offset = refs[i + 1] ? calculator.alloc(BYTES) : SIZE_MAX;
+        auto node = push(g, elementwise(FNS[rng() % 3]),
+                         {edges[inputs[2 * i]], edges[inputs[2 * i + 1]]},
+                         {nullptr, offset, BYTES, ""});
+        edges.push_back(node->outputs()[0]);
+        offsets.push_back(offset);
+        if (offset == SIZE_MAX) { outputs.push_back(edges.back()); }
+        for (auto j : {inputs[2 * i], inputs[2 * i + 1]}) {
+            if (j && !--refs[j]) { calculator.free(offsets[j], BYTES); }
+        }
+    }
+    g.setOutputs(std::move(outputs));
+    auto stream = buildStream(g, calculator.peak());
+    auto expect = runWith(stream, 1);
+    for (auto threads : {2u, 3u, 8u}) {
+        for (auto times : range0_(4)) {
+            auto ans = runWith(stream, threads);
+            ASSERT_EQ(ans.size(), expect.size());
+            EXPECT_EQ(std::memcmp(ans.data(), expect.data(), ans.size() * sizeof(float)), 0)
+                << "threads = " << threads << ", times = " << times;
+        }
+    }
+}
+
+TEST(runtime, DISABLED_SchedulerScaling) {
+    // WIDTH 条互相独立的支路，每条支路串联 DEPTH 个计算密集的节点
+    constexpr static count_t WIDTH = 8, DEPTH = 16, TIMES = 8;
+    Linked g;
+    auto x = Linked::shareEdge({nullptr, SIZE_MAX, BYTES, "x"});
+    std::vector<Rc<Linked::Edge>> outputs;
+    g.setInputs({x});
+    auto heavy = [](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        auto x = reinterpret_cast<float const *>(inputs[0]);
+        auto y = reinterpret_cast<float *>(outputs[0]);
+        for (auto i : range0_(LEN)) {
+            auto v = x[i];
+            for (auto j = 0; j < 64; ++j) { v = std::sin(v) + 1; }
+            y[i] = v;
+        }
+    };
+    for (auto w : range0_(WIDTH)) {
+        auto last = x;
+        for (auto d : range0_(DEPTH)) {
+            // 每条支路在两块空间之间来回写
+            last = push(g, heavy, {last}, {nullptr, (w * 2 + d % 2) * BYTES, BYTES, ""})->outputs()[0];
+        }
+        outputs.push_back(last);
+    }
+    g.setOutputs(std::move(outputs));
+    auto stream = buildStream(g, WIDTH * 2 * BYTES);
+
+    using namespace std::chrono;
+    auto expect = runWith(stream, 1);
+    fmt::println("parallel scheduling of {} branches x {} nodes, hardware concurrency {}",
+                 WIDTH, DEPTH, std::thread::hardware_concurrency());
+    long base = 0;
+    for (auto threads : {1u, 2u, 4u, 8u}) {
+        auto ans = runWith(stream, threads);
+        EXPECT_EQ(std::memcmp(ans.data(), expect.data(), ans.size() * sizeof(float)), 0);
+        auto t0 = high_resolution_clock::now();
+        for (count_t i = 0; i < TIMES; ++i) { stream.run(); }
+        auto t1 = high_resolution_clock::now();
+        auto t = duration_cast<microseconds>(t1 - t0).count() / TIMES;
+        if (threads == 1) { base = t; }
+        fmt::println("  {} threads: {} us/run, speedup {:.2f}x", threads, t, static_cast<double>(base) / t);
+    }
+}
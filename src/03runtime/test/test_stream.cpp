@@ -0,0 +1,191 @@
+#include "hardware/device_manager.h"
+#include "runtime/stream.h"
+#include <atomic>
+#include <cstdlib>
+#include <gtest/gtest.h>
+
+using namespace refactor;
+using namespace runtime;
+
+// 统计整个测试程序的堆分配次数
+static std::atomic_size_t ALLOCATIONS(0);
+
+void *operator new(size_t size) {
+    ++ALLOCATIONS;
+    if (auto ptr = std::malloc(size ? size : 1); ptr) { return ptr; }
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+// 构造 n 个互相独立的节点，每个节点读取 2 个全局输入，写出 1 个输出
+static graph_topo::GraphTopo fanOut(count_t n) {
+    graph_topo::Builder<count_t, count_t, count_t, count_t> builder{{}, {0, 1}, {n + 1}, {}, {}};
+    for (auto i : range0_(n)) {
+        builder.topology.insert({i, {{0, 1}, {i + 2}}});
+        builder.nodes.insert({i, i});
+    }
+    return builder.build().topology;
+}
+
+static Stream buildStream(count_t n, Routine routine) {
+    constexpr static size_t BLOCK = 64;
+    auto topology = fanOut(n);
+    std::vector<Node> nodes(n, Node(std::move(routine)));
+    std::vector<Edge> edges(n + 2);
+    for (auto i : range0_(n + 2)) {
+        edges[i] = {nullptr, i * BLOCK, BLOCK, fmt::format("e{}", i)};
+    }
+    return Stream(
+        {},
+        (n + 2) * BLOCK,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+}
+
+TEST(runtime, ExecutionPlan) {
+    auto stream = buildStream(8, [](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        auto a = reinterpret_cast<size_t const *>(inputs[0]),
+             b = reinterpret_cast<size_t const *>(inputs[1]);
+        *reinterpret_cast<size_t *>(outputs[0]) = *a + *b;
+    });
+    size_t a = 3, b = 4, ans = 0;
+    stream.setData(0, &a, sizeof(a));
+    stream.setData(1, &b, sizeof(b));
+    stream.run();
+    for (auto i : range0_(8)) {
+        ASSERT_TRUE(stream.plan().steps()[i].inputs[0] == stream.getData(0)->get());
+    }
+    // 重新绑定输入后，计划应当失效并重建
+    auto device = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto blob = device->malloc(sizeof(b));
+    b = 10;
+    blob->copyFromHost(&b, sizeof(b));
+    ASSERT_NE(blob->get(), stream.getData(1)->get());
+    stream.setData(1, blob);
+    stream.run();
+    for (auto const &step : stream.plan()) {
+        EXPECT_EQ(step.inputs[1], blob->get());
+        EXPECT_EQ(*reinterpret_cast<size_t const *>(step.outputs[0]), 13);
+    }
+    stream.trace([&](count_t, void const *const *, void const *const *outputs) {
+        ans += *reinterpret_cast<size_t const *>(outputs[0]);
+    });
+    EXPECT_EQ(ans, 13 * 8);
+}
+
+TEST(runtime, DISABLED_ExecutionPlanDispatchOverhead) {
+    constexpr static count_t NODES = 4096, TIMES = 64;
+    auto stream = buildStream(NODES, emptyRoutine);
+    size_t zero = 0;
+    stream.setData(0, &zero, sizeof(zero));
+    stream.setData(1, &zero, sizeof(zero));
+    auto const &graph = stream.graph();
+    auto device = hardware::device::fetch(hardware::Device::Type::Cpu);
+
+    // 未预编译时每次运行都要逐节点收集地址
+    std::vector<uint8_t> stack((NODES + 2) * 64);
+    Resources res;
+    auto legacy = [&] {
+        std::vector<void *> buffer(16);
+        for (auto const [nodeIdx, i, o] : graph.topology) {
+            auto fn = [&](auto i) -> void * {
+                if (graph.edges[i].blob) { return graph.edges[i].blob->get(); }
+                return stack.data() + graph.edges[i].stackOffset;
+            };
+            buffer.resize(i.size() + o.size());
+            auto inputs = buffer.data(),
+                 outputs = std::transform(i.begin(), i.end(), inputs, fn);
+            std::transform(o.begin(), o.end(), outputs, fn);
+            auto const &node = graph.nodes[nodeIdx];
+            device->setContext();
+            node.routine(res, stack.data() + node.workspaceOffset, const_cast<void const **>(inputs), outputs);
+        }
+    };
+
+    using namespace std::chrono;
+    auto time = [](auto &&f) {
+        f();
+        auto t0 = high_resolution_clock::now();
+        for (count_t i = 0; i < TIMES; ++i) { f(); }
+        auto t1 = high_resolution_clock::now();
+        return duration_cast<nanoseconds>(t1 - t0).count() / TIMES;
+    };
+    auto tLegacy = time(legacy),
+         tPlan = time([&] { stream.run(); });
+    fmt::println("dispatch overhead of {} nodes: collect {} ns/run ({:.1f} ns/node), plan {} ns/run ({:.1f} ns/node)",
+                 NODES,
+                 tLegacy, static_cast<double>(tLegacy) / NODES,
+                 tPlan, static_cast<double>(tPlan) / NODES);
+}
+
+TEST(runtime, StreamIOBinding) {
+    constexpr static count_t NODES = 8, TIMES = 16;
+    auto stream = buildStream(NODES, [](Resources &, void *, void const *const *inputs, void *const *outputs) {
+        auto a = reinterpret_cast<size_t const *>(inputs[0]),
+             b = reinterpret_cast<size_t const *>(inputs[1]);
+        *reinterpret_cast<size_t *>(outputs[0]) = *a * *b;
+    });
+    // 栈上有固定位置的全局输入输出在构造时就绑定为栈的视图
+    auto const &graph = stream.graph();
+    for (auto i : graph.topology.globalInputs()) {
+        ASSERT_TRUE(stream.getData(i));
+        EXPECT_EQ(stream.plan().steps()[0].inputs[i], stream.getData(i)->get());
+    }
+    auto y = graph.topology.globalOutputs()[0];
+    ASSERT_TRUE(stream.getData(y));
+    auto slot = stream.getData(1)->get();
+
+    size_t a = 0, b = 0, ans = 0;
+    stream.setData(0, &a, sizeof(a));
+    stream.setData(1, &b, sizeof(b));
+    stream.run();
+
+    // 稳态下设置输入、运行和读取输出都不分配内存
+    auto allocations = ALLOCATIONS.load();
+    size_t sum = 0;
+    for (count_t i = 0; i < TIMES; ++i) {
+        a = i, b = i + 1;
+        stream.setData(0, &a, sizeof(a));
+        stream.setData(1, &b, sizeof(b));
+        stream.run();
+        stream.copyData(y, &ans, sizeof(ans));
+        sum += ans;
+    }
+    EXPECT_EQ(ALLOCATIONS.load(), allocations);
+    EXPECT_EQ(sum, (TIMES - 1) * TIMES * (TIMES + 1) / 3);
+
+    // 调用者也可以把自己的主机内存注册为输入，此后直接写入即可
+    auto device = hardware::device::fetch(hardware::Device::Type::Cpu);
+    size_t c = 6;
+    stream.setData(1, device->borrow(&c, sizeof(c)));
+    stream.run();
+    ASSERT_TRUE(stream.copyData(y, &ans, sizeof(ans)));
+    EXPECT_EQ(ans, a * c);
+    c = 7;
+    stream.run();
+    ASSERT_TRUE(stream.copyData(y, &ans, sizeof(ans)));
+    EXPECT_EQ(ans, a * c);
+
+    // 调用者注册的数据块不会被原地覆盖，数据写回栈上预留的位置
+    size_t d = 8;
+    stream.setData(1, &d, sizeof(d));
+    EXPECT_EQ(c, 7);
+    EXPECT_EQ(stream.getData(1)->get(), slot);
+    stream.run();
+    ASSERT_TRUE(stream.copyData(y, &ans, sizeof(ans)));
+    EXPECT_EQ(ans, a * d);
+
+    // 写回栈上之后，稳态运行再次不分配内存
+    allocations = ALLOCATIONS.load();
+    for (count_t i = 0; i < TIMES; ++i) {
+        d = i;
+        stream.setData(1, &d, sizeof(d));
+        stream.run();
+        stream.copyData(y, &ans, sizeof(ans));
+        EXPECT_EQ(ans, a * d);
+    }
+    EXPECT_EQ(ALLOCATIONS.load(), allocations);
+}
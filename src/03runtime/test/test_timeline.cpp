@@ -0,0 +1,149 @@
+#include "hardware/device_manager.h"
+#include "runtime/stream.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace refactor;
+using namespace runtime;
+
+constexpr static size_t LEN = 4096, BYTES = LEN * sizeof(float);
+
+// WIDTH 条互相独立的支路，每条支路串联 DEPTH 个节点，节点在两块空间之间来回写
+static Stream buildBranches(count_t width, count_t depth, Routine routine) {
+    using Linked = graph_topo::LinkedGraph<Node, Edge>;
+    Linked g;
+    auto x = Linked::shareEdge({nullptr, SIZE_MAX, BYTES, "x"});
+    std::vector<Rc<Linked::Edge>> outputs;
+    g.setInputs({x});
+    for (auto w : range0_(width)) {
+        auto last = x;
+        for (auto d : range0_(depth)) {
+            Node node(routine);
+            node.name = fmt::format("b{}n{}", w, d);
+            node.description = "test kernel";
+            auto output = Linked::shareEdge({nullptr, (w * 2 + d % 2) * BYTES, BYTES, ""});
+            auto n = g.pushNode(std::move(node), {std::move(output)});
+            n->connect(0, last);
+            last = n->outputs()[0];
+        }
+        outputs.push_back(last);
+    }
+    g.setOutputs(std::move(outputs));
+    auto [topology, nodes, edges] = g.intoGraph();
+    return Stream(
+        {},
+        width * 2 * BYTES,
+        std::move(topology),
+        std::move(nodes),
+        std::move(edges),
+        hardware::device::fetch(hardware::Device::Type::Cpu));
+}
+
+static void heavy(Resources &, void *, void const *const *inputs, void *const *outputs) {
+    auto x = reinterpret_cast<float const *>(inputs[0]);
+    auto y = reinterpret_cast<float *>(outputs[0]);
+    for (auto i : range0_(LEN)) { y[i] = std::sin(x[i]) + 1; }
+}
+
+TEST(runtime, Timeline) {
+    constexpr static count_t WIDTH = 4, DEPTH = 8, RUNS = 3;
+    // 例程内部再启动线程，事件仍由调用例程的线程记录
+    auto stream = buildBranches(WIDTH, DEPTH, [](Resources &res, void *ws, void const *const *inputs, void *const *outputs) {
+        std::thread([&] { heavy(res, ws, inputs, outputs); }).join();
+    });
+    std::vector<float> x(LEN, 1);
+    stream.setData(0, x.data(), BYTES);
+    auto timeline = std::make_shared<Timeline>();
+    stream.setTimeline(timeline);
+
+    for (auto threads : {1u, 4u}) {
+        timeline->clear();
+        stream.setParallelism(threads);
+        for (count_t i = 0; i < RUNS; ++i) { stream.run(); }
+
+        std::vector<count_t> counts(RUNS, 0), spans(RUNS, 0);
+        // 每次运行中每个节点恰好记录一次
+        std::vector<std::vector<count_t>> seen(RUNS, std::vector<count_t>(WIDTH * DEPTH, 0));
+        for (auto const &events : timeline->events()) {
+            for (auto i : range0_(events.size())) {
+                auto const &e = events[i];
+                ASSERT_LT(e.run, RUNS);
+                EXPECT_LE(e.begin, e.end);
+                if (e.node == Timeline::RUN) {
+                    ++spans[e.run];
+                } else {
+                    ASSERT_LT(e.node, WIDTH * DEPTH);
+                    ++counts[e.run];
+                    ++seen[e.run][e.node];
+                    // 同一线程上的节点事件不重叠
+                    if (i && events[i - 1].node != Timeline::RUN) { EXPECT_LE(events[i - 1].end, e.begin); }
+                }
+            }
+        }
+        EXPECT_EQ(counts, std::vector<count_t>(RUNS, WIDTH * DEPTH));
+        EXPECT_EQ(spans, std::vector<count_t>(RUNS, 1));
+        for (auto const &nodes : seen) { EXPECT_EQ(nodes, std::vector<count_t>(WIDTH * DEPTH, 1)); }
+    }
+
+    std::stringstream ss;
+    timeline->writeChromeTrace(ss, stream.graph());
+    auto json = ss.str();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"b3n7\""), std::string::npos);
+    EXPECT_NE(json.find("\"kernel\": \"test kernel\""), std::string::npos);
+    EXPECT_NE(json.find(fmt::format("\"output_bytes\": {}", BYTES)), std::string::npos);
+}
+
+TEST(runtime, TimelineThreadCache) {
+    // 先后创建的时间线可能复用同一地址，每个时间线仍只看到自己的事件
+    for (count_t i = 0; i < 8; ++i) {
+        Timeline timeline;
+        auto now = Timeline::Clock::now();
+        timeline.record(timeline.beginRun(), i, now, now);
+        auto threads = timeline.events();
+        ASSERT_EQ(threads.size(), 1);
+        ASSERT_EQ(threads[0].size(), 1);
+        EXPECT_EQ(threads[0][0].node, i);
+    }
+}
+
+TEST(runtime, DISABLED_TimelineOverhead) {
+    constexpr static count_t WIDTH = 8, DEPTH = 16, TIMES = 16, ROUNDS = 5, EVENTS = 1 << 16;
+    auto stream = buildBranches(WIDTH, DEPTH, heavy);
+    std::vector<float> x(LEN, 1);
+    stream.setData(0, x.data(), BYTES);
+
+    using namespace std::chrono;
+    using Clock = Timeline::Clock;
+    auto time = [&] {
+        stream.run();
+        auto t0 = high_resolution_clock::now();
+        for (count_t i = 0; i < TIMES; ++i) { stream.run(); }
+        auto t1 = high_resolution_clock::now();
+        return duration_cast<duration<double, std::micro>>(t1 - t0).count() / TIMES;
+    };
+    // 端到端的差值受其他负载干扰，可能比开销本身还大，只作参考；
+    // 开销按每个节点额外执行的两次取时和一次记录的耗时估计，交替测量并各取最小值
+    auto timeline = std::make_shared<Timeline>();
+    double off = INFINITY, on = INFINITY, record = INFINITY;
+    for (count_t i = 0; i < ROUNDS; ++i) {
+        stream.setTimeline(nullptr);
+        off = std::min(off, time());
+        timeline->clear();
+        stream.setTimeline(timeline);
+        on = std::min(on, time());
+
+        Timeline probe;
+        auto t0 = high_resolution_clock::now();
+        for (count_t j = 0; j < EVENTS; ++j) {
+            auto begin = Clock::now();
+            probe.record(0, j, begin, Clock::now());
+        }
+        auto t1 = high_resolution_clock::now();
+        record = std::min(record, duration_cast<duration<double, std::micro>>(t1 - t0).count() / EVENTS);
+    }
+    auto overhead = record * WIDTH * DEPTH / off;
+    fmt::println("timeline of {} nodes: off {:.1f} us/run, on {:.1f} us/run, {:.0f} ns/event, overhead {:.2f}%",
+                 WIDTH * DEPTH, off, on, record * 1e3, overhead * 100);
+}
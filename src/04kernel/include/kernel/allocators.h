@@ -11,12 +11,32 @@ namespace refactor::kernel {
         std::vector<Edge> const &,
         size_t);
 
+    /// @brief 按引用计数复用存储的分配器。
+    ///        节点声明原地执行时，输出直接复用在此节点最后一次使用的输入的偏移。
     AllocScheme reusableAllocate(
         graph_topo::GraphTopo const &,
         std::vector<runtime::Node>,
         std::vector<Edge> const &,
         size_t);
 
+    /// @brief 离线规划的分配器。
+    ///        先求出每条边和每个工作空间的完整存活区间，
+    ///        再按大小从大到小，在同时存活的缓冲区之间做最佳适配。
+    ///        原地执行的节点的输出与被复用的输入合并为一个缓冲区；
+    ///        声明了 `SubBuffers` 的拼接把输入的生产者放在输出中的对应区间，切分的输出直接指向输入中的区间。
+    AllocScheme plannedAllocate(
+        graph_topo::GraphTopo const &,
+        std::vector<runtime::Node>,
+        std::vector<Edge> const &,
+        size_t);
+
+    /// @brief 栈大小的理论下界：全局输入输出的大小加上各节点执行时同时存活的字节数的最大值。
+    size_t peakLowerBound(
+        graph_topo::GraphTopo const &,
+        std::vector<runtime::Node> const &,
+        std::vector<Edge> const &,
+        size_t);
+
 }// namespace refactor::kernel
 
 #endif// KERNEL_ALLOCATOR_H
@@ -16,6 +16,8 @@ namespace refactor::kernel {
         explicit Broadcaster(TensorRefs const &inputs);
         void locate(dim_t k, dim_t ans[]) const noexcept;
         bool needBroadcast() const noexcept;
+        /// @brief 第 `i` 个输入是否需要广播，不需要广播的输入与输出形状相同。
+        bool needBroadcast(dim_t i) const noexcept;
     };
 
 }// namespace refactor::kernel
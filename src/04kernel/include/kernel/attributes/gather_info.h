@@ -1,6 +1,7 @@
 ﻿#ifndef KERNEL_GATHER_INFO_H
 #define KERNEL_GATHER_INFO_H
 
+#include "../cost.h"
 #include "../tensor.h"
 
 namespace refactor::kernel {
@@ -16,6 +17,8 @@ namespace refactor::kernel {
         DataType idxType;
 
         GatherInfo(dim_t axis, Tensor const &data, Tensor const &indices) noexcept;
+        /// @brief 只读取被选中的数据，而不是整个输入。
+        KernelCost cost() const noexcept;
     };
 
 }// namespace refactor::kernel
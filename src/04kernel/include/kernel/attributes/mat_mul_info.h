@@ -3,6 +3,7 @@
 
 #include "kernel/attributes/broadcaster.h"
 #include "kernel/attributes/expand_info.h"
+#include "kernel/cost.h"
 
 namespace refactor::kernel {
 
@@ -19,6 +20,8 @@ namespace refactor::kernel {
         MatMulInfo(Tensor const &, Tensor const &,
                    std::optional<std::reference_wrapper<Tensor const>>,
                    bool, bool, float, float);
+        /// @brief 乘加各计一次运算，带偏置时再计缩放和加偏置。
+        KernelCost cost() const noexcept;
     };
 
 }// namespace refactor::kernel
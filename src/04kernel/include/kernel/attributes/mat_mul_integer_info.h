@@ -2,6 +2,7 @@
 #define KERNEL_MAT_MUL_INTEGER_INFO_H
 
 #include "kernel/attributes/broadcaster.h"
+#include "kernel/cost.h"
 
 namespace refactor::kernel {
 
@@ -21,6 +22,8 @@ namespace refactor::kernel {
 
         explicit MatMulIntegerInfo(TensorRefs const &inputs) noexcept;
         dim_t batch() const noexcept;
+        /// @brief 乘加各计一次运算，减零点另计。
+        KernelCost cost() const noexcept;
     };
 
 }// namespace refactor::kernel
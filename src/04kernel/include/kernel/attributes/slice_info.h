@@ -1,6 +1,7 @@
 ﻿#ifndef KERNEL_SLICE_INFO_H
 #define KERNEL_SLICE_INFO_H
 
+#include "../cost.h"
 #include "../tensor.h"
 
 namespace refactor::kernel {
@@ -30,6 +31,8 @@ namespace refactor::kernel {
         SliceInfo(Dimensions, Tensor const &);
         SliceInfo reform(dim_t maxblockSize) const noexcept;
         void reformAssign(dim_t maxblockSize) noexcept;
+        /// @brief 只读取被切出的数据，而不是整个输入。
+        KernelCost cost() const noexcept;
     };
 
 }// namespace refactor::kernel
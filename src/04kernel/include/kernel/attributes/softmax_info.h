@@ -1,6 +1,7 @@
 #ifndef KERNEL_SOFTMAX_INFO_H
 #define KERNEL_SOFTMAX_INFO_H
 
+#include "../cost.h"
 #include "../tensor.h"
 
 namespace refactor::kernel {
@@ -10,6 +11,8 @@ namespace refactor::kernel {
         DataType type;
 
         SoftmaxInfo(Tensor const &data, dim_t axis) noexcept;
+        /// @brief 每个元素计求最大值、减最大值、求指数、求和、相除共 5 次运算。
+        KernelCost cost() const noexcept;
     };
 
 }// namespace refactor::kernel
@@ -15,6 +15,9 @@ namespace refactor::kernel {
 
         SplitInfo(dim_t axis, TensorRefs const &outputs);
         dim_t unit(dim_t maxBlockSize) const noexcept;
+        /// @brief 只拷贝一次时每个片段都是整块数据中的一段连续区间，返回各片段的起始字节偏移；
+        ///        否则返回空。
+        std::vector<size_t> contiguousOffsets() const;
     };
 
 }// namespace refactor::kernel
@@ -9,8 +9,12 @@ namespace refactor::kernel {
     class Blob {
         /// @brief ! NOTICE 指针必须非空。
         void *_ptr;
+        /// @brief 文件映射的起点和长度，不是映射时为空。
+        void *_mapping;
+        size_t _mappingSize;
 
         explicit Blob(size_t);
+        Blob(void *, void *, size_t);
 
     public:
         Blob(Blob const &) = delete;
@@ -18,6 +22,11 @@ namespace refactor::kernel {
         ~Blob();
 
         static std::pair<Arc<Blob>, void *> share(size_t);
+        /// @brief 以只读方式映射 `file` 中从 `offset` 开始的 `size` 字节，页面在首次访问时载入。
+        /// @param prefetch 映射时即载入全部页面。
+        static Arc<Blob> map(std::string const &file, size_t offset, size_t size, bool prefetch = false);
+        /// @brief 内存块是否是文件的只读映射。
+        bool mapped() const noexcept;
         operator void const *() const noexcept;
         template<class T> T const *get() const noexcept {
             return reinterpret_cast<T const *>(_ptr);
@@ -17,6 +17,13 @@ namespace refactor::kernel {
         virtual ~InfoCollector() = default;
         virtual std::vector<KernelBox>
         filter(TensorRefs inputs, TensorRefs outputs) const = 0;
+        /// @brief `initializers[i]` 表示第 i 个输入是否为初始值，即带有数据且不是全图输入。
+        ///        全图输入在编译时带有的数据可能在运行前被替换，只有初始值可以在降级时预先变换。
+        ///        默认忽略这个信息。
+        virtual std::vector<KernelBox>
+        filter(TensorRefs inputs, TensorRefs outputs, std::vector<bool> const &initializers) const {
+            return filter(std::move(inputs), std::move(outputs));
+        }
     };
 
     using CollectorBox = std::unique_ptr<InfoCollector>;
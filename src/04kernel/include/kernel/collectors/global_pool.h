@@ -8,8 +8,9 @@ namespace refactor::kernel {
 
     struct GlobalPoolCollector final : public InfoCollector {
         PoolType type;
+        int64_t p;
 
-        GlobalPoolCollector(decltype(_target), PoolType) noexcept;
+        GlobalPoolCollector(decltype(_target), PoolType, int64_t) noexcept;
 
         std::vector<KernelBox>
         filter(TensorRefs inputs, TensorRefs outputs) const final;
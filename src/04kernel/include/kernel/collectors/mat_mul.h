@@ -14,6 +14,8 @@ namespace refactor::kernel {
 
         std::vector<KernelBox>
         filter(TensorRefs inputs, TensorRefs outputs) const final;
+        std::vector<KernelBox>
+        filter(TensorRefs inputs, TensorRefs outputs, std::vector<bool> const &initializers) const final;
     };
 
 }// namespace refactor::kernel
@@ -8,11 +8,12 @@ namespace refactor::kernel {
 
     struct PoolCollector final : public InfoCollector {
         PoolType type;
-        bool ceil;
+        bool ceil, countIncludePad;
+        int64_t p;
         KernelShape kernelShape;
         PoolAttributes attributes;
 
-        PoolCollector(decltype(_target), PoolType, bool, KernelShape, PoolAttributes) noexcept;
+        PoolCollector(decltype(_target), PoolType, bool, bool, int64_t, KernelShape, PoolAttributes) noexcept;
 
         std::vector<KernelBox>
         filter(TensorRefs inputs, TensorRefs outputs) const final;
@@ -0,0 +1,16 @@
+﻿#ifndef KERNEL_COST_H
+#define KERNEL_COST_H
+
+#include <cstddef>
+
+namespace refactor::kernel {
+
+    /// @brief 内核理论上的运算量和读写字节数，用于 roofline 分析。
+    ///        读写字节数为 0 表示与输入输出张量的大小相同，由 `Graph::lower` 填充。
+    struct KernelCost {
+        size_t flops, bytesRead, bytesWritten;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_COST_H
@@ -40,7 +40,12 @@ namespace refactor::kernel {
         Graph(graph_topo::GraphTopo,
               std::vector<_N>,
               std::vector<_E>) noexcept;
-        runtime::Stream lower(Arc<hardware::Device>, Allocator) const;
+        /// @brief 降级到 `device`，`model` 是权重缓存按模型统计时使用的名字。
+        runtime::Stream lower(Arc<hardware::Device>, Allocator, std::string_view model = {}) const;
+        /// @brief 只运行 `Allocator`，返回它规划出的内存报告，不取得权重也不创建流。
+        ///        降级例程时创建的资源（如预先打包的权重）保存在 `res` 中，
+        ///        在随后的 `lower` 结束前保持它存活，相同的变换可以从权重缓存中复用。
+        runtime::MemoryReport plan(Allocator, runtime::Resources &) const;
     };
 
 }// namespace refactor::kernel
@@ -1,6 +1,7 @@
 ﻿#ifndef KERNEL_KERNEL_H
 #define KERNEL_KERNEL_H
 
+#include "cost.h"
 #include "runtime/stream.h"
 #include <string_view>
 
@@ -14,6 +15,15 @@ namespace refactor::kernel {
         virtual ~Kernel() = default;
         virtual size_t kernelTypeId() const = 0;
         virtual std::string_view description() const = 0;
+        /// @brief 估计内核的运算量和读写字节数，默认全部为 0。
+        virtual KernelCost cost() const noexcept;
+        /// @brief 第 0 个输出可以原地复用其存储的输入序号，默认为空。
+        ///        只有逐元素读写、且输入与输出大小相同的内核可以声明，
+        ///        内存规划在输入于此节点最后一次使用时让输出复用它的偏移。
+        virtual std::vector<count_t> inplace() const noexcept;
+        /// @brief 输入或输出作为另一侧张量的连续区间的描述，默认不适用。
+        ///        声明的内核在区间已经就位时必须跳过对应的复制。
+        virtual runtime::SubBuffers subBuffers() const noexcept;
         virtual RoutineWorkspace lower(Resources &) const;
 
         template<class T, class... Args>
@@ -0,0 +1,105 @@
+﻿#ifndef KERNEL_WEIGHT_CACHE_H
+#define KERNEL_WEIGHT_CACHE_H
+
+#include "blob.hh"
+#include "hardware/device.h"
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+
+namespace refactor::kernel {
+
+    struct WeightCacheStats {
+        /// @brief 仍然存活的设备副本的字节数和数量。
+        size_t resident, entries;
+        /// @brief 没有流引用、由缓存保留在预算内的字节数，以及预算。
+        size_t pinned, budget;
+        size_t hits, misses, evictions;
+        /// @brief 内核降级时由权重变换出的主机副本（如预先打包的矩阵乘权重）仍然存活的字节数和数量。
+        size_t derived, derivedEntries;
+        /// @brief 每个模型仍然存活的权重副本的字节数，多个模型共享的副本分别计入。
+        std::map<std::string, size_t> models;
+    };
+
+    /// @brief 进程内共享的权重设备副本。
+    ///        同一份权重在同一个设备上只保存一个副本，由引用它的流持有；
+    ///        缓存只持有弱引用，最后一个流释放后副本随之释放。
+    ///        预算不为 0 时，缓存按最近使用的顺序额外持有不超过预算的副本，
+    ///        重新加载的模型可以直接复用它们，超出预算的最久未用的副本被淘汰。
+    class WeightCache {
+        struct Key {
+            hardware::Device const *device;
+            Blob const *data;
+
+            bool operator==(Key const &) const = default;
+        };
+        struct KeyHash {
+            size_t operator()(Key const &) const noexcept;
+        };
+        struct Entry {
+            /// @brief 检查权重的地址是否被新的权重复用。
+            std::weak_ptr<Blob> source;
+            std::weak_ptr<hardware::Device::Blob> blob;
+            size_t size;
+            /// @brief 在 `_pinned` 中的位置，未被缓存持有时为 `_pinned.end()`。
+            std::list<std::pair<Key, Arc<hardware::Device::Blob>>>::iterator pin;
+        };
+        struct DerivedKey {
+            Blob const *data;
+            std::string layout;
+
+            bool operator==(DerivedKey const &) const = default;
+        };
+        struct DerivedKeyHash {
+            size_t operator()(DerivedKey const &) const noexcept;
+        };
+        struct Derived {
+            std::weak_ptr<Blob> source, blob;
+            size_t size;
+        };
+        using Use = std::pair<std::weak_ptr<hardware::Device::Blob>, size_t>;
+
+        std::mutex _mutex;
+        std::unordered_map<Key, Entry, KeyHash> _entries;
+        std::unordered_map<DerivedKey, Derived, DerivedKeyHash> _derived;
+        /// @brief 缓存持有的副本，最近使用的在前。
+        std::list<std::pair<Key, Arc<hardware::Device::Blob>>> _pinned;
+        /// @brief 每个模型引用的副本，同一个模型重复取得同一份权重时只记录一次。
+        std::unordered_map<std::string, std::unordered_map<Key, Use, KeyHash>> _models;
+        size_t _pinnedBytes, _budget, _hits, _misses, _evictions, _sweepMark;
+
+        WeightCache();
+        void pin(Entry &, Key, Arc<hardware::Device::Blob>);
+        /// @brief 淘汰最久未用的副本直到不超过预算。
+        void shrink();
+        void sweep();
+
+    public:
+        static WeightCache &instance();
+
+        /// @brief 取得 `data` 在 `device` 上的副本，缺失时创建。
+        ///        CPU 上的文件映射直接借用，不复制。
+        /// @param model 用于按模型统计的名字，可以为空。
+        Arc<hardware::Device::Blob> fetch(
+            Arc<hardware::Device> const &device,
+            Arc<Blob> const &data,
+            size_t size,
+            std::string_view model = {});
+        /// @brief 取得 `data` 按 `layout` 变换出的主机副本，缺失时分配 `size` 字节并由 `fill` 填充。
+        ///        副本同样只由引用它的流持有，相同的权重以相同的方式变换时在进程内共享。
+        Arc<Blob> derive(
+            Arc<Blob> const &data,
+            std::string layout,
+            size_t size,
+            std::function<void(void *)> const &fill);
+        /// @brief 修改预算，立即淘汰超出预算的副本。
+        void setBudget(size_t);
+        /// @brief 释放缓存持有的全部副本，流引用的副本不受影响。
+        void clear();
+        WeightCacheStats stats();
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_WEIGHT_CACHE_H
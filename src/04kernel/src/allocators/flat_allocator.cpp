@@ -18,18 +18,20 @@ namespace refactor::kernel {
         }
         // initialize answer
         size_t size = 0;
-        auto globalOutputs_ = topology.globalOutputs();
-        std::unordered_set<size_t> globalOutputs(globalOutputs_.begin(), globalOutputs_.end());
         std::vector<runtime::Edge> edges_(edges.size(), {nullptr, SIZE_MAX});
+        // global inputs and outputs are placed at the bottom of the stack
+        auto bindIO = [&](size_t i) {
+            if (edges[i].data || edges_[i].stackOffset != SIZE_MAX) { return; }
+            edges_[i].stackOffset = size;
+            size += hardware::alignBytes(edges[i].size, alignBytes);
+        };
+        for (auto i : topology.globalInputs()) { bindIO(i); }
+        for (auto i : topology.globalOutputs()) { bindIO(i); }
         for (auto [nodeIdx, inputs, outputs] : topology) {
             for (auto i : outputs) {
-                if (!used[i]) { continue; }
-                if (globalOutputs.contains(i)) {
-                    edges_[i].stackOffset--;
-                } else {
-                    edges_[i].stackOffset = size;
-                    size += hardware::alignBytes(edges[i].size, alignBytes);
-                }
+                if (!used[i] || edges_[i].stackOffset != SIZE_MAX) { continue; }
+                edges_[i].stackOffset = size;
+                size += hardware::alignBytes(edges[i].size, alignBytes);
             }
             if (auto &node = nodes[nodeIdx]; node.workspaceOffset) {
                 size += hardware::alignBytes(std::exchange(node.workspaceOffset, size), alignBytes);
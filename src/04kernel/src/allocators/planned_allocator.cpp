@@ -0,0 +1,239 @@
+#include "hardware/functions.h"
+#include "kernel/allocators.h"
+#include <algorithm>
+#include <numeric>
+
+namespace refactor::kernel {
+
+    namespace {
+        /// @brief 一个需要在栈上放置的缓冲区，在第 `first` 到第 `last` 个节点之间（含两端）存活。
+        ///        `workspace` 为 true 时 `index` 是节点序号，否则是边序号。
+        struct Buffer {
+            count_t first, last, index;
+            bool workspace;
+            size_t size, offset;
+        };
+
+        struct Lifetimes {
+            /// @brief 全局输入输出占据栈底的固定槽位，大小为 `io`。
+            size_t io;
+            std::vector<runtime::Edge> edges;
+            std::vector<Buffer> buffers;
+            count_t steps;
+            /// @brief 原地执行、拼接和切分让多条边共享一个缓冲区，
+            ///        `owners` 记录每条边所在的缓冲区属于哪条边，`offsets` 记录它在其中的字节偏移。
+            std::vector<count_t> owners;
+            std::vector<size_t> offsets;
+        };
+    }// namespace
+
+    static Lifetimes lifetimes(
+        graph_topo::GraphTopo const &topology,
+        std::vector<runtime::Node> const &nodes,
+        std::vector<Edge> const &edges,
+        size_t alignBytes) {
+        constexpr static auto NONE = std::numeric_limits<count_t>::max();
+        using Side = runtime::SubBuffers::Side;
+
+        Lifetimes ans{
+            0,
+            std::vector<runtime::Edge>(edges.size(), {nullptr, SIZE_MAX}),
+            {},
+            0,
+            std::vector<count_t>(edges.size()),
+            std::vector<size_t>(edges.size(), 0),
+        };
+        auto &owners = ans.owners;
+        auto &offsets = ans.offsets;
+        std::iota(owners.begin(), owners.end(), 0);
+        // 与其他分配器一样，全局输入输出放在栈底，永不释放
+        auto bindIO = [&](size_t i) {
+            if (edges[i].data || ans.edges[i].stackOffset != SIZE_MAX) { return; }
+            ans.edges[i].stackOffset = ans.io;
+            ans.io += hardware::alignBytes(edges[i].size, alignBytes);
+        };
+        for (auto i : topology.globalInputs()) { bindIO(i); }
+        for (auto i : topology.globalOutputs()) { bindIO(i); }
+
+        // 边从生产者开始存活，到最后一个消费者为止；
+        // 与 `reusableAllocate` 一致，节点的输入、输出和工作空间在节点执行时同时存活
+        std::vector<count_t> first(edges.size(), NONE), last(edges.size(), NONE);
+        for (auto [nodeIdx, inputs, outputs] : topology) {
+            auto step = ans.steps++;
+            for (auto i : inputs) { last[i] = step; }
+            for (auto i : outputs) { first[i] = step; }
+            if (auto ws = nodes[nodeIdx].workspaceOffset; ws) {
+                ans.buffers.push_back({step, step, static_cast<count_t>(nodeIdx), true, hardware::alignBytes(ws, alignBytes), 0});
+            }
+        }
+
+        // 由节点产生、放在栈上参与规划的边
+        auto planned = [&](count_t i) {
+            return first[i] != NONE && !edges[i].data && ans.edges[i].stackOffset == SIZE_MAX;
+        };
+        // 共享缓冲区的边登记在所属的边下，整组移动时一起改写
+        std::vector<std::vector<count_t>> members(edges.size());
+        auto join = [&](count_t i, count_t owner, size_t offset) {
+            owners[i] = owner;
+            offsets[i] = offset;
+            members[owner].push_back(i);
+        };
+        {
+            count_t step = 0;
+            for (auto [nodeIdx, inputs, outputs] : topology) {
+                auto current = step++;
+                auto const &node = nodes[nodeIdx];
+                // 节点原地执行时，第 0 个输出并入在此节点最后一次使用的输入所在的区间
+                if (!outputs.empty() && ans.edges[outputs[0]].stackOffset == SIZE_MAX) {
+                    for (auto k : node.inplace) {
+                        auto i = inputs.at(k);
+                        if (planned(i) && last[i] == current && edges[i].size == edges[outputs[0]].size) {
+                            join(outputs[0], owners[i], offsets[i]);
+                            break;
+                        }
+                    }
+                }
+                auto const &sub = node.subBuffers;
+                if (sub.side == Side::Inputs) {
+                    // 拼接：在此节点最后一次使用的输入连同与它共享区间的边整组移入输出的对应位置，
+                    // 输入的生产者直接写入输出
+                    auto o = outputs[0];
+                    for (auto k : range0_(inputs.size())) {
+                        auto i = inputs[k];
+                        auto r = owners[i];
+                        if (!planned(i) || last[i] != current || r == o ||
+                            offsets[i] != 0 || edges[r].size != edges[i].size ||
+                            sub.offsets[k] % alignBytes) { continue; }
+                        auto moved = std::move(members[r]);
+                        moved.push_back(r);
+                        for (auto m : moved) { join(m, o, offsets[m] + sub.offsets[k]); }
+                    }
+                } else if (sub.side == Side::Outputs) {
+                    // 切分：输入在此节点之后不再使用时，各输出直接指向输入中的对应区间
+                    auto x = inputs[0];
+                    if (planned(x) && last[x] == current) {
+                        for (auto k : range0_(outputs.size())) {
+                            auto y = outputs[k];
+                            if (ans.edges[y].stackOffset != SIZE_MAX || sub.offsets[k] % alignBytes) { continue; }
+                            join(y, owners[x], offsets[x] + sub.offsets[k]);
+                        }
+                    }
+                }
+            }
+        }
+
+        // 共享的缓冲区从其中最早产生的边开始，存活到其中最后一条边的最后一个消费者为止
+        std::vector<count_t> begins(edges.size(), NONE), ends(edges.size(), 0);
+        for (auto i : range0_(edges.size())) {
+            if (first[i] == NONE) { continue; }
+            auto end = last[i] == NONE ? first[i] : std::max(first[i], last[i]);
+            begins[owners[i]] = std::min(begins[owners[i]], first[i]);
+            ends[owners[i]] = std::max(ends[owners[i]], end);
+        }
+        for (auto i : range0_(edges.size())) {
+            if (!planned(i) || owners[i] != i) { continue; }
+            ans.buffers.push_back({begins[i], ends[i], static_cast<count_t>(i), false, hardware::alignBytes(edges[i].size, alignBytes), 0});
+        }
+        return ans;
+    }
+
+    AllocScheme plannedAllocate(
+        graph_topo::GraphTopo const &topology,
+        std::vector<runtime::Node> nodes,
+        std::vector<Edge> const &edges,
+        size_t alignBytes) {
+        auto [io, edges_, buffers, steps, owners, offsets] = lifetimes(topology, nodes, edges, alignBytes);
+
+        // 按大小从大到小放置，大小相同时先放存活时间长的
+        std::vector<count_t> order(buffers.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](auto a, auto b) {
+            auto const &x = buffers[a], &y = buffers[b];
+            if (x.size != y.size) { return x.size > y.size; }
+            if (x.last - x.first != y.last - y.first) { return x.last - x.first > y.last - y.first; }
+            return x.first < y.first;
+        });
+
+        // 已放置的缓冲区按存活区间登记到固定长度的时间块中，
+        // 查询与某个区间重叠的缓冲区时只需要扫描它覆盖的时间块
+        constexpr static count_t CHUNK = 64;
+        std::vector<std::vector<count_t>> chunks(steps / CHUNK + 1);
+        std::vector<count_t> visited(buffers.size(), 0);
+        std::vector<count_t> overlapped;
+        count_t stamp = 0;
+
+        size_t stack = io;
+        for (auto i : order) {
+            auto &buffer = buffers[i];
+            if (!buffer.size) {
+                buffer.offset = io;
+                continue;
+            }
+            ++stamp;
+            overlapped.clear();
+            for (auto c : range(buffer.first / CHUNK, buffer.last / CHUNK + 1)) {
+                for (auto j : chunks[c]) {
+                    if (visited[j] == stamp) { continue; }
+                    visited[j] = stamp;
+                    if (auto const &other = buffers[j]; other.first <= buffer.last && buffer.first <= other.last) {
+                        overlapped.push_back(j);
+                    }
+                }
+            }
+            std::sort(overlapped.begin(), overlapped.end(), [&](auto a, auto b) {
+                return buffers[a].offset < buffers[b].offset;
+            });
+            // 在同时存活的缓冲区之间找能容纳它的最小空隙，找不到就放在它们之上
+            auto offset = SIZE_MAX, gap = SIZE_MAX;
+            auto top = io;
+            for (auto j : overlapped) {
+                auto const &other = buffers[j];
+                if (other.offset >= top && other.offset - top >= buffer.size && other.offset - top < gap) {
+                    offset = top;
+                    gap = other.offset - top;
+                }
+                top = std::max(top, other.offset + other.size);
+            }
+            buffer.offset = offset != SIZE_MAX ? offset : top;
+            stack = std::max(stack, buffer.offset + buffer.size);
+            for (auto c : range(buffer.first / CHUNK, buffer.last / CHUNK + 1)) {
+                chunks[c].push_back(i);
+            }
+        }
+
+        for (auto const &buffer : buffers) {
+            if (buffer.workspace) {
+                nodes[buffer.index].workspaceOffset = buffer.offset;
+            } else {
+                edges_[buffer.index].stackOffset = buffer.offset;
+            }
+        }
+        // 所属的边可能是全局输出，它的槽位在栈底
+        for (auto i : range0_(edges_.size())) {
+            if (owners[i] != i) { edges_[i].stackOffset = edges_[owners[i]].stackOffset + offsets[i]; }
+        }
+        return {
+            stack,
+            std::move(nodes),
+            std::move(edges_),
+        };
+    }
+
+    size_t peakLowerBound(
+        graph_topo::GraphTopo const &topology,
+        std::vector<runtime::Node> const &nodes,
+        std::vector<Edge> const &edges,
+        size_t alignBytes) {
+        auto [io, edges_, buffers, steps, owners, offsets] = lifetimes(topology, nodes, edges, alignBytes);
+        // 每一步同时存活的字节数之和的最大值
+        std::vector<ptrdiff_t> delta(steps + 1, 0);
+        for (auto const &buffer : buffers) {
+            delta[buffer.first] += buffer.size;
+            delta[buffer.last + 1] -= buffer.size;
+        }
+        ptrdiff_t live = 0, peak = 0;
+        for (auto d : delta) { peak = std::max(peak, live += d); }
+        return io + peak;
+    }
+
+}// namespace refactor::kernel
@@ -1,5 +1,6 @@
 #include "hardware/mem_offset_calculator.h"
 #include "kernel/allocators.h"
+#include <algorithm>
 
 namespace refactor::kernel {
 
@@ -18,14 +19,36 @@ namespace refactor::kernel {
         }
         // initialize answer
         hardware::OffsetCalculator calculator(alignBytes, true);
-        auto globalOutputs_ = topology.globalOutputs();
-        std::unordered_set<size_t> globalOutputs(globalOutputs_.begin(), globalOutputs_.end());
         std::vector<runtime::Edge> edges_(edges.size(), {nullptr, SIZE_MAX});
+        // global inputs and outputs hold stable slots that are never freed,
+        // so callers can bind them once and reuse them across runs
+        std::unordered_set<size_t> io;
+        auto bindIO = [&](size_t i) {
+            if (edges[i].data || !io.insert(i).second) { return; }
+            edges_[i].stackOffset = calculator.alloc(edges[i].size);
+        };
+        for (auto i : topology.globalInputs()) { bindIO(i); }
+        for (auto i : topology.globalOutputs()) { bindIO(i); }
         for (auto [nodeIdx, inputs, outputs] : topology) {
+            // the first output may take over an input's slot when the kernel works in-place
+            // and this node is the last one using that input
+            auto inplace = SIZE_MAX;
+            if (!outputs.empty() && !io.contains(outputs[0])) {
+                for (auto k : nodes[nodeIdx].inplace) {
+                    auto inputIdx = inputs.at(k);
+                    if (edges_[inputIdx].stackOffset != SIZE_MAX &&
+                        !io.contains(inputIdx) &&
+                        edges[inputIdx].size == edges[outputs[0]].size &&
+                        edgeRc[inputIdx] == static_cast<size_t>(std::count(inputs.begin(), inputs.end(), inputIdx))) {
+                        inplace = inputIdx;
+                        break;
+                    }
+                }
+            }
             for (auto outputIdx : outputs) {
-                if (globalOutputs.contains(outputIdx)) {
-                    edges_[outputIdx].stackOffset--;
-                } else {
+                if (inplace != SIZE_MAX && outputIdx == outputs[0]) {
+                    edges_[outputIdx].stackOffset = edges_[inplace].stackOffset;
+                } else if (!io.contains(outputIdx)) {
                     edges_[outputIdx].stackOffset = calculator.alloc(edges[outputIdx].size);
                 }
             }
@@ -40,9 +63,9 @@ namespace refactor::kernel {
             }
             for (auto inputIdx : inputs) {
                 ASSERT(edgeRc[inputIdx], "double free");
-                if (!--edgeRc[inputIdx]) {
+                if (!--edgeRc[inputIdx] && inputIdx != inplace) {
                     // indicate that this tensor will no longer be used and perform memory free
-                    if (edges_[inputIdx].stackOffset != SIZE_MAX) {
+                    if (edges_[inputIdx].stackOffset != SIZE_MAX && !io.contains(inputIdx)) {
                         calculator.free(edges_[inputIdx].stackOffset, edges[inputIdx].size);
                     }
                 }
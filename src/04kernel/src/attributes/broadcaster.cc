@@ -104,4 +104,12 @@ namespace refactor::kernel {
         return !strides.empty();
     }
 
+    bool Broadcaster::needBroadcast(dim_t i) const noexcept {
+        // 从未广播的输入在每一组维度上的步长都与输出相同
+        for (auto j = 0u; j < strides.size(); j += inputsCount + 1) {
+            if (strides[j + i] != strides[j + inputsCount]) { return true; }
+        }
+        return false;
+    }
+
 }// namespace refactor::kernel
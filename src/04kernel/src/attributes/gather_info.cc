@@ -26,4 +26,9 @@ namespace refactor::kernel {
         midSizeO = std::accumulate(indices.shape.begin(), indices.shape.end(), 1, std::multiplies());
     }
 
+    KernelCost GatherInfo::cost() const noexcept {
+        size_t output = static_cast<size_t>(prefix) * midSizeO * postfix;
+        return {0, output + midSizeO * idxType.size(), output};
+    }
+
 }// namespace refactor::kernel
@@ -41,4 +41,9 @@ namespace refactor::kernel {
         ASSERT(k == kB, "MatMul: input shape not matched.");
     }
 
+    KernelCost MatMulInfo::cost() const noexcept {
+        size_t outputs = static_cast<size_t>(broadcaster.outputsCount) * m * n;
+        return {outputs * k * 2 + (biasExpand ? outputs * 2 : 0), 0, 0};
+    }
+
 }// namespace refactor::kernel
@@ -39,4 +39,10 @@ namespace refactor::kernel {
         return broadcaster.outputsCount;
     }
 
+    KernelCost MatMulIntegerInfo::cost() const noexcept {
+        size_t batch_ = batch(),
+               zeroPoints = (a.withZeroPoint ? batch_ * m * k : 0) + (b.withZeroPoint ? batch_ * k * n : 0);
+        return {batch_ * m * n * k * 2 + zeroPoints, 0, 0};
+    }
+
 }// namespace refactor::kernel
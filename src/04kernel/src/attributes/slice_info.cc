@@ -92,4 +92,9 @@ namespace refactor::kernel {
         dims.back() = {1, 0, 1};
     }
 
+    KernelCost SliceInfo::cost() const noexcept {
+        size_t bytes = static_cast<size_t>(blockCount) * blockSize;
+        return {0, bytes, bytes};
+    }
+
 }// namespace refactor::kernel
@@ -12,4 +12,8 @@ namespace refactor::kernel {
         post = std::accumulate(axisIt, data.shape.end(), 1, std::multiplies());
     };
 
+    KernelCost SoftmaxInfo::cost() const noexcept {
+        return {static_cast<size_t>(pre) * mid * post * 5, 0, 0};
+    }
+
 }// namespace refactor::kernel
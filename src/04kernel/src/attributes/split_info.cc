@@ -27,4 +27,11 @@ namespace refactor::kernel {
         return std::gcd(or_, maxBlockSize);
     }
 
+    std::vector<size_t> SplitInfo::contiguousOffsets() const {
+        if (blockCount != 1) { return {}; }
+        std::vector<size_t> ans(segments.size());
+        std::exclusive_scan(segments.begin(), segments.end(), ans.begin(), size_t(0));
+        return ans;
+    }
+
 }// namespace refactor::kernel
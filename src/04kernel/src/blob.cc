@@ -1,10 +1,23 @@
 ﻿#include "kernel/blob.hh"
 #include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace refactor::kernel {
 
-    Blob::Blob(size_t bytes) : _ptr(std::malloc(bytes)) {}
-    Blob::~Blob() { std::free(std::exchange(_ptr, nullptr)); }
+    Blob::Blob(size_t bytes) : _ptr(std::malloc(bytes)), _mapping(nullptr), _mappingSize(0) {}
+    Blob::Blob(void *ptr, void *mapping, size_t mappingSize)
+        : _ptr(ptr), _mapping(mapping), _mappingSize(mappingSize) {}
+    Blob::~Blob() {
+        if (_mapping) {
+            munmap(std::exchange(_mapping, nullptr), _mappingSize);
+            _ptr = nullptr;
+        } else {
+            std::free(std::exchange(_ptr, nullptr));
+        }
+    }
 
     std::pair<Arc<Blob>, void *>
     Blob::share(size_t bytes) {
@@ -12,6 +25,26 @@ namespace refactor::kernel {
         auto ptr = blob->_ptr;
         return {std::move(blob), ptr};
     }
+    Arc<Blob> Blob::map(std::string const &file, size_t offset, size_t size, bool prefetch) {
+        auto fd = open(file.c_str(), O_RDONLY);
+        ASSERT(fd >= 0, "No such file: \"{}\"", file);
+        // 越过文件末尾的页面在访问时引发 SIGBUS，在这里提前报错
+        struct stat st;
+        if (fstat(fd, &st) || offset + size > static_cast<size_t>(st.st_size)) {
+            close(fd);
+            RUNTIME_ERROR(fmt::format("\"{}\" is shorter than {} bytes", file, offset + size));
+        }
+        // 映射的起点必须按页对齐
+        static auto const PAGE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto head = offset % PAGE,
+             length = std::max<size_t>(head + size, 1);
+        auto flags = MAP_PRIVATE | (prefetch ? MAP_POPULATE : 0);
+        auto mapping = mmap(nullptr, length, PROT_READ, flags, fd, offset - head);
+        close(fd);
+        ASSERT(mapping != MAP_FAILED, "Failed to map {} bytes at {} of \"{}\"", size, offset, file);
+        return Arc<Blob>(new Blob(static_cast<uint8_t *>(mapping) + head, mapping, length));
+    }
+    bool Blob::mapped() const noexcept { return _mapping; }
     Blob::operator void const *() const noexcept { return _ptr; }
 
 }// namespace refactor::kernel
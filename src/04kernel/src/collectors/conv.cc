@@ -1,5 +1,7 @@
 ﻿#include "kernel/collectors/conv.h"
+#include "../kernels/conv/cpu_kernel.hh"
 #include "../kernels/conv/cudnn_kernel.hh"
+#include "../kernels/conv/winograd_cpu_kernel.hh"
 
 namespace refactor::kernel {
 
@@ -9,14 +11,28 @@ namespace refactor::kernel {
 
     std::vector<KernelBox>
     ConvCollector::filter(TensorRefs inputs, TensorRefs outputs) const {
+        return filter(std::move(inputs), std::move(outputs), {});
+    }
+
+    std::vector<KernelBox>
+    ConvCollector::filter(TensorRefs inputs, TensorRefs outputs, std::vector<bool> const &initializers) const {
         auto const &x = inputs[0];
         auto const &w = inputs[1];
         auto b = inputs.size() == 3 ? std::make_optional(inputs[2]) : std::nullopt;
         auto const &y = outputs[0];
+        // 只有初始值可以预先变换，全图输入的数据在运行前可能被替换
+        auto constW = initializers.size() > 1 && initializers[1] ? w.get().data : nullptr;
 
         std::vector<KernelBox> ans;
         switch (_target) {
             case decltype(_target)::Cpu:
+                // 适合 Winograd 的形状优先使用它，其余使用通用的实现
+                if (auto ptr = ConvWinogradCpu::build(poolAttrs, x, w, b, y, constW); ptr) {
+                    ans.emplace_back(std::move(ptr));
+                }
+                if (auto ptr = ConvCpu::build(poolAttrs, x, w, b, y, constW); ptr) {
+                    ans.emplace_back(std::move(ptr));
+                }
                 break;
             case decltype(_target)::Nvidia:
                 if (auto ptr = ConvCudnn::build(poolAttrs, x, w, b, y); ptr) {
@@ -1,11 +1,12 @@
 ﻿#include "kernel/collectors/global_pool.h"
 #include "../kernels/pool/cudnn_kernel.hh"
+#include "../kernels/pool/global_cpu_kernel.hh"
 
 namespace refactor::kernel {
 
     GlobalPoolCollector::GlobalPoolCollector(
-        decltype(_target) target, PoolType type_) noexcept
-        : InfoCollector(target), type(type_) {}
+        decltype(_target) target, PoolType type_, int64_t p_) noexcept
+        : InfoCollector(target), type(type_), p(p_) {}
 
     std::vector<KernelBox>
     GlobalPoolCollector::filter(TensorRefs inputs, TensorRefs outputs) const {
@@ -22,9 +23,12 @@ namespace refactor::kernel {
         std::vector<KernelBox> ans;
         switch (_target) {
             case decltype(_target)::Cpu:
+                if (auto ptr = GlobalPoolCpu::build(type, p, x, y); ptr) {
+                    ans.emplace_back(std::move(ptr));
+                }
                 break;
             case decltype(_target)::Nvidia:
-                if (auto ptr = PoolCudnn::build(type, false, kernelShape, attributes, x, y); ptr) {
+                if (auto ptr = PoolCudnn::build(type, false, false, kernelShape, attributes, x, y); ptr) {
                     ans.emplace_back(std::move(ptr));
                 }
                 break;
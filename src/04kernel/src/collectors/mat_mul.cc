@@ -11,6 +11,11 @@ namespace refactor::kernel {
 
     std::vector<KernelBox>
     MatMulCollector::filter(TensorRefs inputs, TensorRefs outputs) const {
+        return filter(std::move(inputs), std::move(outputs), {});
+    }
+
+    std::vector<KernelBox>
+    MatMulCollector::filter(TensorRefs inputs, TensorRefs outputs, std::vector<bool> const &initializers) const {
         auto const &a = inputs[0];
         auto const &b = inputs[1];
 
@@ -21,7 +26,10 @@ namespace refactor::kernel {
         std::vector<KernelBox> ans;
         switch (_target) {
             case decltype(_target)::Cpu:
-                REGISTER(MatMulCPU)
+                // 只有初始值可以预先打包，全图输入的数据在运行前可能被替换
+                if (auto ptr = MatMulCPU::build(info, initializers.size() > 1 && initializers[1] ? b.get().data : nullptr); ptr) {
+                    ans.emplace_back(std::move(ptr));
+                }
                 break;
             case decltype(_target)::Nvidia:
                 REGISTER(MatMulCublas)
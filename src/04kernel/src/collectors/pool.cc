@@ -1,4 +1,5 @@
 ﻿#include "kernel/collectors/pool.h"
+#include "../kernels/pool/cpu_kernel.hh"
 #include "../kernels/pool/cudnn_kernel.hh"
 
 namespace refactor::kernel {
@@ -7,11 +8,15 @@ namespace refactor::kernel {
         decltype(_target) target,
         PoolType type_,
         bool ceil_,
+        bool countIncludePad_,
+        int64_t p_,
         KernelShape kernelShape_,
         PoolAttributes attrs) noexcept
         : InfoCollector(target),
           type(type_),
           ceil(ceil_),
+          countIncludePad(countIncludePad_),
+          p(p_),
           kernelShape(std::move(kernelShape_)),
           attributes(std::move(attrs)) {}
 
@@ -23,9 +28,12 @@ namespace refactor::kernel {
         std::vector<KernelBox> ans;
         switch (_target) {
             case decltype(_target)::Cpu:
+                if (auto ptr = PoolCpu::build(type, ceil, countIncludePad, p, kernelShape, attributes, x, y); ptr) {
+                    ans.emplace_back(std::move(ptr));
+                }
                 break;
             case decltype(_target)::Nvidia:
-                if (auto ptr = PoolCudnn::build(type, ceil, kernelShape, attributes, x, y); ptr) {
+                if (auto ptr = PoolCudnn::build(type, ceil, countIncludePad, kernelShape, attributes, x, y); ptr) {
                     ans.emplace_back(std::move(ptr));
                 }
                 break;
@@ -3,6 +3,7 @@
 #include "nvrtc_repo.h"
 #include "hardware/device_manager.h"
 #include <filesystem>
+#include <mutex>
 #include <nvrtc.h>
 
 #define NVRTC_ASSERT(CALL)                                                 \
@@ -102,6 +103,8 @@ namespace refactor::kernel::nvrtc {
         std::string_view code,
         std::string_view symbol) {
         static std::unordered_map<std::string, Arc<Handler>> REPO;
+        static std::mutex MUTEX;
+        std::lock_guard lock(MUTEX);
         auto it = REPO.find(name.data());
         if (it == REPO.end()) {
             std::tie(it, std::ignore) = REPO.emplace(name, Arc<Handler>(new Handler(name, code, symbol)));
@@ -1,21 +1,5 @@
 ﻿#include "kernel/graph.h"
-
-namespace refactor {
-    struct DataKey {
-        Arc<hardware::Device> dev;
-        Arc<kernel::Blob> blob;
-        bool operator==(const DataKey &) const = default;// since C++20
-    };
-}// namespace refactor
-
-template<>
-struct std::hash<refactor::DataKey> {
-    std::size_t operator()(refactor::DataKey const &s) const noexcept {
-        auto hd = std::hash<decltype(s.dev)>()(s.dev),
-             hb = std::hash<decltype(s.blob)>()(s.blob);
-        return hd ^ (hb << 1);
-    }
-};
+#include "kernel/weight_cache.h"
 
 namespace refactor::kernel {
 
@@ -28,19 +12,40 @@ namespace refactor::kernel {
               std::move(edges),
           }) {}
 
-    runtime::Stream Graph::lower(Arc<hardware::Device> device, Allocator allocator) const {
-        device->setContext();
-        runtime::Resources res;
-
+    static std::vector<runtime::Node> lowerNodes(Graph::_G const &graph, runtime::Resources &res) {
         std::vector<runtime::Node> nodes;
-        nodes.reserve(_internal.nodes.size());
-        for (auto i : range0_(_internal.nodes.size())) {
-            if (auto const &node = _internal.nodes[i]; node.kernel) {
-                nodes.emplace_back(node.kernel->lower(res));
-            } else {
+        nodes.reserve(graph.nodes.size());
+        for (auto [i, inputs, outputs] : graph.topology) {
+            auto const &node = graph.nodes[i];
+            if (!node.kernel) {
                 nodes.emplace_back(runtime::emptyRoutine);
+                nodes.back().name = node.name;
+                continue;
+            }
+            auto [flops, bytesRead, bytesWritten] = node.kernel->cost();
+            // 内核未给出访存量时按输入输出张量的大小估计
+            if (!bytesRead) {
+                for (auto j : inputs) { bytesRead += graph.edges[j].size; }
+            }
+            if (!bytesWritten) {
+                for (auto j : outputs) { bytesWritten += graph.edges[j].size; }
             }
+            auto &ans = nodes.emplace_back(node.kernel->lower(res));
+            ans.name = node.name;
+            ans.description = node.kernel->description();
+            ans.flops = flops;
+            ans.bytesRead = bytesRead;
+            ans.bytesWritten = bytesWritten;
+            ans.inplace = node.kernel->inplace();
+            ans.subBuffers = node.kernel->subBuffers();
         }
+        return nodes;
+    }
+
+    runtime::Stream Graph::lower(Arc<hardware::Device> device, Allocator allocator, std::string_view model) const {
+        device->setContext();
+        runtime::Resources res;
+        auto nodes = lowerNodes(_internal, res);
 
         auto [stack, nodes_, edges_] = allocator(
             _internal.topology,
@@ -48,21 +53,14 @@ namespace refactor::kernel {
             _internal.edges,
             32);
 
-        static std::unordered_map<DataKey, Arc<hardware::Device::Blob>> CACHE;
-
+        // 权重的设备副本在进程内共享，同一个模型在多个线程上编译时只复制一次
+        auto &cache = WeightCache::instance();
         for (auto i : range0_(edges_.size())) {
             auto const &edge = _internal.edges[i];
             edges_[i].name = edge.name;
+            edges_[i].size = edge.size;
             if (edge.data) {
-                auto it = CACHE.find({device, edge.data});
-                if (it == CACHE.end()) {
-                    auto blob = device->malloc(edge.size);
-                    blob->copyFromHost(edge.data->get<void>());
-                    std::tie(it, std::ignore) = CACHE.emplace(DataKey{device, edge.data}, std::move(blob));
-                }
-                edges_[i].blob = it->second;
-            } else if (edges_[i].stackOffset == SIZE_MAX - 1) {
-                edges_[i].blob = device->malloc(edge.size);
+                edges_[i].blob = cache.fetch(device, edge.data, edge.size, model);
             }
         }
 
@@ -75,4 +73,17 @@ namespace refactor::kernel {
             std::move(device));
     }
 
+    runtime::MemoryReport Graph::plan(Allocator allocator, runtime::Resources &res) const {
+        auto [stack, nodes, edges] = allocator(
+            _internal.topology,
+            lowerNodes(_internal, res),
+            _internal.edges,
+            32);
+        for (auto i : range0_(edges.size())) {
+            edges[i].name = _internal.edges[i].name;
+            edges[i].size = _internal.edges[i].size;
+        }
+        return runtime::MemoryReport::build({_internal.topology, std::move(nodes), std::move(edges)}, stack);
+    }
+
 }// namespace refactor::kernel
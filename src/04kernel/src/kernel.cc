@@ -2,6 +2,18 @@
 
 namespace refactor::kernel {
 
+    KernelCost Kernel::cost() const noexcept {
+        return {0, 0, 0};
+    }
+
+    std::vector<count_t> Kernel::inplace() const noexcept {
+        return {};
+    }
+
+    runtime::SubBuffers Kernel::subBuffers() const noexcept {
+        return {};
+    }
+
     RoutineWorkspace Kernel::lower(Resources &) const {
         RUNTIME_ERROR(fmt::format("lower not implemented for {}", description()));
     }
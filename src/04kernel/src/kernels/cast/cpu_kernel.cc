@@ -23,6 +23,10 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing cast operation on generic cpu";
     }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        if (from.size() == to.size()) { return {0}; }
+        return {};
+    }
 
     template<class T, class U>
     static auto lowerTyped(size_t size) noexcept -> RoutineWorkspace {
@@ -17,6 +17,7 @@ namespace refactor::kernel {
 
         size_t kernelTypeId() const noexcept final;
         std::string_view description() const noexcept final;
+        std::vector<count_t> inplace() const noexcept final;
         RoutineWorkspace lower(Resources &) const noexcept final;
     };
 
@@ -25,6 +25,10 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing clip operation on generic cpu";
     }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        // 只有数据可以被覆盖，最小值和最大值是标量
+        return {0};
+    }
 
     template<class T>
     static auto lowerTyped(size_t size, bool hasMax) noexcept -> RoutineWorkspace {
@@ -31,6 +31,12 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing split operation using CUDA";
     }
+    auto K::subBuffers() const noexcept -> runtime::SubBuffers {
+        if (auto offsets = info.contiguousOffsets(); !offsets.empty()) {
+            return {runtime::SubBuffers::Side::Inputs, std::move(offsets)};
+        }
+        return {};
+    }
 
 #ifdef USE_CUDA
 
@@ -65,7 +71,9 @@ extern "C" __global__ void kernel(
                 auto dst = reinterpret_cast<uint8_t *>(outputs[0]);
                 for (auto i : range0_(info.segments.size())) {
                     auto size = info.segments[i];
-                    cudaMemcpyAsync(dst, inputs[i], size, cudaMemcpyDeviceToDevice);
+                    if (inputs[i] != dst) {
+                        cudaMemcpyAsync(dst, inputs[i], size, cudaMemcpyDeviceToDevice);
+                    }
                     dst += size;
                 }
             };
@@ -16,6 +16,7 @@ namespace refactor::kernel {
 
         size_t kernelTypeId() const noexcept final;
         std::string_view description() const noexcept final;
+        runtime::SubBuffers subBuffers() const noexcept final;
 #ifdef USE_CUDA
         RoutineWorkspace lower(Resources &) const final;
 #endif
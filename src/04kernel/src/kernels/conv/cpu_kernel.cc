@@ -0,0 +1,394 @@
+#include "cpu_kernel.hh"
+#include "../mat_mul_common/cpu_gemm.hh"
+#include "../mat_mul_common/packed_weights.hh"
+#include "kernel/weight_cache.h"
+#include <execution>
+
+namespace refactor::kernel {
+    using K = ConvCpu;
+    using DT = DataType;
+    using Info = decltype(K::info);
+
+    K::ConvCpu(decltype(info) info_, decltype(constW) constW_) noexcept
+        : Kernel(), info(std::move(info_)), constW(std::move(constW_)) {}
+
+    auto K::build(PoolAttributes const &poolAttributes,
+                  Tensor const &x,
+                  Tensor const &w,
+                  std::optional<std::reference_wrapper<Tensor const>> b,
+                  Tensor const &y,
+                  decltype(constW) constW) -> KernelBox {
+        auto dt = x.dataType;
+        if ((dt != DT::F32 && dt != DT::F64) || w.dataType != dt || y.dataType != dt) {
+            return nullptr;
+        }
+        if (b && b->get().dataType != dt) {
+            return nullptr;
+        }
+        auto rank = poolAttributes.rank();
+        if ((rank != 1 && rank != 2) || x.rank() != static_cast<int64_t>(rank + 2) || w.rank() != static_cast<int64_t>(rank + 2)) {
+            return nullptr;
+        }
+        // 布局变换后 X 是 [N,H,W,C]，W 是 [Co,KH,KW,Cg]，Y 是 [N,Ho,Wo,Co]
+        auto nhwc = x.layout == LayoutType::NHWC;
+        if (nhwc && (rank != 2 || w.layout != LayoutType::NHWC)) {
+            return nullptr;
+        }
+
+        // 1D 卷积按 H 为 1 的 2D 卷积计算
+        auto first = nhwc ? 1 : 2;
+        auto height = [=](Tensor const &t) { return rank == 2 ? t.shape[first] : 1; };
+        auto width = [=](Tensor const &t) { return t.shape[first + rank - 1]; };
+        auto channel = [=](Tensor const &t) { return t.shape[nhwc ? 3 : 1]; };
+
+        Info info{dt, Algo::Im2col, nhwc, b.has_value()};
+        info.n = x.shape[0];
+        info.c = channel(x);
+        info.h = height(x);
+        info.w = width(x);
+        info.co = w.shape[0];
+        info.kh = height(w);
+        info.kw = width(w);
+        info.ho = height(y);
+        info.wo = width(y);
+        auto cg = channel(w);
+        if (!cg || info.c % cg || info.co % (info.c / cg) || channel(y) != info.co) {
+            return nullptr;
+        }
+        info.groups = info.c / cg;
+
+        auto d = poolAttributes.dilations(),
+             p = poolAttributes.padsBegin(),
+             s = poolAttributes.strides();
+        auto r = rank - 1;
+        info.dilation[0] = r ? d[0] : 1;
+        info.dilation[1] = d[r];
+        info.padBegin[0] = r ? p[0] : 0;
+        info.padBegin[1] = p[r];
+        info.stride[0] = r ? s[0] : 1;
+        info.stride[1] = s[r];
+
+        if (info.kh == 1 && info.kw == 1 &&
+            info.stride[0] == 1 && info.stride[1] == 1 &&
+            info.padBegin[0] == 0 && info.padBegin[1] == 0 &&
+            info.ho == info.h && info.wo == info.w &&
+            info.groups == 1) {
+            info.algo = Algo::Pointwise;
+        } else if (cg == 1 && info.groups > 1) {
+            info.algo = Algo::Depthwise;
+        }
+        return std::make_unique<K>(info, std::move(constW));
+    }
+
+    auto K::typeId() noexcept -> size_t {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+
+    auto K::kernelTypeId() const noexcept -> size_t { return typeId(); }
+    auto K::description() const noexcept -> std::string_view {
+        switch (info.algo) {
+            case Algo::Pointwise:
+                return "Performing 1x1 conv using CPU with packed gemm";
+            case Algo::Depthwise:
+                return "Performing depthwise conv using CPU";
+            default:
+                return "Performing conv using CPU with im2col and packed gemm";
+        }
+    }
+    auto K::cost() const noexcept -> KernelCost {
+        auto outputs = static_cast<size_t>(info.n) * info.co * info.ho * info.wo;
+        // 每个输出元素对一个卷积窗口做乘加
+        auto window = static_cast<size_t>(info.c / info.groups) * info.kh * info.kw;
+        return {outputs * window * 2 + (info.bias ? outputs : 0), 0, 0};
+    }
+
+    // 卷积核第 k 个位置在输出宽度上与输入相交的区间 [begin, end)
+    static std::pair<sdim_t, sdim_t> validRange(Info const &info, dim_t k) {
+        sdim_t off = k * info.dilation[1] - info.padBegin[1],
+               s = info.stride[1],
+               w = info.w;
+        auto begin = off >= 0 ? 0 : (s - 1 - off) / s,
+             end = w - 1 - off >= 0 ? (w - 1 - off) / s + 1 : 0;
+        begin = std::min<sdim_t>(begin, info.wo);
+        return {begin, std::clamp<sdim_t>(end, begin, info.wo)};
+    }
+
+    // 把偏置写到每个输出位置，矩阵乘在其上累加
+    template<class T>
+    static void fillBias(Info const &info, T *y, T const *b) {
+        auto howo = static_cast<size_t>(info.ho) * info.wo, co = static_cast<size_t>(info.co);
+        if (info.nhwc) {
+            std::for_each_n(std::execution::par_unseq,
+                            natural_t(0), info.n * howo,
+                            [=](auto i) { std::copy_n(b, co, y + i * co); });
+        } else {
+            std::for_each_n(std::execution::par_unseq,
+                            natural_t(0), info.n * co,
+                            [=](auto i) { std::fill_n(y + i * howo, howo, b[i % co]); });
+        }
+    }
+
+    template<class T>
+    static auto lowerPointwise(Info const &info, Arc<Blob> const &constW, Resources &res) -> RoutineWorkspace {
+        auto hw = static_cast<size_t>(info.h) * info.w;
+        auto beta = info.bias ? T{1} : T{};
+        if (info.nhwc) {
+            // Y[NHW,Co] = X[NHW,C] @ W[Co,C]^T，所有图像合成一个矩阵乘
+            CpuGemm<T> const gemm(info.n * hw, info.c, info.co, false, true, 1, beta);
+            auto packed = constW && info.c ? packConstB(res, gemm, constW, 1) : nullptr;
+            return [info, gemm, packed](Resources &, void *, void const *const *inputs, void *const *outputs) {
+                auto y = reinterpret_cast<T *>(outputs[0]);
+                if (info.bias) { fillBias(info, y, reinterpret_cast<T const *>(inputs[2])); }
+                gemm(reinterpret_cast<T const *>(inputs[0]),
+                     packed ? packed : reinterpret_cast<T const *>(inputs[1]),
+                     y, 1, nullptr, packed != nullptr);
+            };
+        }
+        // Y[n][Co,HW] = W[Co,C] @ X[n][C,HW]，所有图像共用 W
+        CpuGemm<T> const gemm(info.co, info.c, hw, false, false, 1, beta);
+        std::vector<dim_t> offsets(info.n * 2);
+        for (auto i : range0_(info.n)) { offsets[2 * i + 1] = i; }
+        return [info, gemm, offsets = std::move(offsets)](Resources &, void *, void const *const *inputs, void *const *outputs) {
+            auto y = reinterpret_cast<T *>(outputs[0]);
+            if (info.bias) { fillBias(info, y, reinterpret_cast<T const *>(inputs[2])); }
+            gemm(reinterpret_cast<T const *>(inputs[1]),
+                 reinterpret_cast<T const *>(inputs[0]),
+                 y, info.n, offsets.data());
+        };
+    }
+
+    template<class T>
+    static auto lowerDepthwise(Info const &info, Arc<Blob> const &constW, Resources &res) -> RoutineWorkspace {
+        auto const kk = info.kh * info.kw,
+                   multiplier = info.co / info.c;
+
+        if (!info.nhwc) {
+            // 每个输出平面独立，逐行累加各个卷积核位置，行内的循环可以向量化
+            return [info, kk, multiplier](Resources &, void *, void const *const *inputs, void *const *outputs) {
+                auto x = reinterpret_cast<T const *>(inputs[0]),
+                     w = reinterpret_cast<T const *>(inputs[1]),
+                     b = info.bias ? reinterpret_cast<T const *>(inputs[2]) : nullptr;
+                auto y = reinterpret_cast<T *>(outputs[0]);
+                auto const sw = info.stride[1];
+                std::for_each_n(std::execution::par_unseq,
+                                natural_t(0), info.n * info.co,
+                                [=, &info](auto i) {
+                                    auto oc = i % info.co, ic = i / info.co * info.c + oc / multiplier;
+                                    auto x_ = x + ic * info.h * info.w;
+                                    auto w_ = w + oc * kk;
+                                    auto y_ = y + i * info.ho * info.wo;
+                                    for (auto oh : range0_(info.ho)) {
+                                        auto yr = y_ + oh * info.wo;
+                                        std::fill_n(yr, info.wo, b ? b[oc] : T{});
+                                        for (auto kh : range0_(info.kh)) {
+                                            sdim_t ih = oh * info.stride[0] + kh * info.dilation[0] - info.padBegin[0];
+                                            if (ih < 0 || ih >= static_cast<sdim_t>(info.h)) { continue; }
+                                            for (auto kw : range0_(info.kw)) {
+                                                auto [begin, end] = validRange(info, kw);
+                                                auto wv = w_[kh * info.kw + kw];
+                                                auto xr = x_ + ih * info.w + static_cast<sdim_t>(kw * info.dilation[1] - info.padBegin[1]);
+                                                if (sw == 1) {
+                                                    for (auto ow = begin; ow < end; ++ow) { yr[ow] += wv * xr[ow]; }
+                                                } else {
+                                                    for (auto ow = begin; ow < end; ++ow) { yr[ow] += wv * xr[ow * sw]; }
+                                                }
+                                            }
+                                        }
+                                    }
+                                });
+            };
+        }
+
+        // NHWC 下沿通道向量化，W 转置成 [KH,KW,Co] 使每个卷积核位置的权重连续。
+        // W 是常量时降级时转置一次，否则每次运行转置到工作空间
+        auto transpose = [=, co = info.co](T const *src, T *dst) {
+            for (auto oc : range0_(co)) {
+                for (auto k : range0_(kk)) { dst[k * co + oc] = src[oc * kk + k]; }
+            }
+        };
+        T const *transposed = nullptr;
+        size_t workspace = 0;
+        if (constW) {
+            auto size = static_cast<size_t>(kk) * info.co * sizeof(T);
+            auto layout = fmt::format("depthwise w {} {}x{}x{} hwc", info.dt.name(), info.co, info.kh, info.kw);
+            auto blob = WeightCache::instance().derive(constW, std::move(layout), size, [&](void *dst) {
+                transpose(constW->get<T>(), static_cast<T *>(dst));
+            });
+            transposed = res.fetchOrStore<PackedWeights>()->hold<T>(std::move(blob), size);
+        } else {
+            workspace = static_cast<size_t>(kk) * info.co * sizeof(T);
+        }
+        auto routine = [info, kk, multiplier, transpose, transposed](Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
+            auto x = reinterpret_cast<T const *>(inputs[0]),
+                 b = info.bias ? reinterpret_cast<T const *>(inputs[2]) : nullptr;
+            auto y = reinterpret_cast<T *>(outputs[0]);
+            auto w = transposed;
+            if (!w) {
+                transpose(reinterpret_cast<T const *>(inputs[1]), reinterpret_cast<T *>(workspace));
+                w = reinterpret_cast<T const *>(workspace);
+            }
+            auto const co = info.co, c = info.c;
+            std::for_each_n(std::execution::par_unseq,
+                            natural_t(0), info.n * info.ho,
+                            [=, &info](auto i) {
+                                auto image = i / info.ho, oh = i % info.ho;
+                                auto x_ = x + image * info.h * info.w * c;
+                                for (auto ow : range0_(info.wo)) {
+                                    auto yp = y + (i * info.wo + ow) * co;
+                                    if (b) {
+                                        std::copy_n(b, co, yp);
+                                    } else {
+                                        std::fill_n(yp, co, T{});
+                                    }
+                                    for (auto kh : range0_(info.kh)) {
+                                        sdim_t ih = oh * info.stride[0] + kh * info.dilation[0] - info.padBegin[0];
+                                        if (ih < 0 || ih >= static_cast<sdim_t>(info.h)) { continue; }
+                                        for (auto kw : range0_(info.kw)) {
+                                            sdim_t iw = ow * info.stride[1] + kw * info.dilation[1] - info.padBegin[1];
+                                            if (iw < 0 || iw >= static_cast<sdim_t>(info.w)) { continue; }
+                                            auto xp = x_ + (ih * info.w + iw) * c;
+                                            auto wp = w + (kh * info.kw + kw) * co;
+                                            if (multiplier == 1) {
+                                                for (auto oc : range0_(co)) { yp[oc] += wp[oc] * xp[oc]; }
+                                            } else {
+                                                for (auto oc : range0_(co)) { yp[oc] += wp[oc] * xp[oc / multiplier]; }
+                                            }
+                                        }
+                                    }
+                                }
+                            });
+        };
+        return {std::move(routine), workspace};
+    }
+
+    template<class T>
+    static auto lowerIm2col(Info const &info, Arc<Blob> const &constW, Resources &res) -> RoutineWorkspace {
+        auto const howo = static_cast<size_t>(info.ho) * info.wo,
+                   cg = static_cast<size_t>(info.c / info.groups),
+                   cog = static_cast<size_t>(info.co / info.groups),
+                   kk = static_cast<size_t>(info.kh) * info.kw;
+
+        if (!info.nhwc) {
+            // 每个图像展开成 [G][Cg*KH*KW][Ho*Wo]，Y[n][g] = W[g] @ col[g]
+            CpuGemm<T> const gemm(cog, cg * kk, howo, false, false, 1, info.bias ? T{1} : T{});
+            // 1x1、步长 1、无填充时展开的矩阵就是 X 本身
+            auto identity = kk == 1 &&
+                            info.stride[0] == 1 && info.stride[1] == 1 &&
+                            info.padBegin[0] == 0 && info.padBegin[1] == 0 &&
+                            info.ho == info.h && info.wo == info.w;
+            auto routine = [info, gemm, howo, kk, identity](Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
+                auto x = reinterpret_cast<T const *>(inputs[0]),
+                     w = reinterpret_cast<T const *>(inputs[1]);
+                auto y = reinterpret_cast<T *>(outputs[0]),
+                     col = reinterpret_cast<T *>(workspace);
+                if (info.bias) { fillBias(info, y, reinterpret_cast<T const *>(inputs[2])); }
+                auto const hw = static_cast<size_t>(info.h) * info.w;
+                for (auto image : range0_(info.n)) {
+                    auto x_ = x + image * info.c * hw;
+                    if (!identity) {
+                        std::for_each_n(std::execution::par_unseq,
+                                        natural_t(0), info.c * kk,
+                                        [=, &info](auto r) {
+                                            auto ic = r / kk, kh = r % kk / info.kw, kw = r % info.kw;
+                                            auto [begin, end] = validRange(info, kw);
+                                            auto xc = x_ + ic * hw + static_cast<sdim_t>(kw * info.dilation[1] - info.padBegin[1]);
+                                            auto dst = col + r * howo;
+                                            for (auto oh : range0_(info.ho)) {
+                                                auto row = dst + oh * info.wo;
+                                                sdim_t ih = oh * info.stride[0] + kh * info.dilation[0] - info.padBegin[0];
+                                                if (ih < 0 || ih >= static_cast<sdim_t>(info.h)) {
+                                                    std::fill_n(row, info.wo, T{});
+                                                    continue;
+                                                }
+                                                auto src = xc + ih * info.w;
+                                                std::fill_n(row, begin, T{});
+                                                for (auto ow = begin; ow < end; ++ow) { row[ow] = src[ow * info.stride[1]]; }
+                                                std::fill(row + end, row + info.wo, T{});
+                                            }
+                                        });
+                    }
+                    gemm(w, identity ? x_ : col, y + image * info.co * howo, info.groups);
+                }
+            };
+            return {std::move(routine), identity ? 0 : info.c * kk * howo * sizeof(T)};
+        }
+
+        // 每个图像展开成 [G][Ho*Wo][KH*KW*Cg]，Y[n][g] = col[g] @ W[g]^T，W 是常量时预先打包。
+        // 分组时每组的结果在 Y 中不连续，先写到工作空间再散布到 Y，同时加上偏置
+        auto scatter = info.groups > 1;
+        CpuGemm<T> const gemm(howo, kk * cg, cog, false, true, 1, info.bias && !scatter ? T{1} : T{});
+        auto packed = constW ? packConstB(res, gemm, constW, info.groups) : nullptr;
+        auto routine = [info, gemm, packed, howo, cg, cog, kk, scatter](Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
+            auto x = reinterpret_cast<T const *>(inputs[0]),
+                 w = packed ? packed : reinterpret_cast<T const *>(inputs[1]),
+                 b = info.bias ? reinterpret_cast<T const *>(inputs[2]) : nullptr;
+            auto y = reinterpret_cast<T *>(outputs[0]),
+                 col = reinterpret_cast<T *>(workspace),
+                 tmp = col + info.c * kk * howo;
+            if (b && !scatter) { fillBias(info, y, b); }
+            for (auto image : range0_(info.n)) {
+                auto x_ = x + image * info.h * info.w * info.c;
+                auto y_ = y + image * howo * info.co;
+                std::for_each_n(std::execution::par_unseq,
+                                natural_t(0), howo,
+                                [=, &info](auto p) {
+                                    auto oh = p / info.wo, ow = p % info.wo;
+                                    for (auto g : range0_(info.groups)) {
+                                        auto dst = col + (g * howo + p) * kk * cg;
+                                        for (auto kh : range0_(info.kh)) {
+                                            sdim_t ih = oh * info.stride[0] + kh * info.dilation[0] - info.padBegin[0];
+                                            for (auto kw : range0_(info.kw)) {
+                                                sdim_t iw = ow * info.stride[1] + kw * info.dilation[1] - info.padBegin[1];
+                                                if (ih < 0 || ih >= static_cast<sdim_t>(info.h) ||
+                                                    iw < 0 || iw >= static_cast<sdim_t>(info.w)) {
+                                                    std::fill_n(dst, cg, T{});
+                                                } else {
+                                                    std::copy_n(x_ + (ih * info.w + iw) * info.c + g * cg, cg, dst);
+                                                }
+                                                dst += cg;
+                                            }
+                                        }
+                                    }
+                                });
+                gemm(col, w, scatter ? tmp : y_, info.groups, nullptr, packed != nullptr);
+                if (scatter) {
+                    std::for_each_n(std::execution::par_unseq,
+                                    natural_t(0), howo,
+                                    [=, &info](auto p) {
+                                        for (auto g : range0_(info.groups)) {
+                                            auto src = tmp + (g * howo + p) * cog;
+                                            auto dst = y_ + p * info.co + g * cog;
+                                            for (auto j : range0_(cog)) { dst[j] = b ? src[j] + b[g * cog + j] : src[j]; }
+                                        }
+                                    });
+                }
+            }
+        };
+        return {std::move(routine), (info.c * kk * howo + (scatter ? howo * info.co : 0)) * sizeof(T)};
+    }
+
+    template<class T>
+    static auto lowerTyped(Info const &info, Arc<Blob> const &constW, Resources &res) -> RoutineWorkspace {
+        switch (info.algo) {
+            case ConvCpu::Algo::Pointwise:
+                return lowerPointwise<T>(info, constW, res);
+            case ConvCpu::Algo::Depthwise:
+                return lowerDepthwise<T>(info, constW, res);
+            default:
+                return lowerIm2col<T>(info, constW, res);
+        }
+    }
+
+    auto K::lower(Resources &res) const noexcept -> RoutineWorkspace {
+        switch (info.dt) {
+            case DT::F32:
+                return lowerTyped<float>(info, constW, res);
+            case DT::F64:
+                return lowerTyped<double>(info, constW, res);
+            default:
+                UNREACHABLE();
+        }
+    }
+
+}// namespace refactor::kernel
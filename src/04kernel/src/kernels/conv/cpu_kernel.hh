@@ -0,0 +1,52 @@
+#ifndef KERNEL_CONV_CPU_KERNEL_HH
+#define KERNEL_CONV_CPU_KERNEL_HH
+
+#include "kernel/attributes/pool_attributes.h"
+#include "kernel/kernel.h"
+#include "kernel/tensor.h"
+#include <optional>
+
+namespace refactor::kernel {
+
+    /// @brief 支持 1D 和 2D 卷积，NCHW 和 NHWC 布局，分组、膨胀、步长和填充，偏置融合在计算中。
+    struct ConvCpu final : public Kernel {
+        enum class Algo : uint8_t {
+            /// @brief 展开成矩阵后调用打包的矩阵乘。
+            Im2col,
+            /// @brief 1x1、步长 1、无填充、不分组的卷积，直接是一个矩阵乘。
+            Pointwise,
+            /// @brief 每组一个输入通道的逐通道卷积，直接计算。
+            Depthwise,
+        };
+
+        struct {
+            DataType dt;
+            Algo algo;
+            bool nhwc, bias;
+            dim_t n, c, h, w,
+                co, kh, kw, ho, wo,
+                groups;
+            ddim_t dilation[2], padBegin[2], stride[2];
+        } info;
+        /// @brief W 是常量时的数据，降级时预先变换成计算使用的布局。
+        Arc<Blob> constW;
+
+        ConvCpu(decltype(info), decltype(constW)) noexcept;
+
+        static KernelBox build(PoolAttributes const &,
+                               Tensor const &,
+                               Tensor const &,
+                               std::optional<std::reference_wrapper<Tensor const>>,
+                               Tensor const &,
+                               decltype(constW) = nullptr);
+        static size_t typeId() noexcept;
+
+        size_t kernelTypeId() const noexcept final;
+        std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
+        RoutineWorkspace lower(Resources &) const noexcept final;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_CONV_CPU_KERNEL_HH
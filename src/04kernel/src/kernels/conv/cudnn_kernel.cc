@@ -7,6 +7,7 @@
 #include "../extra_padding/extra_padding.cuh"
 #include "hardware/functions.h"
 #endif
+#include <numeric>
 
 namespace refactor::kernel {
     using K = ConvCudnn;
@@ -84,6 +85,12 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing conv using CUDNN";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        auto outputs = std::accumulate(info.yShape, info.yShape + 4, size_t(1), std::multiplies<size_t>());
+        // 每个输出元素对一个卷积窗口做乘加
+        auto window = static_cast<size_t>(info.wShape[1]) * info.wShape[2] * info.wShape[3];
+        return {outputs * window * 2 + (info.biasExpand ? outputs : 0), 0, 0};
+    }
 
 #ifdef USE_CUDA
 
@@ -33,6 +33,7 @@ namespace refactor::kernel {
 
         size_t kernelTypeId() const noexcept final;
         std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
 #ifdef USE_CUDA
         RoutineWorkspace lower(Resources &) const final;
 #endif
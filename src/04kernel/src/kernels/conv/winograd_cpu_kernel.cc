@@ -0,0 +1,283 @@
+#include "winograd_cpu_kernel.hh"
+#include "../mat_mul_common/cpu_gemm.hh"
+#include "../mat_mul_common/packed_weights.hh"
+#include "kernel/weight_cache.h"
+#include <array>
+#include <execution>
+
+namespace refactor::kernel {
+    using K = ConvWinogradCpu;
+    using Info = decltype(K::info);
+
+    // 通道数低于此值时变换的开销抵消了乘法的节省；
+    // 块数低于此值时每个变换域位置的矩阵乘太小，不如直接展开
+    constexpr static size_t MIN_CHANNELS = 16, MIN_TILES = 8;
+    // F(4x4,3x3)：6x6 的输入块产生 4x4 的输出块，相邻输入块重叠 2 行 2 列
+    constexpr static size_t TILE = 6, OUT = 4, POINTS = TILE * TILE;
+    // 变换在通道上向量化，每次处理 LANES 个通道
+    constexpr static size_t LANES = 16;
+    using Vec = float __attribute__((vector_size(LANES * sizeof(float))));
+    // 每批处理的块数使两个变换域缓冲区合计不超过这个元素数
+    constexpr static size_t BATCH_ELEMENTS = 1ul << 21;
+
+    K::ConvWinogradCpu(decltype(info) info_, decltype(constW) constW_) noexcept
+        : Kernel(), info(std::move(info_)), constW(std::move(constW_)) {}
+
+    auto K::build(PoolAttributes const &poolAttributes,
+                  Tensor const &x,
+                  Tensor const &w,
+                  std::optional<std::reference_wrapper<Tensor const>> b,
+                  Tensor const &y,
+                  decltype(constW) constW) -> KernelBox {
+        auto dt = DataType::F32;
+        if (x.dataType != dt || w.dataType != dt || y.dataType != dt || (b && b->get().dataType != dt)) {
+            return nullptr;
+        }
+        if (poolAttributes.rank() != 2 || x.rank() != 4 || w.rank() != 4) {
+            return nullptr;
+        }
+        auto nhwc = x.layout == LayoutType::NHWC;
+        if (nhwc && w.layout != LayoutType::NHWC) {
+            return nullptr;
+        }
+        auto d = poolAttributes.dilations(),
+             p = poolAttributes.padsBegin(),
+             s = poolAttributes.strides();
+        if (d[0] != 1 || d[1] != 1 || s[0] != 1 || s[1] != 1) {
+            return nullptr;
+        }
+
+        // 布局变换后 X 是 [N,H,W,C]，W 是 [Co,KH,KW,C]，Y 是 [N,Ho,Wo,Co]
+        auto dims = [nhwc](Tensor const &t) {
+            return nhwc ? std::array{t.shape[0], t.shape[3], t.shape[1], t.shape[2]}
+                        : std::array{t.shape[0], t.shape[1], t.shape[2], t.shape[3]};
+        };
+        auto [n, c, h, w_] = dims(x);
+        auto [co, cg, kh, kw] = dims(w);
+        auto [n_, co_, ho, wo] = dims(y);
+        if (kh != 3 || kw != 3 || cg != c || co_ != co ||
+            c < MIN_CHANNELS || co < MIN_CHANNELS ||
+            n * ((ho + OUT - 1) / OUT) * ((wo + OUT - 1) / OUT) < MIN_TILES) {
+            return nullptr;
+        }
+        return std::make_unique<K>(decltype(info){
+                                       nhwc,
+                                       b.has_value(),
+                                       n, c, h, w_,
+                                       co, ho, wo,
+                                       {p[0], p[1]},
+                                   },
+                                   std::move(constW));
+    }
+
+    auto K::typeId() noexcept -> size_t {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+
+    auto K::kernelTypeId() const noexcept -> size_t { return typeId(); }
+    auto K::description() const noexcept -> std::string_view {
+        return "Performing 3x3 conv using CPU with winograd F(4x4,3x3)";
+    }
+    auto K::cost() const noexcept -> KernelCost {
+        // 按直接卷积的计算量计，与其他卷积内核可比
+        auto outputs = static_cast<size_t>(info.n) * info.co * info.ho * info.wo;
+        return {outputs * info.c * 9 * 2 + (info.bias ? outputs : 0), 0, 0};
+    }
+
+    // U = G g G^T，在双精度下计算，U 存成 [36][C][Co]
+    static void transformFilter(Info const &info, float const *w, float *u) {
+        constexpr static double G[TILE][3]{
+            {1. / 4, 0, 0},
+            {-1. / 6, -1. / 6, -1. / 6},
+            {-1. / 6, 1. / 6, -1. / 6},
+            {1. / 24, 1. / 12, 1. / 6},
+            {1. / 24, -1. / 12, 1. / 6},
+            {0, 0, 1},
+        };
+        auto const c = info.c, co = info.co;
+        std::for_each_n(std::execution::par_unseq,
+                        natural_t(0), co,
+                        [=, &info](auto oc) {
+                            for (auto ic : range0_(c)) {
+                                double g[3][3], t[TILE][3]{};
+                                for (auto i : range0_(3))
+                                    for (auto j : range0_(3))
+                                        g[i][j] = info.nhwc ? w[((oc * 3 + i) * 3 + j) * c + ic]
+                                                            : w[((oc * c + ic) * 3 + i) * 3 + j];
+                                for (auto i : range0_(TILE))
+                                    for (auto j : range0_(3))
+                                        for (auto k : range0_(3)) t[i][j] += G[i][k] * g[k][j];
+                                for (auto i : range0_(TILE))
+                                    for (auto j : range0_(TILE)) {
+                                        double v = 0;
+                                        for (auto k : range0_(3)) { v += t[i][k] * G[j][k]; }
+                                        u[((i * TILE + j) * c + ic) * co + oc] = static_cast<float>(v);
+                                    }
+                            }
+                        });
+    }
+
+    // B^T d，`d` 和 `o` 中相邻元素的间距分别是 `ds` 和 `os`
+    static inline void inputTransform(Vec const *d, size_t ds, Vec *o, size_t os) {
+        auto d0 = d[0], d1 = d[ds], d2 = d[2 * ds], d3 = d[3 * ds], d4 = d[4 * ds], d5 = d[5 * ds];
+        o[0] = 4.f * d0 - 5.f * d2 + d4;
+        o[os] = d4 + d3 - 4.f * (d1 + d2);
+        o[2 * os] = d4 - d3 + 4.f * (d1 - d2);
+        o[3 * os] = d4 - d2 + 2.f * (d3 - d1);
+        o[4 * os] = d4 - d2 - 2.f * (d3 - d1);
+        o[5 * os] = 4.f * d1 - 5.f * d3 + d5;
+    }
+
+    // A^T m，`m` 和 `o` 中相邻元素的间距分别是 `ms` 和 `os`
+    static inline void outputTransform(Vec const *m, size_t ms, Vec *o, size_t os) {
+        auto m0 = m[0], m1 = m[ms], m2 = m[2 * ms], m3 = m[3 * ms], m4 = m[4 * ms], m5 = m[5 * ms];
+        auto s12 = m1 + m2, d12 = m1 - m2, s34 = m3 + m4, d34 = m3 - m4;
+        o[0] = m0 + s12 + s34;
+        o[os] = d12 + 2.f * d34;
+        o[2 * os] = s12 + 4.f * s34;
+        o[3 * os] = d12 + 8.f * d34 + m5;
+    }
+
+    // 第 `t` 块的左上角
+    struct TilePosition {
+        dim_t image;
+        sdim_t row, col;
+    };
+    static TilePosition locate(Info const &info, size_t t) {
+        auto tilesW = (info.wo + OUT - 1) / OUT,
+             tilesH = (info.ho + OUT - 1) / OUT;
+        return {
+            static_cast<dim_t>(t / tilesW / tilesH),
+            static_cast<sdim_t>(t / tilesW % tilesH * OUT),
+            static_cast<sdim_t>(t % tilesW * OUT),
+        };
+    }
+
+    // 把 `tiles` 个输入块从 `t0` 开始变换到 V[36][tiles][C]
+    template<bool NHWC>
+    static void transformInputs(Info const &info, float const *x, float *v, size_t t0, size_t tiles) {
+        auto cBlocks = (info.c + LANES - 1) / LANES;
+        std::for_each_n(std::execution::par_unseq,
+                        natural_t(0), tiles * cBlocks,
+                        [=, &info](auto i) {
+                            auto tile = i / cBlocks, c0 = i % cBlocks * LANES;
+                            auto lanes = std::min<size_t>(LANES, info.c - c0);
+                            auto [image, row, col] = locate(info, t0 + tile);
+                            Vec d[TILE][TILE], t[TILE][TILE];
+                            for (auto r : range0_(TILE)) {
+                                sdim_t ih = row + r - info.padBegin[0];
+                                for (auto c : range0_(TILE)) {
+                                    sdim_t iw = col + c - info.padBegin[1];
+                                    d[r][c] = Vec{};
+                                    if (ih < 0 || ih >= static_cast<sdim_t>(info.h) ||
+                                        iw < 0 || iw >= static_cast<sdim_t>(info.w)) {
+                                        continue;
+                                    }
+                                    if constexpr (NHWC) {
+                                        std::memcpy(&d[r][c], x + ((image * info.h + ih) * info.w + iw) * info.c + c0, lanes * sizeof(float));
+                                    } else {
+                                        auto src = x + ((image * info.c + c0) * info.h + ih) * info.w + iw;
+                                        for (auto k : range0_(lanes)) { d[r][c][k] = src[k * info.h * info.w]; }
+                                    }
+                                }
+                            }
+                            for (auto c : range0_(TILE)) { inputTransform(&d[0][c], TILE, &t[0][c], TILE); }
+                            for (auto r : range0_(TILE)) { inputTransform(t[r], 1, d[r], 1); }
+                            for (auto p : range0_(POINTS)) {
+                                std::memcpy(v + (p * tiles + tile) * info.c + c0, &d[p / TILE][p % TILE], lanes * sizeof(float));
+                            }
+                        });
+    }
+
+    // 把 M[36][tiles][Co] 逆变换成从 `t0` 开始的 `tiles` 个输出块，同时加上偏置
+    template<bool NHWC>
+    static void transformOutputs(Info const &info, float const *m, float const *b, float *y, size_t t0, size_t tiles) {
+        auto cBlocks = (info.co + LANES - 1) / LANES;
+        std::for_each_n(std::execution::par_unseq,
+                        natural_t(0), tiles * cBlocks,
+                        [=, &info](auto i) {
+                            auto tile = i / cBlocks, c0 = i % cBlocks * LANES;
+                            auto lanes = std::min<size_t>(LANES, info.co - c0);
+                            auto [image, row, col] = locate(info, t0 + tile);
+                            Vec d[TILE][TILE], t[OUT][TILE], o[OUT][OUT], bias{};
+                            for (auto p : range0_(POINTS)) {
+                                std::memcpy(&d[p / TILE][p % TILE], m + (p * tiles + tile) * info.co + c0, lanes * sizeof(float));
+                            }
+                            if (b) { std::memcpy(&bias, b + c0, lanes * sizeof(float)); }
+                            for (auto c : range0_(TILE)) { outputTransform(&d[0][c], TILE, &t[0][c], TILE); }
+                            for (auto r : range0_(OUT)) { outputTransform(t[r], 1, o[r], 1); }
+                            for (auto r : range0_(std::min<size_t>(OUT, info.ho - row))) {
+                                for (auto c : range0_(std::min<size_t>(OUT, info.wo - col))) {
+                                    auto v = o[r][c] + bias;
+                                    auto oh = row + r, ow = col + c;
+                                    if constexpr (NHWC) {
+                                        std::memcpy(y + ((image * info.ho + oh) * info.wo + ow) * info.co + c0, &v, lanes * sizeof(float));
+                                    } else {
+                                        auto dst = y + ((image * info.co + c0) * info.ho + oh) * info.wo + ow;
+                                        for (auto k : range0_(lanes)) { dst[k * info.ho * info.wo] = v[k]; }
+                                    }
+                                }
+                            }
+                        });
+    }
+
+    auto K::lower(Resources &res) const noexcept -> RoutineWorkspace {
+        size_t const tiles = static_cast<size_t>(info.n) *
+                             ((info.ho + OUT - 1) / OUT) *
+                             ((info.wo + OUT - 1) / OUT),
+                     batch = std::clamp<size_t>(BATCH_ELEMENTS / (POINTS * (info.c + info.co)), 1, tiles),
+                     tail = tiles % batch;
+        // 36 个变换域位置各做一个 [块,C] @ [C,Co] 的矩阵乘，最后一批的块数可能较少
+        CpuGemm<float> const gemm(batch, info.c, info.co, false, false, 1, 0),
+            gemmTail(tail, info.c, info.co, false, false, 1, 0, &gemm.kernel());
+
+        // 常量 W 在降级时变换并打包，经权重缓存共享，由资源表持有
+        float const *packed = nullptr;
+        if (constW) {
+            auto size = gemm.packedSize() * POINTS * sizeof(float);
+            auto layout = fmt::format("winograd f(4,3) u {} {}x{}{}",
+                                      gemm.kernel().isa, info.c, info.co, info.nhwc ? " nhwc" : "");
+            auto blob = WeightCache::instance().derive(constW, std::move(layout), size, [&](void *dst) {
+                std::vector<float> u(POINTS * info.c * info.co);
+                transformFilter(info, constW->get<float>(), u.data());
+                for (auto p : range0_(POINTS)) {
+                    gemm.packB(u.data() + p * info.c * info.co, static_cast<float *>(dst) + p * gemm.packedSize());
+                }
+            });
+            packed = res.fetchOrStore<PackedWeights>()->hold<float>(std::move(blob), size);
+        }
+
+        auto routine = [info = info, gemm, gemmTail, packed, tiles, batch]//
+            (Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
+                auto x = reinterpret_cast<float const *>(inputs[0]),
+                     b = info.bias ? reinterpret_cast<float const *>(inputs[2]) : nullptr;
+                auto y = reinterpret_cast<float *>(outputs[0]);
+                auto v = reinterpret_cast<float *>(workspace),
+                     m = v + POINTS * batch * info.c;
+                auto u = packed;
+                if (!u) {
+                    auto u_ = m + POINTS * batch * info.co;
+                    transformFilter(info, reinterpret_cast<float const *>(inputs[1]), u_);
+                    u = u_;
+                }
+                for (size_t t0 = 0; t0 < tiles; t0 += batch) {
+                    auto count = std::min(batch, tiles - t0);
+                    if (info.nhwc) {
+                        transformInputs<true>(info, x, v, t0, count);
+                    } else {
+                        transformInputs<false>(info, x, v, t0, count);
+                    }
+                    (count == batch ? gemm : gemmTail)(v, u, m, POINTS, nullptr, packed != nullptr);
+                    if (info.nhwc) {
+                        transformOutputs<true>(info, m, b, y, t0, count);
+                    } else {
+                        transformOutputs<false>(info, m, b, y, t0, count);
+                    }
+                }
+            };
+        auto workspace = POINTS * (batch * (info.c + info.co) + (packed ? 0 : info.c * info.co)) * sizeof(float);
+        return {std::move(routine), workspace};
+    }
+
+}// namespace refactor::kernel
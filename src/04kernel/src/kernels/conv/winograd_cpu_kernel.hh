@@ -0,0 +1,42 @@
+#ifndef KERNEL_CONV_WINOGRAD_CPU_KERNEL_HH
+#define KERNEL_CONV_WINOGRAD_CPU_KERNEL_HH
+
+#include "kernel/attributes/pool_attributes.h"
+#include "kernel/kernel.h"
+#include "kernel/tensor.h"
+#include <optional>
+
+namespace refactor::kernel {
+
+    /// @brief 用 Winograd F(4x4,3x3) 计算步长 1、不膨胀、不分组的 3x3 卷积，支持 NCHW 和 NHWC 布局。
+    ///        每个 6x6 的输入块变换后，36 个变换域位置各做一个 [块,C] @ [C,Co] 的矩阵乘，再逆变换成 4x4 的输出块。
+    ///        乘法次数是直接卷积的 1/4，代价是变换的开销和更大的舍入误差，只在通道数足够多时选择。
+    struct ConvWinogradCpu final : public Kernel {
+        struct {
+            bool nhwc, bias;
+            dim_t n, c, h, w,
+                co, ho, wo;
+            ddim_t padBegin[2];
+        } info;
+        /// @brief W 是常量时的数据，降级时预先变换并打包。
+        Arc<Blob> constW;
+
+        ConvWinogradCpu(decltype(info), decltype(constW)) noexcept;
+
+        static KernelBox build(PoolAttributes const &,
+                               Tensor const &,
+                               Tensor const &,
+                               std::optional<std::reference_wrapper<Tensor const>>,
+                               Tensor const &,
+                               decltype(constW) = nullptr);
+        static size_t typeId() noexcept;
+
+        size_t kernelTypeId() const noexcept final;
+        std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
+        RoutineWorkspace lower(Resources &) const noexcept final;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_CONV_WINOGRAD_CPU_KERNEL_HH
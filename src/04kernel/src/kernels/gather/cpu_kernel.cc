@@ -20,6 +20,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing gather using CPU";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
     auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
         using namespace runtime;
@@ -27,6 +27,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing gather using CUDA";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
 #ifdef USE_CUDA
     auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
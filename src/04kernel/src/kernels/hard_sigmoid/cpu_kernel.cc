@@ -24,6 +24,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing HardSigmoid using CPU";
     }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        return {0};
+    }
 
     template<class T>
     static Routine lowerTyped(float alpha_, float beta_, size_t size) {
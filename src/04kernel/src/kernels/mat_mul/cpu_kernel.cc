@@ -1,17 +1,18 @@
 #include "cpu_kernel.hh"
 #include "../expand/cpu_kernel.hh"
-#include "../mat_mul_common/cpu_template.hpp"
+#include "../mat_mul_common/cpu_gemm.hh"
+#include "../mat_mul_common/packed_weights.hh"
 
 namespace refactor::kernel {
     using K = MatMulCPU;
     using DT = DataType;
 
-    K::MatMulCPU(decltype(info) info_) noexcept
-        : Kernel(), info(std::move(info_)) {}
+    K::MatMulCPU(decltype(info) info_, decltype(constB) constB_) noexcept
+        : Kernel(), info(std::move(info_)), constB(std::move(constB_)) {}
 
-    auto K::build(decltype(info) info) noexcept -> KernelBox {
+    auto K::build(decltype(info) info, decltype(constB) constB) noexcept -> KernelBox {
         return info.dataType.isCpuNumberic()
-                   ? std::make_unique<K>(std::move(info))
+                   ? std::make_unique<K>(std::move(info), std::move(constB))
                    : nullptr;
     }
 
@@ -22,55 +23,60 @@ namespace refactor::kernel {
 
     auto K::kernelTypeId() const noexcept -> size_t { return typeId(); }
     auto K::description() const noexcept -> std::string_view {
-        return "Performing MatMul using CPU";
+        return constB ? "Performing MatMul using CPU with pre-packed B"
+                      : "Performing MatMul using CPU";
+    }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
     }
 
     template<class T>
-    static auto lowerTyped(MatMulInfo const &info, Resources &res) noexcept -> RoutineWorkspace {
+    static auto lowerTyped(MatMulInfo const &info, Arc<Blob> const &constB, Resources &res) noexcept -> RoutineWorkspace {
 
         auto biasEx = info.biasExpand
                           ? std::make_optional(ExpandCpu(*info.biasExpand).lower(res).routine)
                           : std::nullopt;
 
-        return [info = info, biasEx](runtime::Resources &res, void *, void const *const *inputs, void *const *outputs) {
-            if (biasEx) { (*biasEx)(res, nullptr, inputs + 2, outputs); }
-
-            MatMulCPUMetaData const md{
-                .M = info.m,
-                .K = info.k,
-                .N = info.n,
-                .strideA0 = info.transA ? 1 : info.k,
-                .strideA1 = info.transA ? info.m : 1,
-                .strideB0 = info.transB ? 1 : info.n,
-                .strideB1 = info.transB ? info.k : 1,
-                .alpha = static_cast<T>(info.alpha),
-                .beta = static_cast<T>(info.biasExpand ? info.beta : 0.0f),
-            };
-            auto const stepY = info.m * info.n,
-                       stepA = info.m * info.k,
-                       stepB = info.k * info.n;
-
-            auto a = reinterpret_cast<T const *>(inputs[0]);
-            auto b = reinterpret_cast<T const *>(inputs[1]);
-            auto y = reinterpret_cast<T *>(outputs[0]);
-            if (info.broadcaster.needBroadcast()) {
-                dim_t offset[2];
-                for (auto i : range0_(info.broadcaster.outputsCount)) {
-                    info.broadcaster.locate(i, offset);
-                    md.matrixMultiply(a + stepA * offset[0], b + stepB * offset[1], y + stepY * i);
-                }
-            } else {
-                for (auto i : range0_(info.broadcaster.outputsCount)) {
-                    md.matrixMultiply(a + stepA * i, b + stepB * i, y + stepY * i);
-                }
+        CpuGemm<T> const gemm(
+            info.m, info.k, info.n,
+            info.transA, info.transB,
+            static_cast<T>(info.alpha),
+            static_cast<T>(info.biasExpand ? info.beta : 0.0f));
+        // 广播时每个矩阵乘使用的 A 和 B 的序号在降级时算好
+        std::vector<dim_t> offsets;
+        if (info.broadcaster.needBroadcast()) {
+            offsets.resize(info.broadcaster.outputsCount * 2);
+            for (auto i : range0_(info.broadcaster.outputsCount)) {
+                info.broadcaster.locate(i, offsets.data() + 2 * i);
             }
-        };
+        }
+
+        auto batch = info.broadcaster.outputsCount;
+
+        // 常量 B 按微内核的布局打包一次
+        T const *packed = nullptr;
+        if (constB && info.k) {
+            auto count = offsets.empty() ? batch : 0;
+            for (auto i : range0_(offsets.size() / 2)) { count = std::max<size_t>(count, offsets[2 * i + 1] + 1); }
+            packed = packConstB(res, gemm, constB, count);
+        }
+
+        return [gemm, offsets = std::move(offsets), batch, biasEx, packed]//
+            (runtime::Resources &res, void *, void const *const *inputs, void *const *outputs) {
+                if (biasEx) { (*biasEx)(res, nullptr, inputs + 2, outputs); }
+                gemm(reinterpret_cast<T const *>(inputs[0]),
+                     packed ? packed : reinterpret_cast<T const *>(inputs[1]),
+                     reinterpret_cast<T *>(outputs[0]),
+                     batch,
+                     offsets.empty() ? nullptr : offsets.data(),
+                     packed != nullptr);
+            };
     }
 
     auto K::lower(Resources &res) const noexcept -> RoutineWorkspace {
 #define CASE(T)       \
     case DataType::T: \
-        return lowerTyped<primitive<DataType::T>::type>(info, res);
+        return lowerTyped<primitive<DataType::T>::type>(info, constB, res);
 
         switch (info.dataType) {
             CASE(F32);
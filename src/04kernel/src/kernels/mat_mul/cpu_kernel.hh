@@ -8,14 +8,17 @@ namespace refactor::kernel {
 
     struct MatMulCPU final : public Kernel {
         MatMulInfo info;
+        /// @brief B 是常量时的数据，降级时预先打包。
+        Arc<Blob> constB;
 
-        explicit MatMulCPU(decltype(info)) noexcept;
+        MatMulCPU(decltype(info), decltype(constB)) noexcept;
 
-        static KernelBox build(decltype(info)) noexcept;
+        static KernelBox build(decltype(info), decltype(constB) = nullptr) noexcept;
         static size_t typeId() noexcept;
 
         size_t kernelTypeId() const noexcept final;
         std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
 
         RoutineWorkspace lower(Resources &) const noexcept final;
     };
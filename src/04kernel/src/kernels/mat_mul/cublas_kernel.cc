@@ -26,5 +26,8 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing MatMul using CUBLAS";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
 }// namespace refactor::kernel
@@ -0,0 +1,279 @@
+#include "cpu_gemm.hh"
+#include <algorithm>
+#include <array>
+#include <execution>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMM_X86
+#include <immintrin.h>
+#endif
+
+namespace refactor::kernel {
+
+    // 计算量低于此值（乘加次数）时不值得分派到多个线程
+    constexpr static size_t PARALLEL_THRESHOLD = 1ul << 18;
+
+    // 各级分块的目标大小，实际大小取微内核行列数的整数倍：
+    // KC x NR 的 B 面板留在 L1，MC x KC 的 A 块和 KC x NC 的 B 块留在 L2
+    constexpr static size_t MC = 120, KC = 256, NC = 256;
+    // 微内核结果块的最大元素数
+    constexpr static size_t MAX_TILE = 14 * 32;
+
+    // `ROWS` 是实际计算的行数，小于 `MR` 时用于 M 方向的边角和很小的 M
+    template<class T, size_t MR, size_t NR, size_t ROWS>
+    static void microScalar(size_t kc, T const *a, T const *b, T *c, size_t ldc, T alpha, T beta) noexcept {
+        T acc[ROWS][NR]{};
+        for (size_t p = 0; p < kc; ++p, a += MR, b += NR) {
+            for (size_t i = 0; i < ROWS; ++i) {
+                for (size_t j = 0; j < NR; ++j) {
+                    acc[i][j] += static_cast<T>(a[i] * b[j]);
+                }
+            }
+        }
+        for (size_t i = 0; i < ROWS; ++i) {
+            for (size_t j = 0; j < NR; ++j) {
+                auto &y = c[i * ldc + j];
+                y = beta == T{} ? static_cast<T>(alpha * acc[i][j]) : static_cast<T>(alpha * acc[i][j] + beta * y);
+            }
+        }
+    }
+
+#ifdef GEMM_X86
+
+    template<size_t MR, size_t ROWS>
+    __attribute__((target("avx2,fma"))) static void microAvx2(
+        size_t kc, float const *a, float const *b, float *c, size_t ldc, float alpha, float beta) noexcept {
+        __m256 acc[ROWS][2];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < ROWS; ++i) { acc[i][0] = acc[i][1] = _mm256_setzero_ps(); }
+        for (size_t p = 0; p < kc; ++p, a += MR, b += 16) {
+            auto b0 = _mm256_loadu_ps(b), b1 = _mm256_loadu_ps(b + 8);
+#pragma GCC unroll 16
+            for (size_t i = 0; i < ROWS; ++i) {
+                auto ai = _mm256_broadcast_ss(a + i);
+                acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+                acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+            }
+        }
+        auto alpha_ = _mm256_set1_ps(alpha), beta_ = _mm256_set1_ps(beta);
+#pragma GCC unroll 16
+        for (size_t i = 0; i < ROWS; ++i) {
+            for (size_t h = 0; h < 2; ++h) {
+                auto y = c + i * ldc + h * 8;
+                auto v = _mm256_mul_ps(alpha_, acc[i][h]);
+                _mm256_storeu_ps(y, beta == 0 ? v : _mm256_fmadd_ps(beta_, _mm256_loadu_ps(y), v));
+            }
+        }
+    }
+
+    template<size_t MR, size_t ROWS>
+    __attribute__((target("avx512f"))) static void microAvx512(
+        size_t kc, float const *a, float const *b, float *c, size_t ldc, float alpha, float beta) noexcept {
+        __m512 acc[ROWS][2];
+#pragma GCC unroll 16
+        for (size_t i = 0; i < ROWS; ++i) { acc[i][0] = acc[i][1] = _mm512_setzero_ps(); }
+        for (size_t p = 0; p < kc; ++p, a += MR, b += 32) {
+            auto b0 = _mm512_loadu_ps(b), b1 = _mm512_loadu_ps(b + 16);
+#pragma GCC unroll 16
+            for (size_t i = 0; i < ROWS; ++i) {
+                auto ai = _mm512_set1_ps(a[i]);
+                acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+                acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+            }
+        }
+        auto alpha_ = _mm512_set1_ps(alpha), beta_ = _mm512_set1_ps(beta);
+#pragma GCC unroll 16
+        for (size_t i = 0; i < ROWS; ++i) {
+            for (size_t h = 0; h < 2; ++h) {
+                auto y = c + i * ldc + h * 16;
+                auto v = _mm512_mul_ps(alpha_, acc[i][h]);
+                _mm512_storeu_ps(y, beta == 0 ? v : _mm512_fmadd_ps(beta_, _mm512_loadu_ps(y), v));
+            }
+        }
+    }
+
+#endif
+
+    // 微内核按计算的行数展开成表，第 r - 1 项计算前 r 行
+    template<class T, size_t MR, size_t NR, size_t... I>
+    constexpr static auto scalarTable(std::index_sequence<I...>) {
+        return std::array<typename GemmMicroKernel<T>::Fn, MR>{microScalar<T, MR, NR, I + 1>...};
+    }
+#ifdef GEMM_X86
+    template<size_t MR, size_t... I>
+    constexpr static auto avx2Table(std::index_sequence<I...>) {
+        return std::array<GemmMicroKernel<float>::Fn, MR>{microAvx2<MR, I + 1>...};
+    }
+    template<size_t MR, size_t... I>
+    constexpr static auto avx512Table(std::index_sequence<I...>) {
+        return std::array<GemmMicroKernel<float>::Fn, MR>{microAvx512<MR, I + 1>...};
+    }
+#endif
+
+    template<class T>
+    std::span<GemmMicroKernel<T> const> gemmMicroKernels() noexcept {
+        constexpr static size_t MR = 4, NR = 8;
+        constexpr static auto SCALAR = scalarTable<T, MR, NR>(std::make_index_sequence<MR>{});
+        static auto const KERNELS = [] {
+            std::vector<GemmMicroKernel<T>> ans;
+#ifdef GEMM_X86
+            if constexpr (std::is_same_v<T, float>) {
+                // AVX-512 有 32 个向量寄存器，14x32 的块用 28 个累加；AVX2 只有 16 个，6x16 的块用 12 个
+                constexpr static auto AVX512 = avx512Table<14>(std::make_index_sequence<14>{});
+                constexpr static auto AVX2 = avx2Table<6>(std::make_index_sequence<6>{});
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f")) {
+                    ans.push_back({"avx512", 14, 32, AVX512.data()});
+                }
+                if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                    ans.push_back({"avx2", 6, 16, AVX2.data()});
+                }
+            }
+#endif
+            ans.push_back({"scalar", MR, NR, SCALAR.data()});
+            return ans;
+        }();
+        return KERNELS;
+    }
+
+    // 把 A 的 mc x kc 块打包成 [⌈mc/MR⌉][kc][MR]，元素 (i, p) 位于 a[i * rs + p * cs]，不足 MR 行的部分补 0
+    template<class T>
+    static void packPanelsA(T const *a, size_t rs, size_t cs, size_t mc, size_t kc, size_t mr, T *dst) noexcept {
+        for (size_t i0 = 0; i0 < mc; i0 += mr) {
+            auto rows = std::min(mr, mc - i0);
+            for (size_t p = 0; p < kc; ++p, dst += mr) {
+                for (size_t i = 0; i < rows; ++i) { dst[i] = a[(i0 + i) * rs + p * cs]; }
+                std::fill(dst + rows, dst + mr, T{});
+            }
+        }
+    }
+
+    // 把 B 的 kc x nc 块打包成 [⌈nc/NR⌉][kc][NR]，元素 (p, j) 位于 b[p * rs + j * cs]，不足 NR 列的部分补 0
+    template<class T>
+    static void packPanelsB(T const *b, size_t rs, size_t cs, size_t kc, size_t nc, size_t nr, T *dst) noexcept {
+        for (size_t j0 = 0; j0 < nc; j0 += nr) {
+            auto cols = std::min(nr, nc - j0);
+            for (size_t p = 0; p < kc; ++p, dst += nr) {
+                if (cs == 1) {
+                    std::copy_n(b + p * rs + j0, cols, dst);
+                } else {
+                    for (size_t j = 0; j < cols; ++j) { dst[j] = b[p * rs + (j0 + j) * cs]; }
+                }
+                std::fill(dst + cols, dst + nr, T{});
+            }
+        }
+    }
+
+    template<class T>
+    CpuGemm<T>::CpuGemm(size_t m, size_t k, size_t n,
+                        bool transA, bool transB,
+                        T alpha, T beta,
+                        GemmMicroKernel<T> const *kernel) noexcept
+        : _m(m), _k(k), _n(n),
+          _transA(transA), _transB(transB),
+          _alpha(alpha), _beta(beta),
+          _kernel(kernel ? *kernel : gemmMicroKernels<T>().front()),
+          _mc(std::max<size_t>(1, MC / _kernel.mr) * _kernel.mr),
+          _kc(std::min(KC, std::max<size_t>(k, 1))),
+          _nc(std::max<size_t>(1, NC / _kernel.nr) * _kernel.nr) {}
+
+    template<class T>
+    size_t CpuGemm<T>::packedSize() const noexcept {
+        return (_n + _kernel.nr - 1) / _kernel.nr * _kernel.nr * _k;
+    }
+
+    template<class T>
+    void CpuGemm<T>::packB(T const *b, T *dst) const noexcept {
+        packPanelsB(b, _transB ? 1 : _n, _transB ? _k : 1, _k, _n, _kernel.nr, dst);
+    }
+
+    template<class T>
+    void CpuGemm<T>::operator()(T const *a, T const *b, T *y, size_t batch, dim_t const *offsets, bool packedB) const {
+        auto const mr = _kernel.mr, nr = _kernel.nr;
+        auto const fn = _kernel.fn;
+        auto const rsA = _transA ? 1 : _k, csA = _transA ? _m : 1,
+                   rsB = _transB ? 1 : _n, csB = _transB ? _k : 1;
+        auto const mBlocks = (_m + _mc - 1) / _mc,
+                   nBlocks = (_n + _nc - 1) / _nc;
+
+        // 每个任务计算一个结果矩阵中 MC x NC 的块，沿 K 累加，块之间没有共享的写
+        auto task = [&, this](size_t t) {
+            auto jb = t % nBlocks, ib = t / nBlocks % mBlocks, i = t / nBlocks / mBlocks;
+            auto a_ = a + _m * _k * (offsets ? offsets[2 * i + 0] : i),
+                 b_ = b + (packedB ? packedSize() : _k * _n) * (offsets ? offsets[2 * i + 1] : i);
+            auto y_ = y + _m * _n * i;
+            auto i0 = ib * _mc, mc = std::min(_mc, _m - i0),
+                 j0 = jb * _nc, nc = std::min(_nc, _n - j0);
+
+            if (!_k) {
+                for (auto r : range(i0, i0 + mc)) {
+                    for (auto c : range(j0, j0 + nc)) {
+                        auto &v = y_[r * _n + c];
+                        v = _beta == T{} ? T{} : static_cast<T>(_beta * v);
+                    }
+                }
+                return;
+            }
+
+            thread_local std::vector<T> bufA, bufB;
+            bufA.resize((mc + mr - 1) / mr * mr * _kc);
+            if (!packedB) { bufB.resize((nc + nr - 1) / nr * nr * _kc); }
+            T tile[MAX_TILE];
+            for (size_t p0 = 0; p0 < _k; p0 += _kc) {
+                auto kc = std::min(_kc, _k - p0);
+                auto beta = p0 ? T{1} : _beta;
+                // 预先打包的 B 中每个面板有 K 行，当前 KC 块从第 p0 行开始
+                auto panels = packedB ? b_ + j0 * _k + p0 * nr : bufB.data();
+                auto panelStride = packedB ? _k * nr : kc * nr;
+                if (!packedB) { packPanelsB(b_ + p0 * rsB + j0 * csB, rsB, csB, kc, nc, nr, bufB.data()); }
+                packPanelsA(a_ + i0 * rsA + p0 * csA, rsA, csA, mc, kc, mr, bufA.data());
+                for (size_t jr = 0; jr < nc; jr += nr) {
+                    auto cols = std::min(nr, nc - jr);
+                    auto pb = panels + jr / nr * panelStride;
+                    for (size_t ir = 0; ir < mc; ir += mr) {
+                        auto rows = std::min(mr, mc - ir);
+                        auto pa = bufA.data() + ir * kc;
+                        auto c = y_ + (i0 + ir) * _n + j0 + jr;
+                        if (cols == nr) {
+                            fn[rows - 1](kc, pa, pb, c, _n, _alpha, beta);
+                            continue;
+                        }
+                        // N 方向的边角先写到临时块，再取有效的列
+                        fn[rows - 1](kc, pa, pb, tile, nr, _alpha, T{});
+                        for (size_t r = 0; r < rows; ++r) {
+                            for (size_t j = 0; j < cols; ++j) {
+                                auto &v = c[r * _n + j];
+                                v = beta == T{} ? tile[r * nr + j] : static_cast<T>(tile[r * nr + j] + beta * v);
+                            }
+                        }
+                    }
+                }
+            }
+        };
+
+        auto tasks = batch * mBlocks * nBlocks;
+        if (tasks > 1 && batch * _m * _n * _k >= PARALLEL_THRESHOLD) {
+            std::for_each_n(std::execution::par, natural_t(0), tasks, task);
+        } else {
+            for (auto t : range0_(tasks)) { task(t); }
+        }
+    }
+
+#define INSTANTIATE(T)                                                          \
+    template std::span<GemmMicroKernel<T> const> gemmMicroKernels<T>() noexcept; \
+    template class CpuGemm<T>;
+
+    INSTANTIATE(float)
+    INSTANTIATE(double)
+    INSTANTIATE(uint8_t)
+    INSTANTIATE(uint16_t)
+    INSTANTIATE(uint32_t)
+    INSTANTIATE(uint64_t)
+    INSTANTIATE(int8_t)
+    INSTANTIATE(int16_t)
+    INSTANTIATE(int32_t)
+    INSTANTIATE(int64_t)
+
+}// namespace refactor::kernel
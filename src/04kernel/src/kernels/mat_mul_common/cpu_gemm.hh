@@ -0,0 +1,62 @@
+#ifndef KERNEL_MATMUL_COMMON_CPU_GEMM_HH
+#define KERNEL_MATMUL_COMMON_CPU_GEMM_HH
+
+#include "common.h"
+#include <span>
+#include <string_view>
+
+namespace refactor::kernel {
+
+    /// @brief 寄存器分块的微内核，计算 `mr` x `nr` 的结果块：
+    ///        C = alpha * Σ_k a[k] ⊗ b[k] + beta * C，
+    ///        `a` 是按 `mr` 行打包的 A 面板，`b` 是按 `nr` 列打包的 B 面板。
+    ///        `fn[r - 1]` 只计算前 r 行，用于 M 方向的边角。beta 为 0 时不读 C。
+    template<class T>
+    struct GemmMicroKernel {
+        using Fn = void (*)(size_t kc, T const *a, T const *b, T *c, size_t ldc, T alpha, T beta) noexcept;
+
+        std::string_view isa;
+        size_t mr, nr;
+        Fn const *fn;
+    };
+
+    /// @brief 当前 CPU 支持的微内核，按性能从高到低排列，最后一个是标量实现。
+    template<class T>
+    std::span<GemmMicroKernel<T> const> gemmMicroKernels() noexcept;
+
+    /// @brief 打包、分块、多线程的矩阵乘：Y = alpha * op(A) @ op(B) + beta * Y。
+    ///        按 NC 列、MC 行把每个结果矩阵分成块，各块在线程间并行，块内按 KC 打包 A 和 B 的面板后调用微内核。
+    template<class T>
+    class CpuGemm {
+        size_t _m, _k, _n;
+        bool _transA, _transB;
+        T _alpha, _beta;
+        GemmMicroKernel<T> _kernel;
+        size_t _mc, _kc, _nc;
+
+    public:
+        /// @brief `kernel` 为空时选择当前 CPU 上最快的微内核。
+        CpuGemm(size_t m, size_t k, size_t n,
+                bool transA, bool transB,
+                T alpha, T beta,
+                GemmMicroKernel<T> const *kernel = nullptr) noexcept;
+
+        auto kernel() const noexcept -> GemmMicroKernel<T> const & { return _kernel; }
+        size_t k() const noexcept { return _k; }
+        size_t n() const noexcept { return _n; }
+        bool transB() const noexcept { return _transB; }
+        /// @brief 一个 B 整体打包后的元素数。
+        size_t packedSize() const noexcept;
+        /// @brief 把一个 B 整体打包成 [⌈N/NR⌉][K][NR]，运行时每个 KC 块都是其中连续的一段，不必再打包。
+        void packB(T const *b, T *dst) const noexcept;
+        /// @brief 计算 `batch` 个矩阵乘。
+        ///        `offsets` 为空时第 i 个乘法使用第 i 个 A 和 B，否则使用第 `offsets[2i]` 个 A 和第 `offsets[2i+1]` 个 B。
+        ///        `packedB` 为 true 时 `b` 是 `packB` 的结果，每个 B 占 `packedSize()` 个元素。
+        void operator()(T const *a, T const *b, T *y,
+                        size_t batch = 1, dim_t const *offsets = nullptr,
+                        bool packedB = false) const;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_MATMUL_COMMON_CPU_GEMM_HH
@@ -0,0 +1,60 @@
+#include "packed_weights.hh"
+#include "kernel/weight_cache.h"
+
+namespace refactor::kernel {
+
+    auto PackedWeights::typeId() noexcept -> size_t {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+    auto PackedWeights::build() noexcept -> runtime::ResourceBox {
+        return std::make_unique<PackedWeights>();
+    }
+
+    auto PackedWeights::resourceTypeId() const noexcept -> size_t {
+        return typeId();
+    }
+    auto PackedWeights::description() const noexcept -> std::string_view {
+        return "PackedWeights";
+    }
+    auto PackedWeights::shareable() const noexcept -> bool {
+        return true;
+    }
+
+    auto PackedWeights::bytes() const noexcept -> size_t {
+        size_t ans = 0;
+        for (auto const &[_, size] : blobs) { ans += size; }
+        return ans;
+    }
+
+    template<class T>
+    T const *packConstB(runtime::Resources &res, CpuGemm<T> const &gemm, Arc<Blob> const &b, size_t count) {
+        auto size = gemm.packedSize() * count * sizeof(T);
+        auto layout = fmt::format("gemm b {} {} {}x{}x{}{}",
+                                  dataType<T>().name(), gemm.kernel().isa,
+                                  count, gemm.k(), gemm.n(), gemm.transB() ? " transposed" : "");
+        auto blob = WeightCache::instance().derive(b, std::move(layout), size, [&](void *dst) {
+            auto src = b->get<T>();
+            auto dst_ = static_cast<T *>(dst);
+            for (auto i : range0_(count)) {
+                gemm.packB(src + i * gemm.k() * gemm.n(), dst_ + i * gemm.packedSize());
+            }
+        });
+        return res.fetchOrStore<PackedWeights>()->hold<T>(std::move(blob), size);
+    }
+
+#define INSTANTIATE(T) \
+    template T const *packConstB<T>(runtime::Resources &, CpuGemm<T> const &, Arc<Blob> const &, size_t);
+
+    INSTANTIATE(float)
+    INSTANTIATE(double)
+    INSTANTIATE(uint8_t)
+    INSTANTIATE(uint16_t)
+    INSTANTIATE(uint32_t)
+    INSTANTIATE(uint64_t)
+    INSTANTIATE(int8_t)
+    INSTANTIATE(int16_t)
+    INSTANTIATE(int32_t)
+    INSTANTIATE(int64_t)
+
+}// namespace refactor::kernel
@@ -0,0 +1,40 @@
+#ifndef KERNEL_MATMUL_COMMON_PACKED_WEIGHTS_HH
+#define KERNEL_MATMUL_COMMON_PACKED_WEIGHTS_HH
+
+#include "cpu_gemm.hh"
+#include "kernel/blob.hh"
+#include "runtime/resource.h"
+#include <vector>
+
+namespace refactor::kernel {
+
+    /// @brief 内核降级时预处理好的常量权重，由流的资源表持有到流释放。
+    ///        运行时只读，分叉出的流共享同一份。
+    struct PackedWeights final : public runtime::Resource {
+        std::vector<std::pair<Arc<Blob>, size_t>> blobs;
+
+        static size_t typeId() noexcept;
+        static runtime::ResourceBox build() noexcept;
+
+        size_t resourceTypeId() const noexcept final;
+        std::string_view description() const noexcept final;
+        bool shareable() const noexcept final;
+
+        /// @brief 持有 `size` 字节的 `blob` 直到资源表释放。
+        template<class T> T const *hold(Arc<Blob> blob, size_t size) {
+            auto ans = blob->get<T>();
+            blobs.emplace_back(std::move(blob), size);
+            return ans;
+        }
+        /// @brief 持有的字节数。
+        size_t bytes() const noexcept;
+    };
+
+    /// @brief 把常量 `b` 中连续的 `count` 个 B 按 `gemm` 的布局打包，运行时不再打包。
+    ///        打包的副本由权重缓存在进程内共享，重新降级的流直接复用；流通过资源表持有它，分叉出的流共享资源表。
+    template<class T>
+    T const *packConstB(runtime::Resources &, CpuGemm<T> const &gemm, Arc<Blob> const &b, size_t count);
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_MATMUL_COMMON_PACKED_WEIGHTS_HH
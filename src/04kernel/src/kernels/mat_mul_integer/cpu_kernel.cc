@@ -22,6 +22,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing MatMulInteger using CPU";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
     template<class T> static int8_t sub(T, T);
     template<> int8_t sub<int8_t>(int8_t a, int8_t b) { return a - b; }
@@ -0,0 +1,310 @@
+#include "cpu_kernel.hh"
+#include "cpu_pool_op.hh"
+#include <execution>
+
+namespace refactor::kernel {
+    using K = PoolCpu;
+    using DT = DataType;
+    using Info = decltype(K::info);
+
+    K::PoolCpu(decltype(info) info_) noexcept
+        : Kernel(), info(std::move(info_)) {}
+
+    // 按 ONNX 的规则计算一维上的输出尺寸
+    static sdim_t outputSize(sdim_t in, sdim_t k, sdim_t d, sdim_t s, sdim_t pb, sdim_t pe, bool ceil) {
+        auto span = in + pb + pe - (k - 1) * d - 1;
+        if (span < 0) {
+            return -1;
+        }
+        auto ans = (ceil ? span + s - 1 : span) / s + 1;
+        // 向上取整时，最后一个窗口必须从输入或开头的填充内开始
+        if (ceil && (ans - 1) * s >= in + pb) {
+            --ans;
+        }
+        return ans;
+    }
+
+    auto K::build(PoolType type,
+                  bool ceil,
+                  bool countIncludePad,
+                  int64_t p,
+                  KernelShape const &kernelShape,
+                  PoolAttributes const &poolAttributes,
+                  Tensor const &x,
+                  Tensor const &y) noexcept -> KernelBox {
+        auto dt = x.dataType;
+        if ((dt != DT::F32 && dt != DT::F64) || y.dataType != dt) {
+            return nullptr;
+        }
+        if (type == PoolType::Lp && p <= 0) {
+            return nullptr;
+        }
+        auto rank = kernelShape.size();
+        if ((rank != 1 && rank != 2) || poolAttributes.rank() != rank ||
+            x.rank() != static_cast<int64_t>(rank + 2) || y.rank() != x.rank()) {
+            return nullptr;
+        }
+        // 布局变换后 X 是 [N,H,W,C]，Y 是 [N,Ho,Wo,C]
+        auto nhwc = x.layout == LayoutType::NHWC;
+        if (nhwc && rank != 2) {
+            return nullptr;
+        }
+
+        // 1D 池化按 H 为 1 的 2D 池化计算
+        auto first = nhwc ? 1 : 2;
+        auto height = [=](Tensor const &t) { return rank == 2 ? t.shape[first] : 1; };
+        auto width = [=](Tensor const &t) { return t.shape[first + rank - 1]; };
+        auto channel = [=](Tensor const &t) { return t.shape[nhwc ? 3 : 1]; };
+
+        Info info{type, dt, nhwc, countIncludePad, p};
+        info.n = x.shape[0];
+        info.c = channel(x);
+        info.h = height(x);
+        info.w = width(x);
+        info.kh = rank == 2 ? kernelShape[0] : 1;
+        info.kw = kernelShape[rank - 1];
+        info.ho = height(y);
+        info.wo = width(y);
+        if (y.shape[0] != info.n || channel(y) != info.c) {
+            return nullptr;
+        }
+
+        auto d = poolAttributes.dilations(),
+             pb = poolAttributes.padsBegin(),
+             pe = poolAttributes.padsEnd(),
+             s = poolAttributes.strides();
+        auto r = rank - 1;
+        info.dilation[0] = r ? d[0] : 1;
+        info.dilation[1] = d[r];
+        info.stride[0] = r ? s[0] : 1;
+        info.stride[1] = s[r];
+        info.padBegin[0] = r ? pb[0] : 0;
+        info.padBegin[1] = pb[r];
+        info.padEnd[0] = r ? pe[0] : 0;
+        info.padEnd[1] = pe[r];
+        // 输出尺寸已经由 Y 确定，这里只检查它与参数一致
+        for (auto i : range0_(2)) {
+            auto in = i ? info.w : info.h,
+                 k = i ? info.kw : info.kh,
+                 out = i ? info.wo : info.ho;
+            if (outputSize(in, k, info.dilation[i], info.stride[i], info.padBegin[i], info.padEnd[i], ceil) != static_cast<sdim_t>(out)) {
+                return nullptr;
+            }
+        }
+        return std::make_unique<K>(info);
+    }
+
+    auto K::typeId() noexcept -> size_t {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+
+    auto K::kernelTypeId() const noexcept -> size_t { return typeId(); }
+    auto K::description() const noexcept -> std::string_view {
+        return "Performing pool using CPU";
+    }
+    auto K::cost() const noexcept -> KernelCost {
+        // 每个输出元素对窗口中每个元素做一次比较或累加
+        auto outputs = static_cast<size_t>(info.n) * info.c * info.ho * info.wo;
+        return {outputs * info.kh * info.kw, 0, 0};
+    }
+
+    // 一维上每个输出位置的窗口覆盖的元素数，用于求平均；
+    // 包含填充时以填充后的边界截断，否则以输入的边界截断
+    static std::vector<dim_t> windowCounts(Info const &info, int i) {
+        sdim_t in = i ? info.w : info.h,
+               k = i ? info.kw : info.kh,
+               out = i ? info.wo : info.ho,
+               d = info.dilation[i],
+               s = info.stride[i],
+               pb = info.padBegin[i],
+               pe = info.padEnd[i];
+        auto lo = info.countIncludePad ? -pb : 0,
+             hi = info.countIncludePad ? in + pe : in;
+        std::vector<dim_t> ans(out);
+        for (auto o : range0_(out)) {
+            auto start = o * s - pb;
+            for (auto t : range0_(k)) {
+                auto pos = start + t * d;
+                ans[o] += lo <= pos && pos < hi;
+            }
+        }
+        return ans;
+    }
+
+    // 窗口第 j 个位置在输出宽度上与输入相交的区间 [begin, end)
+    static std::vector<std::pair<sdim_t, sdim_t>> validRanges(Info const &info) {
+        std::vector<std::pair<sdim_t, sdim_t>> ans(info.kw);
+        sdim_t s = info.stride[1],
+               w = info.w;
+        for (auto j : range0_(info.kw)) {
+            sdim_t off = j * info.dilation[1] - info.padBegin[1];
+            sdim_t begin = off >= 0 ? 0 : (s - 1 - off) / s,
+                   end = w - 1 - off >= 0 ? (w - 1 - off) / s + 1 : 0;
+            begin = std::min<sdim_t>(begin, info.wo);
+            ans[j] = {begin, std::clamp<sdim_t>(end, begin, info.wo)};
+        }
+        return ans;
+    }
+
+    // 第 ow 个输出的窗口中落在输入宽度内的位置区间 [begin, end)
+    static std::vector<std::pair<sdim_t, sdim_t>> tapRanges(Info const &info) {
+        std::vector<std::pair<sdim_t, sdim_t>> ans(info.wo);
+        sdim_t d = info.dilation[1],
+               w = info.w,
+               kw = info.kw;
+        for (auto ow : range0_(info.wo)) {
+            sdim_t start = static_cast<sdim_t>(ow) * info.stride[1] - info.padBegin[1];
+            sdim_t begin = start >= 0 ? 0 : (d - 1 - start) / d,
+                   end = w - 1 - start >= 0 ? (w - 1 - start) / d + 1 : 0;
+            begin = std::min(begin, kw);
+            ans[ow] = {begin, std::clamp(end, begin, kw)};
+        }
+        return ans;
+    }
+
+    // 输出行短于此长度时逐个输出元素遍历窗口，否则窗口的每个位置进出一次内层循环的开销无法摊薄
+    constexpr static dim_t ROW_MIN = 16;
+
+    template<PoolOp OP, class T>
+    static Routine lowerNchw(Info const &info) {
+        using namespace runtime;
+
+        auto countH = windowCounts(info, 0),
+             countW = windowCounts(info, 1);
+        auto narrow = info.wo < ROW_MIN;
+        auto ranges = narrow ? tapRanges(info) : validRanges(info);
+        return [info, narrow, countH = std::move(countH), countW = std::move(countW), ranges = std::move(ranges)]//
+            (Resources &, void *, void const *const *inputs, void *const *outputs) {
+                auto x = reinterpret_cast<T const *>(inputs[0]);
+                auto y = reinterpret_cast<T *>(outputs[0]);
+                auto p = static_cast<T>(info.p);
+                sdim_t h = info.h, sh = info.stride[0], sw = info.stride[1];
+                // 每个线程处理一个通道平面，输出行足够长时窗口的每个位置对一整行输出做逐元素的累加
+                std::for_each_n(
+                    std::execution::par_unseq,
+                    natural_t(0), info.n * info.c,
+                    [&](auto plane) {
+                        auto x_ = x + plane * info.h * info.w;
+                        auto y_ = y + plane * info.ho * info.wo;
+                        for (auto oh : range0_(info.ho)) {
+                            auto yRow = y_ + oh * info.wo;
+                            if (narrow) {
+                                for (auto ow : range0_(info.wo)) {
+                                    auto [begin, end] = ranges[ow];
+                                    sdim_t start = static_cast<sdim_t>(ow) * sw - info.padBegin[1];
+                                    auto acc = poolInit<OP, T>();
+                                    for (auto i : range0_(info.kh)) {
+                                        sdim_t ih = static_cast<sdim_t>(oh) * sh - info.padBegin[0] + i * info.dilation[0];
+                                        if (ih < 0 || h <= ih) { continue; }
+                                        auto xRow = x_ + ih * info.w;
+                                        for (auto j = begin; j < end; ++j) {
+                                            acc = poolAccumulate<OP>(acc, xRow[start + j * info.dilation[1]], p);
+                                        }
+                                    }
+                                    yRow[ow] = acc;
+                                }
+                            } else {
+                                std::fill_n(yRow, info.wo, poolInit<OP, T>());
+                                for (auto i : range0_(info.kh)) {
+                                    sdim_t ih = static_cast<sdim_t>(oh) * sh - info.padBegin[0] + i * info.dilation[0];
+                                    if (ih < 0 || h <= ih) { continue; }
+                                    auto xRow = x_ + ih * info.w;
+                                    for (auto j : range0_(info.kw)) {
+                                        auto [begin, end] = ranges[j];
+                                        sdim_t off = j * info.dilation[1] - info.padBegin[1];
+                                        if (sw == 1) {
+                                            for (auto ow = begin; ow < end; ++ow) {
+                                                yRow[ow] = poolAccumulate<OP>(yRow[ow], xRow[ow + off], p);
+                                            }
+                                        } else {
+                                            for (auto ow = begin; ow < end; ++ow) {
+                                                yRow[ow] = poolAccumulate<OP>(yRow[ow], xRow[ow * sw + off], p);
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                            if constexpr (OP != PoolOp::Max) {
+                                for (auto ow : range0_(info.wo)) {
+                                    auto count = static_cast<T>(countH[oh] * countW[ow]);
+                                    yRow[ow] = poolFinish<OP>(yRow[ow], count, p);
+                                }
+                            }
+                        }
+                    });
+            };
+    }
+
+    template<PoolOp OP, class T>
+    static Routine lowerNhwc(Info const &info) {
+        using namespace runtime;
+
+        auto countH = windowCounts(info, 0),
+             countW = windowCounts(info, 1);
+        return [info, countH = std::move(countH), countW = std::move(countW)]//
+            (Resources &, void *, void const *const *inputs, void *const *outputs) {
+                auto x = reinterpret_cast<T const *>(inputs[0]);
+                auto y = reinterpret_cast<T *>(outputs[0]);
+                auto p = static_cast<T>(info.p);
+                sdim_t h = info.h, w = info.w;
+                auto c = static_cast<size_t>(info.c);
+                // 每个线程处理一行输出，窗口的每个位置对一个像素的所有通道做逐元素的累加
+                std::for_each_n(
+                    std::execution::par_unseq,
+                    natural_t(0), info.n * info.ho,
+                    [&](auto row) {
+                        auto image = row / info.ho;
+                        sdim_t oh = row % info.ho;
+                        auto x_ = x + image * info.h * info.w * c;
+                        for (auto ow : range0_(info.wo)) {
+                            auto yPix = y + (row * info.wo + ow) * c;
+                            std::fill_n(yPix, c, poolInit<OP, T>());
+                            for (auto i : range0_(info.kh)) {
+                                sdim_t ih = oh * info.stride[0] - info.padBegin[0] + i * info.dilation[0];
+                                if (ih < 0 || h <= ih) { continue; }
+                                for (auto j : range0_(info.kw)) {
+                                    sdim_t iw = static_cast<sdim_t>(ow) * info.stride[1] - info.padBegin[1] + j * info.dilation[1];
+                                    if (iw < 0 || w <= iw) { continue; }
+                                    auto xPix = x_ + (ih * w + iw) * c;
+                                    for (auto k : range0_(c)) {
+                                        yPix[k] = poolAccumulate<OP>(yPix[k], xPix[k], p);
+                                    }
+                                }
+                            }
+                            if constexpr (OP != PoolOp::Max) {
+                                auto count = static_cast<T>(countH[oh] * countW[ow]);
+                                for (auto k : range0_(c)) {
+                                    yPix[k] = poolFinish<OP>(yPix[k], count, p);
+                                }
+                            }
+                        }
+                    });
+            };
+    }
+
+    template<class T>
+    static Routine lowerTyped(Info const &info) {
+#define CASE(OP)                                                               \
+    case PoolOp::OP:                                                           \
+        return info.nhwc ? lowerNhwc<PoolOp::OP, T>(info) : lowerNchw<PoolOp::OP, T>(info)
+
+        switch (poolOp(info.type, info.p)) {
+            CASE(Max);
+            CASE(Average);
+            CASE(L1);
+            CASE(L2);
+            CASE(Lp);
+            default:
+                UNREACHABLE();
+        }
+#undef CASE
+    }
+
+    auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
+        return info.dt == DT::F32
+                   ? lowerTyped<float>(info)
+                   : lowerTyped<double>(info);
+    }
+
+}// namespace refactor::kernel
@@ -0,0 +1,42 @@
+#ifndef KERNEL_POOL_CPU_KERNEL_HH
+#define KERNEL_POOL_CPU_KERNEL_HH
+
+#include "kernel/attributes/pool_attributes.h"
+#include "kernel/kernel.h"
+#include "kernel/tensor.h"
+
+namespace refactor::kernel {
+
+    /// @brief 支持 1D 和 2D 的最大、平均和 Lp 池化，NCHW 和 NHWC 布局，膨胀、步长、填充和向上取整。
+    struct PoolCpu final : public Kernel {
+        struct {
+            PoolType type;
+            DataType dt;
+            bool nhwc, countIncludePad;
+            int64_t p;
+            dim_t n, c, h, w,
+                kh, kw, ho, wo;
+            ddim_t dilation[2], stride[2], padBegin[2], padEnd[2];
+        } info;
+
+        explicit PoolCpu(decltype(info)) noexcept;
+
+        static KernelBox build(PoolType,
+                               bool ceil,
+                               bool countIncludePad,
+                               int64_t p,
+                               KernelShape const &,
+                               PoolAttributes const &,
+                               Tensor const &,
+                               Tensor const &) noexcept;
+        static size_t typeId() noexcept;
+
+        size_t kernelTypeId() const noexcept final;
+        std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
+        RoutineWorkspace lower(Resources &) const noexcept final;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_POOL_CPU_KERNEL_HH
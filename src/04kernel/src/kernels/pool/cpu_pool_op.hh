@@ -0,0 +1,82 @@
+#ifndef KERNEL_POOL_CPU_POOL_OP_HH
+#define KERNEL_POOL_CPU_POOL_OP_HH
+
+#include "kernel/attributes/pool_attributes.h"
+#include <cmath>
+#include <limits>
+
+namespace refactor::kernel {
+
+    /// @brief 池化窗口内的归约方式。
+    ///        编译期确定，使最内层循环不含分支，可以向量化。
+    enum class PoolOp : uint8_t {
+        /// @brief 取最大值。
+        Max,
+        /// @brief 求和后除以计数。
+        Average,
+        /// @brief p=1 的 Lp 池化，绝对值求和。
+        L1,
+        /// @brief p=2 的 Lp 池化，平方和开方。
+        L2,
+        /// @brief 一般的 Lp 池化，|x|^p 求和后开 p 次方。
+        Lp,
+    };
+
+    constexpr PoolOp poolOp(PoolType type, int64_t p) noexcept {
+        switch (type) {
+            case PoolType::Max:
+                return PoolOp::Max;
+            case PoolType::Average:
+                return PoolOp::Average;
+            default:
+                return p == 1 ? PoolOp::L1 : p == 2 ? PoolOp::L2
+                                                    : PoolOp::Lp;
+        }
+    }
+
+    template<PoolOp OP, class T>
+    constexpr T poolInit() noexcept {
+        return OP == PoolOp::Max ? std::numeric_limits<T>::lowest() : T{};
+    }
+
+    template<PoolOp OP, class T>
+    inline T poolAccumulate(T acc, T x, T p) noexcept {
+        if constexpr (OP == PoolOp::Max) {
+            return x > acc ? x : acc;
+        } else if constexpr (OP == PoolOp::Average) {
+            return acc + x;
+        } else if constexpr (OP == PoolOp::L1) {
+            return acc + std::abs(x);
+        } else if constexpr (OP == PoolOp::L2) {
+            return acc + x * x;
+        } else {
+            return acc + std::pow(std::abs(x), p);
+        }
+    }
+
+    /// @brief 把多路累加器的部分结果合并。
+    template<PoolOp OP, class T>
+    inline T poolCombine(T a, T b) noexcept {
+        if constexpr (OP == PoolOp::Max) {
+            return b > a ? b : a;
+        } else {
+            return a + b;
+        }
+    }
+
+    template<PoolOp OP, class T>
+    inline T poolFinish(T acc, T count, T p) noexcept {
+        if constexpr (OP == PoolOp::Average) {
+            return acc / count;
+        } else if constexpr (OP == PoolOp::L2) {
+            return std::sqrt(acc);
+        } else if constexpr (OP == PoolOp::Lp) {
+            return std::pow(acc, 1 / p);
+        } else {
+            return acc;
+        }
+    }
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_POOL_CPU_POOL_OP_HH
@@ -14,6 +14,7 @@ namespace refactor::kernel {
 
     auto K::build(PoolType poolType,
                   bool ceil,
+                  bool countIncludePad,
                   KernelShape const &kernelShape,
                   PoolAttributes const &poolAttributes,
                   Tensor const &x,
@@ -31,9 +32,21 @@ namespace refactor::kernel {
             d[0] != 1 || d[1] != 1) {
             return nullptr;
         }
+        // cudnn 按向下取整计算输出的大小，向上取整时多出的窗口不支持
+        if (ceil) {
+            for (auto i : range0_(2)) {
+                auto out = (static_cast<int64_t>(x.shape[i + 2]) + p[i] + p[i + 2] - kernelShape[i]) / s[i] + 1;
+                if (y.shape[i + 2] != out) { return nullptr; }
+            }
+        }
+        // 不对称的填充先显式补 0 再池化，只有计入填充的平均池化结果不受影响
+        if ((p[0] != p[2] || p[1] != p[3]) && (poolType != PoolType::Average || !countIncludePad)) {
+            return nullptr;
+        }
         return std::make_unique<K>(decltype(info){
             poolType,
             x.dataType,
+            countIncludePad,
             {
                 static_cast<int>(x.shape[0]),
                 static_cast<int>(x.shape[1]),
@@ -107,9 +120,10 @@ namespace refactor::kernel {
         setCudnnTensor(d->y, info.dt, slice(ys, 4));
 
         // clang-format off
-        auto mode = info.poolType == Ty::Average ? CUDNN_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING
-                  : info.poolType == Ty::Max     ? CUDNN_POOLING_MAX
-                                                 : UNREACHABLEX(cudnnPoolingMode_t, "");
+        auto mode = info.poolType == Ty::Max ? CUDNN_POOLING_MAX
+                  : info.poolType != Ty::Average ? UNREACHABLEX(cudnnPoolingMode_t, "")
+                  : info.countIncludePad         ? CUDNN_POOLING_AVERAGE_COUNT_INCLUDE_PADDING
+                                                 : CUDNN_POOLING_AVERAGE_COUNT_EXCLUDE_PADDING;
         // clang-format on
         auto pp = info.pads;
         auto ss = info.strides;
@@ -14,6 +14,7 @@ namespace refactor::kernel {
         {
             PoolType poolType;
             DataType dt;
+            bool countIncludePad;
             int xShape[4],
                 yShape[4],
                 kernelShape[2],
@@ -24,7 +25,8 @@ namespace refactor::kernel {
         explicit PoolCudnn(decltype(info)) noexcept;
 
         static KernelBox build(PoolType,
-                               bool,
+                               bool ceil,
+                               bool countIncludePad,
                                KernelShape const &,
                                PoolAttributes const &,
                                Tensor const &,
@@ -0,0 +1,152 @@
+#include "global_cpu_kernel.hh"
+#include "cpu_pool_op.hh"
+#include <execution>
+#include <numeric>
+
+namespace refactor::kernel {
+    using K = GlobalPoolCpu;
+    using DT = DataType;
+    using Info = decltype(K::info);
+
+    K::GlobalPoolCpu(decltype(info) info_) noexcept
+        : Kernel(), info(std::move(info_)) {}
+
+    auto K::build(PoolType type, int64_t p, Tensor const &x, Tensor const &y) noexcept -> KernelBox {
+        auto dt = x.dataType;
+        if ((dt != DT::F32 && dt != DT::F64) || y.dataType != dt) {
+            return nullptr;
+        }
+        if (type == PoolType::Lp && p <= 0) {
+            return nullptr;
+        }
+        auto rank = x.rank();
+        if (rank < 2 || y.rank() != rank) {
+            return nullptr;
+        }
+        // 布局变换后 X 是 [N,H,W,C]，Y 是 [N,1,1,C]
+        auto nhwc = x.layout == LayoutType::NHWC;
+        if (nhwc && rank != 4) {
+            return nullptr;
+        }
+        auto channelAxis = nhwc ? rank - 1 : 1;
+        Info info{type, dt, nhwc, p, x.shape[0], x.shape[channelAxis], 1};
+        for (auto i : range(1l, rank)) {
+            if (i != channelAxis) {
+                info.hw *= x.shape[i];
+            }
+        }
+        if (y.elementsSize() != static_cast<size_t>(info.n) * info.c) {
+            return nullptr;
+        }
+        return std::make_unique<K>(info);
+    }
+
+    auto K::typeId() noexcept -> size_t {
+        static uint8_t ID = 1;
+        return reinterpret_cast<size_t>(&ID);
+    }
+
+    auto K::kernelTypeId() const noexcept -> size_t { return typeId(); }
+    auto K::description() const noexcept -> std::string_view {
+        return "Performing global pool using CPU";
+    }
+    auto K::cost() const noexcept -> KernelCost {
+        return {static_cast<size_t>(info.n) * info.c * info.hw, 0, 0};
+    }
+
+    template<PoolOp OP, class T>
+    static Routine lowerNchw(Info const &info) {
+        using namespace runtime;
+
+        return [info](Resources &, void *, void const *const *inputs, void *const *outputs) {
+            auto x = reinterpret_cast<T const *>(inputs[0]);
+            auto y = reinterpret_cast<T *>(outputs[0]);
+            auto p = static_cast<T>(info.p);
+            auto hw = static_cast<size_t>(info.hw);
+            // 每个通道平面是连续的，用多路累加器打破归约的依赖链，使循环可以向量化
+            constexpr static size_t LANES = 16;
+            std::for_each_n(
+                std::execution::par_unseq,
+                natural_t(0), info.n * info.c,
+                [=](auto plane) {
+                    auto x_ = x + plane * hw;
+                    T acc[LANES];
+                    std::fill_n(acc, LANES, poolInit<OP, T>());
+                    size_t i = 0;
+                    for (; i + LANES <= hw; i += LANES) {
+                        for (auto j : range0_(LANES)) {
+                            acc[j] = poolAccumulate<OP>(acc[j], x_[i + j], p);
+                        }
+                    }
+                    for (; i < hw; ++i) {
+                        acc[0] = poolAccumulate<OP>(acc[0], x_[i], p);
+                    }
+                    auto ans = std::accumulate(acc + 1, acc + LANES, acc[0], poolCombine<OP, T>);
+                    y[plane] = poolFinish<OP>(ans, static_cast<T>(hw), p);
+                });
+        };
+    }
+
+    template<PoolOp OP, class T>
+    static Routine lowerNhwc(Info const &info) {
+        using namespace runtime;
+
+        return [info](Resources &, void *, void const *const *inputs, void *const *outputs) {
+            auto x = reinterpret_cast<T const *>(inputs[0]);
+            auto y = reinterpret_cast<T *>(outputs[0]);
+            auto p = static_cast<T>(info.p);
+            auto c = static_cast<size_t>(info.c),
+                 hw = static_cast<size_t>(info.hw);
+            // 通道按块划分给线程，每个像素的一段通道逐元素累加到输出上
+            constexpr static size_t BLOCK = 64;
+            auto blocks = (c + BLOCK - 1) / BLOCK;
+            std::for_each_n(
+                std::execution::par_unseq,
+                natural_t(0), info.n * blocks,
+                [=](auto task) {
+                    auto image = task / blocks,
+                         c0 = task % blocks * BLOCK,
+                         len = std::min(BLOCK, c - c0);
+                    auto x_ = x + image * hw * c + c0;
+                    auto y_ = y + image * c + c0;
+                    std::fill_n(y_, len, poolInit<OP, T>());
+                    for (auto i : range0_(hw)) {
+                        auto xPix = x_ + i * c;
+                        for (auto k : range0_(len)) {
+                            y_[k] = poolAccumulate<OP>(y_[k], xPix[k], p);
+                        }
+                    }
+                    if constexpr (OP != PoolOp::Max) {
+                        for (auto k : range0_(len)) {
+                            y_[k] = poolFinish<OP>(y_[k], static_cast<T>(hw), p);
+                        }
+                    }
+                });
+        };
+    }
+
+    template<class T>
+    static Routine lowerTyped(Info const &info) {
+#define CASE(OP)                                                               \
+    case PoolOp::OP:                                                           \
+        return info.nhwc ? lowerNhwc<PoolOp::OP, T>(info) : lowerNchw<PoolOp::OP, T>(info)
+
+        switch (poolOp(info.type, info.p)) {
+            CASE(Max);
+            CASE(Average);
+            CASE(L1);
+            CASE(L2);
+            CASE(Lp);
+            default:
+                UNREACHABLE();
+        }
+#undef CASE
+    }
+
+    auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
+        return info.dt == DT::F32
+                   ? lowerTyped<float>(info)
+                   : lowerTyped<double>(info);
+    }
+
+}// namespace refactor::kernel
@@ -0,0 +1,33 @@
+#ifndef KERNEL_POOL_GLOBAL_CPU_KERNEL_HH
+#define KERNEL_POOL_GLOBAL_CPU_KERNEL_HH
+
+#include "kernel/attributes/pool_attributes.h"
+#include "kernel/kernel.h"
+#include "kernel/tensor.h"
+
+namespace refactor::kernel {
+
+    /// @brief 全局池化，每个通道在所有空间位置上归约成一个值，支持 NCHW 和 NHWC 布局。
+    struct GlobalPoolCpu final : public Kernel {
+        struct {
+            PoolType type;
+            DataType dt;
+            bool nhwc;
+            int64_t p;
+            dim_t n, c, hw;
+        } info;
+
+        explicit GlobalPoolCpu(decltype(info)) noexcept;
+
+        static KernelBox build(PoolType, int64_t p, Tensor const &, Tensor const &) noexcept;
+        static size_t typeId() noexcept;
+
+        size_t kernelTypeId() const noexcept final;
+        std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
+        RoutineWorkspace lower(Resources &) const noexcept final;
+    };
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_POOL_GLOBAL_CPU_KERNEL_HH
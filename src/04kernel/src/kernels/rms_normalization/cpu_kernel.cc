@@ -34,6 +34,10 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing rms normalization on generic cpu";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        // 平方、累加、乘倒数、乘权重
+        return {static_cast<size_t>(blockCount) * blockSize * 4, 0, 0};
+    }
 
     template<class T>
     static Routine lowerTyped(float epsilon, dim_t blockCount, dim_t blockSize) {
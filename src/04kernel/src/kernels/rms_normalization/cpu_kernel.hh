@@ -22,6 +22,7 @@ namespace refactor::kernel {
 
         size_t kernelTypeId() const noexcept final;
         std::string_view description() const noexcept final;
+        KernelCost cost() const noexcept final;
         RoutineWorkspace lower(Resources &) const noexcept final;
     };
 
@@ -43,6 +43,10 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing rms normalization using CUDA";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        // 平方、累加、乘倒数、乘权重
+        return {static_cast<size_t>(blockCount) * blockSize * 4, 0, 0};
+    }
 
 #ifdef USE_CUDA
 
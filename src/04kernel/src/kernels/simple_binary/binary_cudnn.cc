@@ -1,4 +1,5 @@
 #include "binary_cudnn.hh"
+#include <numeric>
 #include <unordered_set>
 
 #ifdef USE_CUDA
@@ -57,6 +58,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing element-wise op of 2 tensors with CUDNN";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {std::accumulate(cDims.begin(), cDims.end(), size_t(1), std::multiplies<size_t>()), 0, 0};
+    }
 
 #ifdef USE_CUDA
 
@@ -29,6 +29,17 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing binary operation of 2 tensors on generic cpu";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {broadcaster.outputsCount, 0, 0};
+    }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        // 只有与输出形状相同的输入可以被覆盖，被广播的输入会被多次读取
+        std::vector<count_t> ans;
+        for (auto i : range0_(broadcaster.inputsCount)) {
+            if (!broadcaster.needBroadcast(i)) { ans.push_back(i); }
+        }
+        return ans;
+    }
 
 #define CASE_DT(OP, T)                                             \
     case DT::T:                                                    \
@@ -36,6 +36,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing binary operation of 2 tensors on Nvidai GPU";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {broadcaster.outputsCount, 0, 0};
+    }
 
 #ifdef USE_CUDA
 
@@ -37,6 +37,12 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing unary operation on generic cpu";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {size, 0, 0};
+    }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        return {0};
+    }
 
     template<class T> auto relu(T x) noexcept -> T { return x > 0 ? x : 0; }
     template<class T> auto sigmoid(T x) noexcept -> T {
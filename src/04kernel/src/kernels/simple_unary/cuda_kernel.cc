@@ -47,6 +47,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing unary operation on Nvidia GPU";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {size, 0, 0};
+    }
 
 #ifdef USE_CUDA
 
@@ -36,6 +36,13 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing activation using CUDNN";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {static_cast<size_t>(size), 0, 0};
+    }
+    auto K::inplace() const noexcept -> std::vector<count_t> {
+        // cudnnActivationForward 允许 x 与 y 指向同一块存储
+        return {0};
+    }
 
 #ifdef USE_CUDA
 
@@ -21,6 +21,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing slice operation on generic cpu";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
     auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
         using namespace runtime;
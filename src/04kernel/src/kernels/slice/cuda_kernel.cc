@@ -24,5 +24,8 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing slice operation using CUDA";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
 }// namespace refactor::kernel
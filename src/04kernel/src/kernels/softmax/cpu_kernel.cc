@@ -23,6 +23,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing Softmax using CPU";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
     template<class T>
     static Routine lowerTyped(SoftmaxInfo info) {
@@ -25,5 +25,8 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing Softmax using CUDA";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return info.cost();
+    }
 
 }// namespace refactor::kernel
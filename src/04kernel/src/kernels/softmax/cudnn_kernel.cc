@@ -31,6 +31,9 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing softmax forward with CUDNN";
     }
+    auto K::cost() const noexcept -> KernelCost {
+        return {static_cast<size_t>(pre) * mid * post * 5, 0, 0};
+    }
 
 #ifdef USE_CUDA
 
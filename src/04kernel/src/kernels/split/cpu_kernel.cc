@@ -21,9 +21,26 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing split operation on generic cpu";
     }
+    auto K::subBuffers() const noexcept -> runtime::SubBuffers {
+        if (auto offsets = info.contiguousOffsets(); !offsets.empty()) {
+            return {runtime::SubBuffers::Side::Outputs, std::move(offsets)};
+        }
+        return {};
+    }
 
     auto K::lower(Resources &) const noexcept -> RoutineWorkspace {
         using namespace runtime;
+        if (info.blockCount == 1) {
+            return [info = this->info](Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
+                auto src = reinterpret_cast<uint8_t const *>(inputs[0]);
+                for (auto j : range0_(info.segments.size())) {
+                    auto len = info.segments[j];
+                    // 内存规划已经把输出放在输入中的对应位置上时不必复制
+                    if (outputs[j] != src) { std::memcpy(outputs[j], src, len); }
+                    src += len;
+                }
+            };
+        }
         return [info = this->info](Resources &, void *workspace, void const *const *inputs, void *const *outputs) {
             auto src = reinterpret_cast<uint8_t const *>(inputs[0]);
             std::for_each_n(std::execution::par_unseq,
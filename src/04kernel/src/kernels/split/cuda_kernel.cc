@@ -31,6 +31,12 @@ namespace refactor::kernel {
     auto K::description() const noexcept -> std::string_view {
         return "Performing concat operation using CUDA";
     }
+    auto K::subBuffers() const noexcept -> runtime::SubBuffers {
+        if (auto offsets = info.contiguousOffsets(); !offsets.empty()) {
+            return {runtime::SubBuffers::Side::Outputs, std::move(offsets)};
+        }
+        return {};
+    }
 
 #ifdef USE_CUDA
 
@@ -65,7 +71,9 @@ extern "C" __global__ void kernel(
                 auto src = reinterpret_cast<uint8_t const *>(inputs[0]);
                 for (auto i : range0_(info.segments.size())) {
                     auto size = info.segments[i];
-                    cudaMemcpyAsync(outputs[i], src, size, cudaMemcpyDeviceToDevice);
+                    if (outputs[i] != src) {
+                        cudaMemcpyAsync(outputs[i], src, size, cudaMemcpyDeviceToDevice);
+                    }
                     src += size;
                 }
             };
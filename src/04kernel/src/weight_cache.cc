@@ -0,0 +1,210 @@
+﻿#include "kernel/weight_cache.h"
+
+namespace refactor::kernel {
+    using DeviceBlob = Arc<hardware::Device::Blob>;
+
+    size_t WeightCache::KeyHash::operator()(Key const &key) const noexcept {
+        auto hd = std::hash<void const *>()(key.device),
+             hb = std::hash<void const *>()(key.data);
+        return hd ^ (hb << 1);
+    }
+
+    size_t WeightCache::DerivedKeyHash::operator()(DerivedKey const &key) const noexcept {
+        auto hd = std::hash<void const *>()(key.data),
+             hl = std::hash<std::string>()(key.layout);
+        return hd ^ (hl << 1);
+    }
+
+    WeightCache::WeightCache()
+        : _mutex(),
+          _entries(),
+          _derived(),
+          _pinned(),
+          _models(),
+          _pinnedBytes(0),
+          _budget(0),
+          _hits(0),
+          _misses(0),
+          _evictions(0),
+          _sweepMark(0) {}
+
+    WeightCache &WeightCache::instance() {
+        static WeightCache instance;
+        return instance;
+    }
+
+    DeviceBlob WeightCache::fetch(
+        Arc<hardware::Device> const &device,
+        Arc<Blob> const &data,
+        size_t size,
+        std::string_view model) {
+
+        Key key{device.get(), data.get()};
+        auto use = [&](Entry &entry, DeviceBlob blob) {
+            pin(entry, key, blob);
+            if (!model.empty()) {
+                _models[std::string(model)].insert_or_assign(key, Use{blob, entry.size});
+            }
+            return blob;
+        };
+        auto find = [&]() -> Entry * {
+            auto it = _entries.find(key);
+            if (it == _entries.end()) { return nullptr; }
+            // 权重已被释放而地址被复用，副本不再有效
+            if (it->second.source.owner_before(data) || data.owner_before(it->second.source)) {
+                if (it->second.pin != _pinned.end()) {
+                    _pinnedBytes -= it->second.size;
+                    _pinned.erase(it->second.pin);
+                }
+                _entries.erase(it);
+                return nullptr;
+            }
+            return &it->second;
+        };
+
+        {
+            std::lock_guard lock(_mutex);
+            if (auto entry = find(); entry) {
+                if (auto blob = entry->blob.lock(); blob) {
+                    ++_hits;
+                    return use(*entry, std::move(blob));
+                }
+            }
+            ++_misses;
+        }
+
+        // 复制在锁外进行，多个线程可以同时为不同的模型准备权重
+        DeviceBlob blob;
+        if (data->mapped() && device->type() == hardware::Device::Type::Cpu) {
+            // 文件映射直接作为 CPU 上的权重，页面按需载入，不再复制
+            blob = device->borrow(const_cast<void *>(data->get<void>()), size, data);
+        } else {
+            device->setContext();
+            blob = device->malloc(size);
+            blob->copyFromHost(data->get<void>());
+        }
+
+        std::lock_guard lock(_mutex);
+        if (auto entry = find(); entry) {
+            // 另一个线程先完成了复制，使用它的副本
+            if (auto existing = entry->blob.lock(); existing) {
+                return use(*entry, std::move(existing));
+            }
+            entry->blob = blob;
+            return use(*entry, std::move(blob));
+        }
+        if (_entries.size() >= 2 * _sweepMark + 64) { sweep(); }
+        auto &entry = _entries.emplace(key, Entry{data, blob, size, _pinned.end()}).first->second;
+        return use(entry, std::move(blob));
+    }
+
+    Arc<Blob> WeightCache::derive(
+        Arc<Blob> const &data,
+        std::string layout,
+        size_t size,
+        std::function<void(void *)> const &fill) {
+
+        DerivedKey key{data.get(), std::move(layout)};
+        auto find = [&]() -> Arc<Blob> {
+            auto it = _derived.find(key);
+            if (it == _derived.end()) { return nullptr; }
+            if (it->second.source.owner_before(data) || data.owner_before(it->second.source)) {
+                _derived.erase(it);
+                return nullptr;
+            }
+            return it->second.blob.lock();
+        };
+
+        {
+            std::lock_guard lock(_mutex);
+            if (auto blob = find(); blob) { return blob; }
+        }
+
+        auto [blob, ptr] = Blob::share(size);
+        fill(ptr);
+
+        std::lock_guard lock(_mutex);
+        if (auto existing = find(); existing) { return existing; }
+        if (_derived.size() >= 2 * _sweepMark + 64) { sweep(); }
+        _derived.insert_or_assign(std::move(key), Derived{data, blob, size});
+        return blob;
+    }
+
+    void WeightCache::pin(Entry &entry, Key key, DeviceBlob blob) {
+        if (entry.pin != _pinned.end()) {
+            _pinned.splice(_pinned.begin(), _pinned, entry.pin);
+        } else if (entry.size <= _budget) {
+            _pinned.emplace_front(key, std::move(blob));
+            entry.pin = _pinned.begin();
+            _pinnedBytes += entry.size;
+        }
+        shrink();
+    }
+
+    void WeightCache::shrink() {
+        while (_pinnedBytes > _budget) {
+            auto &[victim, _] = _pinned.back();
+            auto &evicted = _entries.at(victim);
+            _pinnedBytes -= evicted.size;
+            evicted.pin = _pinned.end();
+            _pinned.pop_back();
+            ++_evictions;
+        }
+    }
+
+    void WeightCache::sweep() {
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            if (it->second.pin == _pinned.end() && it->second.blob.expired()) {
+                it = _entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        std::erase_if(_derived, [](auto const &pair) { return pair.second.blob.expired(); });
+        for (auto it = _models.begin(); it != _models.end();) {
+            auto &uses = it->second;
+            std::erase_if(uses, [](auto const &pair) { return pair.second.first.expired(); });
+            it = uses.empty() ? _models.erase(it) : std::next(it);
+        }
+        _sweepMark = _entries.size();
+    }
+
+    void WeightCache::setBudget(size_t budget) {
+        std::lock_guard lock(_mutex);
+        _budget = budget;
+        shrink();
+    }
+
+    void WeightCache::clear() {
+        std::lock_guard lock(_mutex);
+        for (auto &[key, _] : _pinned) { _entries.at(key).pin = _pinned.end(); }
+        _pinned.clear();
+        _pinnedBytes = 0;
+        sweep();
+    }
+
+    WeightCacheStats WeightCache::stats() {
+        std::lock_guard lock(_mutex);
+        sweep();
+        WeightCacheStats ans{0, 0, _pinnedBytes, _budget, _hits, _misses, _evictions, 0, 0, {}};
+        for (auto const &[_, entry] : _entries) {
+            if (!entry.blob.expired()) {
+                ans.resident += entry.size;
+                ++ans.entries;
+            }
+        }
+        for (auto const &[_, derived] : _derived) {
+            ans.derived += derived.size;
+            ++ans.derivedEntries;
+        }
+        for (auto const &[model, uses] : _models) {
+            size_t bytes = 0;
+            for (auto const &[_, use] : uses) {
+                if (!use.first.expired()) { bytes += use.second; }
+            }
+            ans.models.emplace(model, bytes);
+        }
+        return ans;
+    }
+
+}// namespace refactor::kernel
@@ -0,0 +1,384 @@
+#include "kernel/allocators.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <map>
+
+using namespace refactor;
+using namespace kernel;
+
+namespace {
+    struct TestGraph {
+        std::string name;
+        graph_topo::GraphTopo topology;
+        std::vector<runtime::Node> nodes;
+        std::vector<Edge> edges;
+
+        /// @brief 构造图时返回的边在图中的序号，构造器会按拓扑序重新编号。
+        count_t operator[](count_t key) const {
+            auto name = fmt::format("e{}", key);
+            auto it = std::find_if(edges.begin(), edges.end(), [&](auto const &e) { return e.name == name; });
+            return static_cast<count_t>(it - edges.begin());
+        }
+    };
+
+    /// @brief 以 `add(inputs, output size, workspace size, inplace)` 逐个添加节点构造计算图。
+    class GraphBuilder {
+        graph_topo::Builder<count_t, runtime::Node, count_t, Edge> _builder;
+        count_t _nodes = 0, _edges = 0;
+
+    public:
+        count_t input(size_t size) {
+            _builder.globalInputs.push_back(_edges);
+            _builder.edges.insert({_edges, {nullptr, size, fmt::format("e{}", _edges)}});
+            return _edges++;
+        }
+        count_t weight(size_t size) {
+            _builder.edges.insert({_edges, {Blob::share(1).first, size, fmt::format("w{}", _edges)}});
+            return _edges++;
+        }
+        count_t add(std::vector<count_t> inputs, size_t size, size_t workspace = 0, std::vector<count_t> inplace = {}) {
+            runtime::Node node(runtime::emptyRoutine, workspace);
+            node.inplace = std::move(inplace);
+            _builder.topology.insert({_nodes, {std::move(inputs), {_edges}}});
+            _builder.nodes.insert({_nodes++, std::move(node)});
+            _builder.edges.insert({_edges, {nullptr, size, fmt::format("e{}", _edges)}});
+            return _edges++;
+        }
+        /// @brief 沿最外层拼接，各输入是输出中的连续区间。
+        count_t concat(std::vector<count_t> inputs) {
+            runtime::Node node(runtime::emptyRoutine);
+            node.subBuffers.side = runtime::SubBuffers::Side::Inputs;
+            size_t size = 0;
+            for (auto i : inputs) {
+                node.subBuffers.offsets.push_back(size);
+                size += _builder.edges.at(i).size;
+            }
+            _builder.topology.insert({_nodes, {std::move(inputs), {_edges}}});
+            _builder.nodes.insert({_nodes++, std::move(node)});
+            _builder.edges.insert({_edges, {nullptr, size, fmt::format("e{}", _edges)}});
+            return _edges++;
+        }
+        /// @brief 沿最外层切分，各输出是输入中的连续区间。
+        std::vector<count_t> split(count_t input, std::vector<size_t> sizes) {
+            runtime::Node node(runtime::emptyRoutine);
+            node.subBuffers.side = runtime::SubBuffers::Side::Outputs;
+            std::vector<count_t> outputs;
+            size_t offset = 0;
+            for (auto size : sizes) {
+                node.subBuffers.offsets.push_back(offset);
+                offset += size;
+                outputs.push_back(_edges);
+                _builder.edges.insert({_edges, {nullptr, size, fmt::format("e{}", _edges)}});
+                ++_edges;
+            }
+            _builder.topology.insert({_nodes, {{input}, outputs}});
+            _builder.nodes.insert({_nodes++, std::move(node)});
+            return outputs;
+        }
+        TestGraph build(std::string name, std::vector<count_t> outputs) {
+            _builder.globalOutputs = std::move(outputs);
+            auto [topology, nodes, edges] = _builder.build();
+            return {std::move(name), std::move(topology), std::move(nodes), std::move(edges)};
+        }
+        TestGraph build(std::string name, count_t output) {
+            return build(std::move(name), std::vector<count_t>{output});
+        }
+    };
+
+    // 每层：LN -> QKV -> 注意力分数 -> softmax -> 加权 -> 投影 -> 残差 -> LN -> FFN -> 残差
+    TestGraph transformer(count_t layers, size_t seq, size_t hidden, size_t heads) {
+        constexpr static size_t F = sizeof(float);
+        GraphBuilder g;
+        auto x = g.input(seq * hidden * F);
+        for (count_t l = 0; l < layers; ++l) {
+            auto act = seq * hidden * F;
+            auto ln = g.add({x, g.weight(hidden * F)}, act);
+            auto q = g.add({ln, g.weight(hidden * hidden * F)}, act),
+                 k = g.add({ln, g.weight(hidden * hidden * F)}, act),
+                 v = g.add({ln, g.weight(hidden * hidden * F)}, act);
+            auto scores = g.add({q, k}, heads * seq * seq * F);
+            auto probs = g.add({scores}, heads * seq * seq * F, hidden * F);
+            auto attn = g.add({probs, v}, act);
+            auto proj = g.add({attn, g.weight(hidden * hidden * F)}, act);
+            auto res = g.add({x, proj}, act);
+            auto ln2 = g.add({res, g.weight(hidden * F)}, act);
+            auto up = g.add({ln2, g.weight(4 * hidden * hidden * F)}, 4 * act);
+            auto gelu = g.add({up}, 4 * act);
+            auto down = g.add({gelu, g.weight(4 * hidden * hidden * F)}, act);
+            x = g.add({res, down}, act);
+        }
+        return g.build(fmt::format("transformer x{}", layers), x);
+    }
+
+    // 编码器每级的输出保留到对应的解码器级，`zeroCopy` 为 true 时拼接声明输入是输出的区间
+    TestGraph unet(count_t levels, size_t size, bool zeroCopy = false) {
+        GraphBuilder g;
+        auto x = g.input(size);
+        std::vector<count_t> skips;
+        for (count_t l = 0; l < levels; ++l) {
+            auto a = g.add({x}, size, size / 4);
+            auto b = g.add({a}, size);
+            skips.push_back(b);
+            size /= 2;
+            x = g.add({b}, size);
+        }
+        x = g.add({x}, size);
+        for (count_t l = levels; l-- > 0;) {
+            size *= 2;
+            auto up = g.add({x}, size);
+            auto cat = zeroCopy ? g.concat({up, skips[l]}) : g.add({up, skips[l]}, size * 2);
+            x = g.add({cat}, size, size / 4);
+        }
+        return g.build(fmt::format("unet x{}{}", levels, zeroCopy ? " zero-copy" : ""), x);
+    }
+
+    // MobileNetV2 的倒残差块：扩张卷积 -> BN -> ReLU6 -> 投影卷积 -> BN -> 残差，
+    // `inplace` 为 true 时 BN、激活和残差加法原地执行
+    TestGraph invertedResidual(count_t blocks, size_t size, bool inplace) {
+        GraphBuilder g;
+        std::vector<count_t> unary, binary;
+        if (inplace) { unary = {0}, binary = {0, 1}; }
+        auto x = g.input(size);
+        for (count_t b = 0; b < blocks; ++b) {
+            auto expand = g.add({x, g.weight(size)}, 6 * size, size / 4);
+            auto bn = g.add({expand, g.weight(64)}, 6 * size, 0, unary);
+            auto relu = g.add({bn}, 6 * size, 0, unary);
+            auto project = g.add({relu, g.weight(size)}, size, size / 4);
+            auto bn2 = g.add({project, g.weight(64)}, size, 0, unary);
+            x = g.add({bn2, x}, size, 0, binary);
+        }
+        x = g.add({x}, size);
+        return g.build(fmt::format("mbv2 x{}{}", blocks, inplace ? " inplace" : ""), x);
+    }
+
+    // 每个节点从最近的若干条边中随机选择输入
+    TestGraph randomDag(count_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        GraphBuilder g;
+        std::vector<count_t> edges{g.input(1 << 16)};
+        for (count_t i = 0; i < count; ++i) {
+            std::vector<count_t> inputs;
+            for (auto n = 1 + rng() % 3; n-- > 0;) {
+                auto window = std::min<size_t>(edges.size(), 16);
+                inputs.push_back(edges[edges.size() - 1 - rng() % window]);
+            }
+            auto size = size_t(256) << (rng() % 12);
+            edges.push_back(g.add(std::move(inputs), size, rng() % 4 ? 0 : size / 2));
+        }
+        return g.build(fmt::format("random x{}", count), edges.back());
+    }
+
+    // 检查同时存活的缓冲区在栈上互不重叠，
+    // 只有原地执行的节点的输出可以与它在此节点最后一次使用的输入重合
+    void checkScheme(TestGraph const &g, AllocScheme const &scheme) {
+        constexpr static auto NONE = std::numeric_limits<count_t>::max();
+        struct Placed {
+            count_t first, last, edge;
+            size_t begin, end;
+        };
+        std::vector<Placed> placed;
+        std::vector<count_t> first(g.edges.size(), 0), last(g.edges.size(), 0);
+        // 允许重合的边对，以及后者在前者中的偏移
+        std::map<std::pair<count_t, count_t>, ptrdiff_t> aliases;
+        count_t step = 0;
+        for (auto [nodeIdx, inputs, outputs] : g.topology) {
+            for (auto i : inputs) { last[i] = step; }
+            for (auto i : outputs) { first[i] = last[i] = step; }
+            auto const &node = g.nodes[nodeIdx];
+            for (auto k : node.inplace) { aliases.emplace(std::pair{inputs[k], outputs[0]}, 0); }
+            auto const &sub = node.subBuffers;
+            if (sub.side == runtime::SubBuffers::Side::Inputs) {
+                for (auto k : range0_(inputs.size())) {
+                    aliases.emplace(std::pair{inputs[k], outputs[0]}, -static_cast<ptrdiff_t>(sub.offsets[k]));
+                }
+            } else if (sub.side == runtime::SubBuffers::Side::Outputs) {
+                for (auto k : range0_(outputs.size())) {
+                    aliases.emplace(std::pair{inputs[0], outputs[k]}, sub.offsets[k]);
+                }
+            }
+            if (auto ws = g.nodes[nodeIdx].workspaceSize; ws) {
+                auto offset = scheme.nodes[nodeIdx].workspaceOffset;
+                placed.push_back({step, step, NONE, offset, offset + ws});
+            }
+            ++step;
+        }
+        for (auto i : range0_(g.edges.size())) {
+            if (auto offset = scheme.edges[i].stackOffset; offset != SIZE_MAX) {
+                EXPECT_LE(offset + g.edges[i].size, scheme.stack);
+                placed.push_back({first[i], last[i], static_cast<count_t>(i), offset, offset + g.edges[i].size});
+            }
+        }
+        auto aliased = [&](Placed const &a, Placed const &b) {
+            auto it = aliases.find({a.edge, b.edge});
+            return it != aliases.end() &&
+                   a.last == b.first &&
+                   static_cast<ptrdiff_t>(b.begin - a.begin) == it->second;
+        };
+        for (auto i : range0_(placed.size())) {
+            for (auto j : range(i + 1, placed.size())) {
+                auto const &a = placed[i], &b = placed[j];
+                if (aliased(a, b) || aliased(b, a)) { continue; }
+                if (a.first <= b.last && b.first <= a.last && a.begin < a.end && b.begin < b.end) {
+                    ASSERT_TRUE(a.end <= b.begin || b.end <= a.begin)
+                        << fmt::format("[{}, {}) and [{}, {}) overlap", a.begin, a.end, b.begin, b.end);
+                }
+            }
+        }
+    }
+}// namespace
+
+TEST(kernel, PlannedAllocate) {
+    constexpr static size_t ALIGN = 32;
+    std::vector<TestGraph> graphs;
+    graphs.push_back(transformer(4, 128, 256, 4));
+    graphs.push_back(unet(5, 1 << 20));
+    graphs.push_back(randomDag(2000, 7));
+
+    fmt::println("{:<16} {:>12} {:>12} {:>12} {:>12}", "graph", "flat", "reusable", "planned", "lower bound");
+    for (auto const &g : graphs) {
+        auto flat = flatAllocate(g.topology, g.nodes, g.edges, ALIGN);
+        auto reusable = reusableAllocate(g.topology, g.nodes, g.edges, ALIGN);
+        auto planned = plannedAllocate(g.topology, g.nodes, g.edges, ALIGN);
+        auto bound = peakLowerBound(g.topology, g.nodes, g.edges, ALIGN);
+        checkScheme(g, reusable);
+        checkScheme(g, planned);
+        EXPECT_GE(planned.stack, bound);
+        EXPECT_LE(planned.stack, flat.stack);
+        fmt::println("{:<16} {:>12} {:>12} {:>12} {:>12}", g.name, flat.stack, reusable.stack, planned.stack, bound);
+    }
+}
+
+TEST(kernel, InplaceAllocate) {
+    constexpr static size_t ALIGN = 32, SIZE = 1 << 20;
+    auto plain = invertedResidual(8, SIZE, false),
+         inplace = invertedResidual(8, SIZE, true);
+
+    fmt::println("{:<20} {:>12} {:>12} {:>12}", "graph", "reusable", "planned", "lower bound");
+    for (auto const *g : {&plain, &inplace}) {
+        auto reusable = reusableAllocate(g->topology, g->nodes, g->edges, ALIGN);
+        auto planned = plannedAllocate(g->topology, g->nodes, g->edges, ALIGN);
+        auto bound = peakLowerBound(g->topology, g->nodes, g->edges, ALIGN);
+        checkScheme(*g, reusable);
+        checkScheme(*g, planned);
+        EXPECT_GE(planned.stack, bound);
+        fmt::println("{:<20} {:>12} {:>12} {:>12}", g->name, reusable.stack, planned.stack, bound);
+    }
+    auto a = reusableAllocate(plain.topology, plain.nodes, plain.edges, ALIGN),
+         b = reusableAllocate(inplace.topology, inplace.nodes, inplace.edges, ALIGN);
+    EXPECT_LT(b.stack, a.stack);
+    auto c = plannedAllocate(plain.topology, plain.nodes, plain.edges, ALIGN),
+         d = plannedAllocate(inplace.topology, inplace.nodes, inplace.edges, ALIGN);
+    EXPECT_LT(d.stack, c.stack);
+}
+
+TEST(kernel, InplaceAllocateLastUse) {
+    constexpr static size_t ALIGN = 32, SIZE = 1024;
+    GraphBuilder g;
+    auto x = g.input(SIZE);
+    auto a = g.add({x}, SIZE);
+    // a 之后仍被 c 使用，b 不能覆盖它
+    auto b = g.add({a}, SIZE, 0, {0});
+    // c 是 a 和 b 的最后一个使用者，优先复用 a
+    auto c = g.add({a, b}, SIZE, 0, {0, 1});
+    // 大小不同的输入不能复用
+    auto d = g.add({c}, SIZE / 2, 0, {0});
+    // 全局输出占据固定的槽位，不能复用输入
+    auto y = g.add({d}, SIZE / 2, 0, {0});
+    auto graph = g.build("last use", y);
+
+    for (auto allocate : {reusableAllocate, plannedAllocate}) {
+        auto scheme = allocate(graph.topology, graph.nodes, graph.edges, ALIGN);
+        checkScheme(graph, scheme);
+        auto offset = [&](count_t key) { return scheme.edges[graph[key]].stackOffset; };
+        EXPECT_NE(offset(b), offset(a));
+        EXPECT_EQ(offset(c), offset(a));
+        EXPECT_NE(offset(d), offset(c));
+        EXPECT_NE(offset(y), offset(d));
+        // 全局输入从不被覆盖
+        EXPECT_NE(offset(a), offset(x));
+    }
+}
+
+namespace {
+    // 拼接和切分节点中没有就位、仍然需要复制的字节数
+    size_t copiedBytes(TestGraph const &g, AllocScheme const &scheme) {
+        using Side = runtime::SubBuffers::Side;
+        size_t ans = 0;
+        for (auto [nodeIdx, inputs, outputs] : g.topology) {
+            auto const &sub = g.nodes[nodeIdx].subBuffers;
+            if (sub.side == Side::Inputs) {
+                for (auto k : range0_(inputs.size())) {
+                    if (scheme.edges[inputs[k]].stackOffset != scheme.edges[outputs[0]].stackOffset + sub.offsets[k]) {
+                        ans += g.edges[inputs[k]].size;
+                    }
+                }
+            } else if (sub.side == Side::Outputs) {
+                for (auto k : range0_(outputs.size())) {
+                    if (scheme.edges[outputs[k]].stackOffset != scheme.edges[inputs[0]].stackOffset + sub.offsets[k]) {
+                        ans += g.edges[outputs[k]].size;
+                    }
+                }
+            }
+        }
+        return ans;
+    }
+}// namespace
+
+TEST(kernel, SubBufferAllocate) {
+    constexpr static size_t ALIGN = 32;
+    auto g = unet(5, 1 << 20, true);
+    auto reusable = reusableAllocate(g.topology, g.nodes, g.edges, ALIGN),
+         planned = plannedAllocate(g.topology, g.nodes, g.edges, ALIGN);
+    auto bound = peakLowerBound(g.topology, g.nodes, g.edges, ALIGN);
+    checkScheme(g, reusable);
+    checkScheme(g, planned);
+    EXPECT_GE(planned.stack, bound);
+
+    fmt::println("{}: lower bound {}", g.name, bound);
+    fmt::println("{:<12} {:>12} {:>12}", "allocator", "stack", "copied");
+    fmt::println("{:<12} {:>12} {:>12}", "reusable", reusable.stack, copiedBytes(g, reusable));
+    fmt::println("{:<12} {:>12} {:>12}", "planned", planned.stack, copiedBytes(g, planned));
+    // 按引用计数复用的分配器不做这项优化，拼接照常复制；规划后所有拼接都不再复制
+    EXPECT_GT(copiedBytes(g, reusable), 0);
+    EXPECT_EQ(copiedBytes(g, planned), 0);
+}
+
+TEST(kernel, SubBufferAllocateRules) {
+    constexpr static size_t ALIGN = 32, SIZE = 1024;
+    GraphBuilder g;
+    auto past = g.input(4 * SIZE),
+         x = g.input(SIZE);
+    // KV 缓存追加：新的一段直接写入全局输出的槽位，全局输入的旧缓存照常复制
+    auto k = g.add({x}, SIZE);
+    auto present = g.concat({past, k});
+    // a 在拼接之后仍被使用，不能移入拼接的结果
+    auto a = g.add({x}, SIZE);
+    auto b = g.add({x}, SIZE, 0, {0});
+    auto ab = g.concat({a, b});
+    auto c = g.add({ab, a}, 2 * SIZE);
+    // 原地执行的一串边整组移入拼接的结果
+    auto d = g.add({c}, SIZE);
+    auto e = g.add({d}, SIZE, 0, {0});
+    auto f = g.add({c}, SIZE);
+    auto ef = g.concat({e, f});
+    // 切分的各输出指向输入中的区间，输出再原地执行
+    auto parts = g.split(ef, {SIZE / 2, 3 * SIZE / 2});
+    auto h = g.add({parts[0]}, SIZE / 2, 0, {0});
+    auto y = g.add({h, parts[1]}, SIZE);
+    auto graph = g.build("rules", {present, y});
+
+    auto scheme = plannedAllocate(graph.topology, graph.nodes, graph.edges, ALIGN);
+    checkScheme(graph, scheme);
+    auto offset = [&](count_t key) { return scheme.edges[graph[key]].stackOffset; };
+    EXPECT_NE(offset(past), offset(present));
+    EXPECT_EQ(offset(k), offset(present) + 4 * SIZE);
+    EXPECT_NE(offset(a), offset(ab));
+    EXPECT_EQ(offset(b), offset(ab) + SIZE);
+    EXPECT_EQ(offset(d), offset(ef));
+    EXPECT_EQ(offset(e), offset(ef));
+    EXPECT_EQ(offset(f), offset(ef) + SIZE);
+    EXPECT_EQ(offset(parts[0]), offset(ef));
+    EXPECT_EQ(offset(parts[1]), offset(ef) + SIZE / 2);
+    EXPECT_EQ(offset(h), offset(ef));
+    EXPECT_EQ(copiedBytes(graph, scheme), 4 * SIZE + SIZE);
+}
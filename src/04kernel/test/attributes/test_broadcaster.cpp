@@ -34,3 +34,27 @@ TEST(kernel, Broadcaster) {
     broadcaster.locate(40, ans.data());
     EXPECT_EQ(ans, (std::vector<dim_t>{40, 5, 0, 0}));
 }
+
+TEST(kernel, BroadcasterNeedBroadcast) {
+    Shape
+        s0{2, 3, 5},
+        s1{5},
+        s2{2, 3, 5};
+    Broadcaster broadcaster({
+        slice(s0.data(), s0.size()),
+        slice(s1.data(), s1.size()),
+        slice(s2.data(), s2.size()),
+    });
+    EXPECT_TRUE(broadcaster.needBroadcast());
+    EXPECT_FALSE(broadcaster.needBroadcast(0));
+    EXPECT_TRUE(broadcaster.needBroadcast(1));
+    EXPECT_FALSE(broadcaster.needBroadcast(2));
+
+    Shape s3{1, 3, 5};
+    Broadcaster partial({
+        slice(s3.data(), s3.size()),
+        slice(s1.data(), s1.size()),
+    });
+    EXPECT_TRUE(partial.needBroadcast(1));
+    EXPECT_FALSE(partial.needBroadcast(0));
+}
@@ -12,4 +12,10 @@ TEST(kernel, GatherInfo) {
     EXPECT_EQ(info.postfix, 7 * 8 * DataType(DataType::F32).size());
     EXPECT_EQ(info.midSizeI, 10);
     EXPECT_EQ(info.midSizeO, 4 * 5 * 6);
+
+    auto [flops, bytesRead, bytesWritten] = info.cost();
+    auto output = 2 * 3 * (4 * 5 * 6) * 7 * 8 * sizeof(float);
+    EXPECT_EQ(flops, 0);
+    EXPECT_EQ(bytesRead, output + 4 * 5 * 6 * sizeof(int64_t));
+    EXPECT_EQ(bytesWritten, output);
 }
@@ -64,3 +64,43 @@ TEST(kernel, ConcatCpu) {
         }
     }
 }
+
+TEST(kernel, ConcatCpuZeroCopy) {
+    // 沿最外层的非 1 维拼接，每个输入都是输出中的连续区间
+    std::vector<Arc<Tensor>> inputTensors{
+        Tensor::share(DataType::F32, Shape{1, 32, 128, 128}),
+        Tensor::share(DataType::F32, Shape{1, 96, 128, 128}),
+    };
+    auto result = Tensor::share(DataType::F32, Shape{1, 128, 128, 128});
+    auto kernel = ConcatCpu::build(SplitInfo(1, {*inputTensors[0], *inputTensors[1]}));
+    ASSERT_TRUE(kernel);
+    auto sub = kernel->subBuffers();
+    EXPECT_EQ(sub.side, runtime::SubBuffers::Side::Inputs);
+    EXPECT_EQ(sub.offsets, (std::vector<size_t>{0, inputTensors[0]->bytesSize()}));
+    // 不在最外层拼接时不适用
+    EXPECT_EQ(ConcatCpu::build(SplitInfo(2, {*inputTensors[0], *inputTensors[0]}))->subBuffers().side,
+              runtime::SubBuffers::Side::None);
+
+    auto res = runtime::Resources();
+    auto routine = kernel->lower(res).routine;
+    std::vector<float>
+        ins[]{
+            std::vector<float>(inputTensors[0]->elementsSize()),
+            std::vector<float>(inputTensors[1]->elementsSize()),
+        },
+        out(result->elementsSize()),
+        answer(result->elementsSize());
+    std::iota(answer.begin(), answer.end(), 0);
+    std::copy_n(answer.begin(), ins[0].size(), ins[0].begin());
+    std::copy_n(answer.begin() + ins[0].size(), ins[1].size(), ins[1].begin());
+
+    void *outputs[]{out.data()};
+    void const *separate[]{ins[0].data(), ins[1].data()};
+    routine(res, nullptr, separate, outputs);
+    EXPECT_EQ(out, answer);
+    // 内存规划把输入放在输出中的对应位置上，例程不再复制
+    std::copy(answer.begin(), answer.end(), out.begin());
+    void const *placed[]{out.data(), out.data() + ins[0].size()};
+    routine(res, nullptr, placed, outputs);
+    EXPECT_EQ(out, answer);
+}
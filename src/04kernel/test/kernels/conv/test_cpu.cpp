@@ -0,0 +1,355 @@
+#include "../src/kernels/conv/cpu_kernel.hh"
+#include "../src/kernels/conv/winograd_cpu_kernel.hh"
+#include "../src/kernels/mat_mul_common/packed_weights.hh"
+#include "../helpers.h"
+#include <gtest/gtest.h>
+
+using namespace refactor;
+using namespace kernel;
+
+struct ConvCase {
+    size_t n, c, h, w, co, kh, kw, groups;
+    int64_t dilations[2], pads[4], strides[2];
+    bool bias;
+
+    size_t ho() const { return (h + pads[0] + pads[2] - dilations[0] * (kh - 1) - 1) / strides[0] + 1; }
+    size_t wo() const { return (w + pads[1] + pads[3] - dilations[1] * (kw - 1) - 1) / strides[1] + 1; }
+    size_t flops() const { return 2 * n * co * ho() * wo() * c / groups * kh * kw; }
+    PoolAttributes attributes() const { return PoolAttributes(2, dilations, pads, strides); }
+};
+
+// 逐个输出元素计算的 NCHW 卷积，作为参考结果和性能基准
+static void naiveConv(ConvCase const &c, float const *x, float const *w, float const *b, float *y) {
+    auto cg = c.c / c.groups, cog = c.co / c.groups, ho = c.ho(), wo = c.wo();
+    for (auto n : range0_(c.n))
+        for (auto oc : range0_(c.co))
+            for (auto oh : range0_(ho))
+                for (auto ow : range0_(wo)) {
+                    float acc = b ? b[oc] : 0;
+                    for (auto ic : range0_(cg))
+                        for (auto kh : range0_(c.kh))
+                            for (auto kw : range0_(c.kw)) {
+                                int64_t ih = oh * c.strides[0] + kh * c.dilations[0] - c.pads[0],
+                                        iw = ow * c.strides[1] + kw * c.dilations[1] - c.pads[1];
+                                if (ih < 0 || ih >= static_cast<int64_t>(c.h) || iw < 0 || iw >= static_cast<int64_t>(c.w)) { continue; }
+                                acc += x[((n * c.c + oc / cog * cg + ic) * c.h + ih) * c.w + iw] *
+                                       w[((oc * cg + ic) * c.kh + kh) * c.kw + kw];
+                            }
+                    y[((n * c.co + oc) * ho + oh) * wo + ow] = acc;
+                }
+}
+
+// [A,B,C,D] -> [A,C,D,B]
+static std::vector<float> toNHWC(std::vector<float> const &src, size_t a, size_t b, size_t c, size_t d) {
+    std::vector<float> ans(src.size());
+    for (auto i : range0_(a))
+        for (auto j : range0_(b))
+            for (auto k : range0_(c * d))
+                ans[(i * c * d + k) * b + j] = src[(i * b + j) * c * d + k];
+    return ans;
+}
+
+using ConvBuilder = KernelBox (*)(PoolAttributes const &,
+                                  Tensor const &,
+                                  Tensor const &,
+                                  std::optional<std::reference_wrapper<Tensor const>>,
+                                  Tensor const &,
+                                  Arc<Blob>);
+
+// 构造卷积的张量，`nhwc` 时按布局变换后的形状，`constW` 时 W 带有数据
+struct ConvTensors {
+    Arc<Tensor> x, w, b, y;
+
+    ConvTensors(ConvCase const &c, bool nhwc, float const *w_) {
+        auto layout = nhwc ? LayoutType::NHWC : LayoutType::NCHW;
+        auto shape = [&](size_t n, size_t ch, size_t h, size_t w) {
+            return nhwc ? Shape{dim_t(n), dim_t(h), dim_t(w), dim_t(ch)}
+                        : Shape{dim_t(n), dim_t(ch), dim_t(h), dim_t(w)};
+        };
+        x = Tensor::share(DataType::F32, shape(c.n, c.c, c.h, c.w), layout);
+        w = Tensor::share(DataType::F32, shape(c.co, c.c / c.groups, c.kh, c.kw), layout);
+        b = Tensor::share(DataType::F32, Shape{dim_t(c.co)});
+        y = Tensor::share(DataType::F32, shape(c.n, c.co, c.ho(), c.wo()), layout);
+        if (w_) { std::memcpy(w->malloc(), w_, w->bytesSize()); }
+    }
+
+    KernelBox kernel(ConvCase const &c, ConvBuilder build = ConvCpu::build) const {
+        return build(c.attributes(), *x, *w, c.bias ? std::make_optional(std::cref(*b)) : std::nullopt, *y, w->data);
+    }
+};
+
+static std::vector<float> runConv(Kernel const &kernel,
+                                  std::vector<float> const &x,
+                                  std::vector<float> const &w,
+                                  std::vector<float> const &b,
+                                  size_t size) {
+    auto res = runtime::Resources();
+    auto lowered = kernel.lower(res);
+    std::vector<uint8_t> workspace(lowered.workspaceSize);
+    std::vector<float> y(size);
+    void const *inputs[]{x.data(), w.data(), b.data()};
+    void *outputs[]{y.data()};
+    lowered.routine(res, workspace.data(), inputs, outputs);
+    return y;
+}
+
+static void testConv(ConvCase const &c, ConvCpu::Algo algo) {
+    auto x = randomVector(c.n * c.c * c.h * c.w, 1),
+         w = randomVector(c.co * c.c / c.groups * c.kh * c.kw, 2),
+         b = randomVector(c.co, 3);
+    std::vector<float> ans(c.n * c.co * c.ho() * c.wo());
+    naiveConv(c, x.data(), w.data(), c.bias ? b.data() : nullptr, ans.data());
+    auto xT = toNHWC(x, c.n, c.c, c.h, c.w),
+         wT = toNHWC(w, c.co, c.c / c.groups, c.kh, c.kw),
+         ansT = toNHWC(ans, c.n, c.co, c.ho(), c.wo());
+
+    for (auto nhwc : {false, true}) {
+        for (auto constW : {false, true}) {
+            auto const &x_ = nhwc ? xT : x, &w_ = nhwc ? wT : w, &ans_ = nhwc ? ansT : ans;
+            ConvTensors tensors(c, nhwc, constW ? w_.data() : nullptr);
+            auto kernel = tensors.kernel(c);
+            ASSERT_TRUE(kernel);
+            EXPECT_EQ(dynamic_cast<ConvCpu const &>(*kernel).info.algo, algo);
+            EXPECT_EQ(kernel->cost().flops, c.flops() + (c.bias ? ans.size() : 0));
+
+            auto y = runConv(*kernel, x_, w_, b, ans.size());
+            for (auto i : range0_(y.size())) {
+                ASSERT_NEAR(y[i], ans_[i], 1e-4) << (nhwc ? "NHWC" : "NCHW") << (constW ? " const W" : "") << " at " << i;
+            }
+        }
+    }
+}
+
+TEST(kernel, ConvCpu_Im2col) {
+    using A = ConvCpu::Algo;
+    // 3x3，填充 1，步长 2，带偏置
+    testConv({2, 5, 9, 11, 7, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {2, 2}, true}, A::Im2col);
+    // 分组、膨胀、不对称填充
+    testConv({1, 6, 10, 8, 4, 3, 2, 2, {2, 1}, {0, 2, 1, 0}, {1, 1}, false}, A::Im2col);
+    // 分组并带偏置，NHWC 下经过工作空间散布
+    testConv({2, 8, 7, 7, 12, 3, 3, 4, {1, 1}, {1, 1, 1, 1}, {1, 2}, true}, A::Im2col);
+    // 分组的 1x1 卷积直接使用 X 作为展开的矩阵
+    testConv({2, 8, 5, 6, 6, 1, 1, 2, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}, A::Im2col);
+    // 有步长的 1x1 卷积
+    testConv({1, 16, 9, 9, 24, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {2, 2}, true}, A::Im2col);
+    // 单个输入通道
+    testConv({1, 1, 12, 12, 16, 5, 5, 1, {1, 1}, {2, 2, 2, 2}, {1, 1}, true}, A::Im2col);
+}
+
+TEST(kernel, ConvCpu_Pointwise) {
+    using A = ConvCpu::Algo;
+    testConv({3, 40, 6, 7, 33, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}, A::Pointwise);
+    testConv({1, 300, 4, 4, 20, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, false}, A::Pointwise);
+}
+
+TEST(kernel, ConvCpu_Depthwise) {
+    using A = ConvCpu::Algo;
+    testConv({2, 24, 13, 15, 24, 3, 3, 24, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}, A::Depthwise);
+    testConv({1, 16, 14, 14, 16, 3, 3, 16, {1, 1}, {0, 1, 1, 0}, {2, 2}, false}, A::Depthwise);
+    // 通道倍数为 2，膨胀
+    testConv({2, 6, 11, 9, 12, 3, 3, 6, {2, 2}, {2, 2, 2, 2}, {1, 1}, true}, A::Depthwise);
+    // 卷积核比输入宽
+    testConv({1, 4, 3, 3, 4, 5, 5, 4, {1, 1}, {2, 2, 2, 2}, {1, 1}, true}, A::Depthwise);
+}
+
+TEST(kernel, ConvCpu_1D) {
+    // 1D 卷积按 H 为 1 的 2D 卷积计算
+    ConvCase c{2, 4, 1, 20, 6, 1, 3, 2, {1, 2}, {0, 1, 0, 3}, {1, 2}, true};
+    auto x = randomVector(c.n * c.c * c.w, 1),
+         w = randomVector(c.co * c.c / c.groups * c.kw, 2),
+         b = randomVector(c.co, 3);
+    std::vector<float> ans(c.n * c.co * c.wo()), y(ans.size());
+    naiveConv(c, x.data(), w.data(), b.data(), ans.data());
+
+    auto X = Tensor::share(DataType::F32, Shape{dim_t(c.n), dim_t(c.c), dim_t(c.w)}),
+         W = Tensor::share(DataType::F32, Shape{dim_t(c.co), dim_t(c.c / c.groups), dim_t(c.kw)}),
+         B = Tensor::share(DataType::F32, Shape{dim_t(c.co)}),
+         Y = Tensor::share(DataType::F32, Shape{dim_t(c.n), dim_t(c.co), dim_t(c.wo())});
+    int64_t dilations[]{2}, pads[]{1, 3}, strides[]{2};
+    auto kernel = ConvCpu::build(PoolAttributes(1, dilations, pads, strides), *X, *W, *B, *Y);
+    ASSERT_TRUE(kernel);
+    y = runConv(*kernel, x, w, b, y.size());
+    for (auto i : range0_(y.size())) {
+        ASSERT_NEAR(y[i], ans[i], 1e-4);
+    }
+}
+
+TEST(kernel, ConvCpu_Unsupported) {
+    auto x = Tensor::share(DataType::I32, Shape{1, 2, 4, 4}),
+         w = Tensor::share(DataType::I32, Shape{2, 2, 3, 3}),
+         y = Tensor::share(DataType::I32, Shape{1, 2, 2, 2});
+    int64_t dilations[]{1, 1}, pads[]{0, 0, 0, 0}, strides[]{1, 1};
+    EXPECT_FALSE(ConvCpu::build(PoolAttributes(2, dilations, pads, strides), *x, *w, std::nullopt, *y));
+}
+
+// Winograd 的变换矩阵含 1/6、1/24 等系数，变换域中的数值比原始数据大，单精度下的舍入误差比直接卷积大。
+// 输入和权重均匀分布在 [-1,1] 时结果的标准差约为 sqrt(C)，实测最大绝对误差约为 3e-6 * C
+// （C 为 16 到 256 时相对于标准差在 1e-5 量级），允许的绝对误差取 WINOGRAD_TOLERANCE * C
+constexpr static float WINOGRAD_TOLERANCE = 1e-5f;
+
+static void testWinograd(ConvCase const &c) {
+    auto x = randomVector(c.n * c.c * c.h * c.w, 1),
+         w = randomVector(c.co * c.c * 9, 2),
+         b = randomVector(c.co, 3);
+    std::vector<float> ans(c.n * c.co * c.ho() * c.wo());
+    naiveConv(c, x.data(), w.data(), c.bias ? b.data() : nullptr, ans.data());
+    auto xT = toNHWC(x, c.n, c.c, c.h, c.w),
+         wT = toNHWC(w, c.co, c.c, 3, 3),
+         ansT = toNHWC(ans, c.n, c.co, c.ho(), c.wo());
+    auto tolerance = WINOGRAD_TOLERANCE * c.c;
+
+    for (auto nhwc : {false, true}) {
+        for (auto constW : {false, true}) {
+            auto const &x_ = nhwc ? xT : x, &w_ = nhwc ? wT : w, &ans_ = nhwc ? ansT : ans;
+            ConvTensors tensors(c, nhwc, constW ? w_.data() : nullptr);
+            auto kernel = tensors.kernel(c, ConvWinogradCpu::build);
+            ASSERT_TRUE(kernel);
+            EXPECT_EQ(kernel->cost().flops, c.flops() + (c.bias ? ans.size() : 0));
+            auto y = runConv(*kernel, x_, w_, b, ans.size());
+            float error = 0;
+            for (auto i : range0_(y.size())) { error = std::max(error, std::abs(y[i] - ans_[i])); }
+            EXPECT_LE(error, tolerance) << (nhwc ? "NHWC" : "NCHW") << (constW ? " const W" : "");
+        }
+    }
+}
+
+TEST(kernel, ConvWinogradCpu) {
+    // 输出尺寸是 4 的倍数
+    testWinograd({1, 16, 12, 12, 16, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true});
+    // 输出尺寸不是 4 的倍数，通道数不是 16 的倍数，多个图像
+    testWinograd({2, 19, 11, 9, 21, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, false});
+    // 无填充和不对称填充
+    testWinograd({1, 32, 14, 13, 24, 3, 3, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true});
+    testWinograd({2, 16, 7, 6, 16, 3, 3, 1, {1, 1}, {2, 0, 1, 2}, {1, 1}, true});
+    // 较多的通道
+    testWinograd({1, 256, 10, 10, 64, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true});
+}
+
+TEST(kernel, ConvWinogradCpu_Batches) {
+    // 块数超过一批时分批变换和计算，最后一批较少，与通用实现比较
+    ConvCase c{2, 256, 30, 30, 256, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true};
+    auto x = randomVector(c.n * c.c * c.h * c.w, 1),
+         w = randomVector(c.co * c.c * 9, 2),
+         b = randomVector(c.co, 3);
+    ConvTensors tensors(c, false, w.data());
+    auto winograd = tensors.kernel(c, ConvWinogradCpu::build), general = tensors.kernel(c);
+    ASSERT_TRUE(winograd && general);
+    auto y = runConv(*winograd, x, w, b, c.n * c.co * c.ho() * c.wo()),
+         ans = runConv(*general, x, w, b, y.size());
+    for (auto i : range0_(y.size())) {
+        ASSERT_NEAR(y[i], ans[i], WINOGRAD_TOLERANCE * c.c);
+    }
+}
+
+TEST(kernel, ConvWinogradCpu_Unsupported) {
+    // 步长、膨胀、分组、卷积核大小、通道数或块数不合适时不选择
+    ConvCase const cases[]{
+        {1, 32, 8, 8, 32, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {2, 2}, false},
+        {1, 32, 8, 8, 32, 3, 3, 1, {2, 2}, {1, 1, 1, 1}, {1, 1}, false},
+        {1, 32, 8, 8, 32, 3, 3, 2, {1, 1}, {1, 1, 1, 1}, {1, 1}, false},
+        {1, 32, 8, 8, 32, 5, 5, 1, {1, 1}, {2, 2, 2, 2}, {1, 1}, false},
+        {1, 3, 8, 8, 32, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, false},
+        {1, 512, 7, 7, 512, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, false},
+    };
+    for (auto const &c : cases) {
+        ConvTensors tensors(c, false, nullptr);
+        EXPECT_FALSE(tensors.kernel(c, ConvWinogradCpu::build));
+        EXPECT_TRUE(tensors.kernel(c));
+    }
+}
+
+TEST(kernel, DISABLED_ConvCpu_Benchmark) {
+    struct Layer {
+        std::string_view name;
+        ConvCase c;
+    } const layers[]{
+        {"resnet50 conv1 7x7/2", {1, 3, 224, 224, 64, 7, 7, 1, {1, 1}, {3, 3, 3, 3}, {2, 2}, true}},
+        {"resnet50 res2 1x1", {1, 256, 56, 56, 64, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}},
+        {"resnet50 res2 3x3", {1, 64, 56, 56, 64, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"resnet50 res3 3x3/2", {1, 128, 56, 56, 128, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {2, 2}, true}},
+        {"resnet50 res4 1x1", {1, 1024, 14, 14, 256, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}},
+        {"mobilenet dw 3x3 @112", {1, 32, 112, 112, 32, 3, 3, 32, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"mobilenet dw 3x3/2 @28", {1, 256, 28, 28, 256, 3, 3, 256, {1, 1}, {1, 1, 1, 1}, {2, 2}, true}},
+        {"mobilenet pw @112", {1, 32, 112, 112, 64, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}},
+        {"mobilenet pw @14", {1, 512, 14, 14, 512, 1, 1, 1, {1, 1}, {0, 0, 0, 0}, {1, 1}, true}},
+    };
+
+    auto gflops = [](ConvCase const &c, auto &&f) {
+        return static_cast<double>(c.flops()) / secondsPerRun(f) / 1e9;
+    };
+
+    fmt::println("GFLOP/s of f32 conv, naive loop against the CPU kernel in NCHW and NHWC with constant W");
+    for (auto const &[name, c] : layers) {
+        auto x = randomVector(c.n * c.c * c.h * c.w, 1),
+             w = randomVector(c.co * c.c / c.groups * c.kh * c.kw, 2),
+             b = randomVector(c.co, 3);
+        std::vector<float> y(c.n * c.co * c.ho() * c.wo());
+        auto line = fmt::format("  {:<24} naive {:7.2f}", name,
+                                gflops(c, [&] { naiveConv(c, x.data(), w.data(), b.data(), y.data()); }));
+        for (auto nhwc : {false, true}) {
+            auto w_ = nhwc ? toNHWC(w, c.co, c.c / c.groups, c.kh, c.kw) : w;
+            ConvTensors tensors(c, nhwc, w_.data());
+            auto kernel = tensors.kernel(c);
+            auto res = runtime::Resources();
+            auto lowered = kernel->lower(res);
+            auto const &routine = lowered.routine;
+            std::vector<uint8_t> workspace(lowered.workspaceSize);
+            void const *inputs[]{x.data(), w_.data(), b.data()};
+            void *outputs[]{y.data()};
+            line += fmt::format("  {} {:7.2f}", nhwc ? "nhwc" : "nchw",
+                                gflops(c, [&] { routine(res, workspace.data(), inputs, outputs); }));
+        }
+        fmt::println("{}", line);
+    }
+}
+
+TEST(kernel, DISABLED_ConvWinogradCpu_Benchmark) {
+    struct Layer {
+        std::string_view name;
+        ConvCase c;
+    } const layers[]{
+        {"vgg16 conv1_2 @224", {1, 64, 224, 224, 64, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"vgg16 conv2_2 @112", {1, 128, 112, 112, 128, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"vgg16 conv3_2 @56", {1, 256, 56, 56, 256, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"vgg16 conv4_2 @28", {1, 512, 28, 28, 512, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"vgg16 conv5_2 @14", {1, 512, 14, 14, 512, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"resnet50 res2 3x3 @56", {1, 64, 56, 56, 64, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"resnet50 res3 3x3 @28", {1, 128, 28, 28, 128, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"resnet50 res4 3x3 @14", {1, 256, 14, 14, 256, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+        {"resnet50 res5 3x3 @7 x2", {2, 512, 7, 7, 512, 3, 3, 1, {1, 1}, {1, 1, 1, 1}, {1, 1}, true}},
+    };
+
+    auto gflops = [](ConvCase const &c, auto &&f) {
+        return static_cast<double>(c.flops()) / secondsPerRun(f) / 1e9;
+    };
+
+    fmt::println("Effective GFLOP/s (direct conv flops / time) of f32 3x3 conv with constant W, im2col against winograd");
+    for (auto const &[name, c] : layers) {
+        auto x = randomVector(c.n * c.c * c.h * c.w, 1),
+             w = randomVector(c.co * c.c * 9, 2),
+             b = randomVector(c.co, 3);
+        std::vector<float> y(c.n * c.co * c.ho() * c.wo());
+        auto line = fmt::format("  {:<24}", name);
+        for (auto nhwc : {false, true}) {
+            auto w_ = nhwc ? toNHWC(w, c.co, c.c, 3, 3) : w;
+            ConvTensors tensors(c, nhwc, w_.data());
+            for (auto build : {ConvCpu::build, ConvWinogradCpu::build}) {
+                auto kernel = tensors.kernel(c, build);
+                if (!kernel) {
+                    line += fmt::format("  {} winograd     n/a", nhwc ? "nhwc" : "nchw");
+                    continue;
+                }
+                auto res = runtime::Resources();
+                auto lowered = kernel->lower(res);
+                std::vector<uint8_t> workspace(lowered.workspaceSize);
+                void const *inputs[]{x.data(), w_.data(), b.data()};
+                void *outputs[]{y.data()};
+                line += fmt::format("  {} {} {:7.2f}",
+                                    nhwc ? "nhwc" : "nchw",
+                                    build == ConvCpu::build ? "im2col" : "winograd",
+                                    gflops(c, [&] { lowered.routine(res, workspace.data(), inputs, outputs); }));
+            }
+        }
+        fmt::println("{}", line);
+    }
+}
@@ -19,7 +19,8 @@ TEST(kernel, DequantizeLinearCuda) {
          kCpu = DequantizeLinearCpu::build({*x, *scale, *zeroPoint}, *y);
     ASSERT_TRUE(kernel && kCpu);
     auto res = runtime::Resources();
-    auto [routine, workspaceSize] = kernel->lower(res);
+    auto lowered = kernel->lower(res);
+    auto const &routine = lowered.routine;
     auto rCpu = kCpu->lower(res).routine;
     // malloc
     auto &dev = *device::init(Device::Type::Nvidia, 0, "");
@@ -16,7 +16,8 @@ TEST(kernel, DynamicQuantizeLinearCuda) {
          kCpu = DynamicQuantizeLinearCpu::build(size);
     ASSERT_TRUE(kernel && kCpu);
     auto res = runtime::Resources();
-    auto [routine, workspaceSize] = kernel->lower(res);
+    auto lowered = kernel->lower(res);
+    auto const &routine = lowered.routine;
     auto rCpu = kCpu->lower(res).routine;
     // malloc
     auto &dev = *device::init(Device::Type::Nvidia, 0, "");
@@ -24,7 +25,7 @@ TEST(kernel, DynamicQuantizeLinearCuda) {
          yGpu = dev.malloc(size * sizeof(uint8_t)),
          scaleGpu = dev.malloc(sizeof(float)),
          zpGpu = dev.malloc(sizeof(uint8_t)),
-         workspace = dev.malloc(workspaceSize);
+         workspace = dev.malloc(lowered.workspaceSize);
     // put input data
     std::vector<float> x(size);
     std::vector<uint8_t> y(size);
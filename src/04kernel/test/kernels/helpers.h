@@ -0,0 +1,37 @@
+#ifndef KERNEL_TEST_HELPERS_H
+#define KERNEL_TEST_HELPERS_H
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace refactor::kernel {
+
+    /// @brief [-1, 1) 上均匀分布的随机数，种子相同时序列相同。
+    inline std::vector<float> randomVector(size_t n, unsigned seed) {
+        std::vector<float> ans(n);
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> dis(-1, 1);
+        std::generate(ans.begin(), ans.end(), [&] { return dis(gen); });
+        return ans;
+    }
+
+    /// @brief 预热一次后反复运行 `f` 至少 200 毫秒，返回每次运行的平均秒数。
+    template<class F>
+    double secondsPerRun(F &&f) {
+        using namespace std::chrono;
+        f();
+        size_t runs = 0;
+        auto t0 = high_resolution_clock::now(), t1 = t0;
+        do {
+            f();
+            ++runs;
+            t1 = high_resolution_clock::now();
+        } while (t1 - t0 < milliseconds(200));
+        return duration_cast<duration<double>>(t1 - t0).count() / runs;
+    }
+
+}// namespace refactor::kernel
+
+#endif// KERNEL_TEST_HELPERS_H
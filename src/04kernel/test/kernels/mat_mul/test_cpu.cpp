@@ -1,4 +1,9 @@
 #include "../src/kernels/mat_mul/cpu_kernel.hh"
+#include "../src/kernels/mat_mul_common/cpu_gemm.hh"
+#include "../src/kernels/mat_mul_common/cpu_template.hpp"
+#include "../src/kernels/mat_mul_common/packed_weights.hh"
+#include "../helpers.h"
+#include "kernel/weight_cache.h"
 #include <gtest/gtest.h>
 
 using namespace refactor;
@@ -29,6 +34,8 @@ TEST(kernel, MatMulCPU_WithBias) {
     auto Y = Tensor::share(DataType::F32, Shape{2, 2});
     auto kernel = MatMulCPU::build(MatMulInfo(*A, *B, *C, false, false, 1, 1));
     ASSERT_TRUE(kernel);
+    // 2x2x2 的乘加和 2x2 的偏置乘加
+    EXPECT_EQ(kernel->cost().flops, 2 * 2 * 2 * 2 + 2 * 2 * 2);
     auto res = runtime::Resources();
     check<float>(std::move(res), kernel->lower(res).routine,
                  {2, 4, 1, 1.25},
@@ -72,3 +79,124 @@ TEST(kernel, MatMulCPU_Broadcast) {
                   1.0, 0.0, 0.0, 1.0},
                  {1.0, 0.0});
 }
+
+TEST(kernel, MatMulCPU_Gemm) {
+    // 覆盖各个微内核的整块和边角、转置、缩放与累加
+    size_t const shapes[][3]{{1, 1, 1}, {5, 7, 3}, {17, 300, 45}, {130, 513, 270}};
+    for (auto const &kernel : gemmMicroKernels<float>()) {
+        for (auto [m, k, n] : shapes) {
+            for (auto transA : {false, true}) {
+                for (auto transB : {false, true}) {
+                    for (auto beta : {0.0f, 0.5f}) {
+                        auto a = randomVector(m * k, 1), b = randomVector(k * n, 2), y = randomVector(m * n, 3);
+                        auto ans = y;
+                        MatMulCPUMetaData<float, float>{
+                            m, k, n,
+                            transA ? 1 : k, transA ? m : 1,
+                            transB ? 1 : n, transB ? k : 1,
+                            1.5f, beta}
+                            .matrixMultiply(a.data(), b.data(), ans.data());
+                        CpuGemm<float>(m, k, n, transA, transB, 1.5f, beta, &kernel)(a.data(), b.data(), y.data());
+                        for (auto i : range0_(y.size())) {
+                            ASSERT_NEAR(y[i], ans[i], 1e-4 * k)
+                                << kernel.isa << " " << m << "x" << k << "x" << n
+                                << " transA=" << transA << " transB=" << transB << " beta=" << beta;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(kernel, DISABLED_MatMulCPU_GemmBenchmark) {
+    struct Case {
+        std::string_view name;
+        size_t batch, m, k, n;
+    } const cases[]{
+        {"bert qkv (128 tokens)", 1, 128, 768, 2304},
+        {"bert ffn (128 tokens)", 1, 128, 768, 3072},
+        {"attention scores", 12, 128, 64, 128},
+        {"llm decode step", 1, 1, 4096, 4096},
+        {"resnet 3x3 conv (im2col)", 1, 3136, 576, 64},
+        {"resnet 1x1 conv", 1, 784, 512, 128},
+    };
+
+    auto gflops = [](Case const &c, auto &&f) {
+        return 2.0 * c.batch * c.m * c.k * c.n / secondsPerRun(f) / 1e9;
+    };
+
+    fmt::println("GFLOP/s of f32 matmul, naive kernel against the packed gemm with each micro-kernel and with B pre-packed");
+    for (auto const &c : cases) {
+        auto a = randomVector(c.batch * c.m * c.k, 1), b = randomVector(c.batch * c.k * c.n, 2);
+        std::vector<float> y(c.batch * c.m * c.n);
+        MatMulCPUMetaData<float, float> const naive{c.m, c.k, c.n, c.k, 1, c.n, 1, 1, 0};
+        std::string line = fmt::format("  {:<26} {:>2}x{:>4}x{:>4}x{:>4}  naive {:7.2f}",
+                                       c.name, c.batch, c.m, c.k, c.n,
+                                       gflops(c, [&] {
+                                           for (auto i : range0_(c.batch)) {
+                                               naive.matrixMultiply(a.data() + i * c.m * c.k, b.data() + i * c.k * c.n, y.data() + i * c.m * c.n);
+                                           }
+                                       }));
+        for (auto const &kernel : gemmMicroKernels<float>()) {
+            CpuGemm<float> const gemm(c.m, c.k, c.n, false, false, 1, 0, &kernel);
+            line += fmt::format("  {} {:7.2f}", kernel.isa,
+                                gflops(c, [&] { gemm(a.data(), b.data(), y.data(), c.batch); }));
+        }
+        // B 是常量时预先打包，运行时只打包 A
+        CpuGemm<float> const gemm(c.m, c.k, c.n, false, false, 1, 0);
+        std::vector<float> packed(gemm.packedSize() * c.batch);
+        for (auto i : range0_(c.batch)) {
+            gemm.packB(b.data() + i * c.k * c.n, packed.data() + i * gemm.packedSize());
+        }
+        line += fmt::format("  pre-packed {:7.2f}",
+                            gflops(c, [&] { gemm(a.data(), packed.data(), y.data(), c.batch, nullptr, true); }));
+        fmt::println("{}", line);
+    }
+}
+
+TEST(kernel, MatMulCPU_PrepackedB) {
+    // A 的批次广播到常量 B 上，B 转置
+    auto A = Tensor::share(DataType::F32, Shape{2, 5, 300});
+    auto B = Tensor::share(DataType::F32, Shape{45, 300});
+    auto a = randomVector(A->elementsSize(), 1), b = randomVector(B->elementsSize(), 2);
+    std::memcpy(B->malloc(), b.data(), B->bytesSize());
+    auto info = MatMulInfo(*A, *B, std::nullopt, false, true, 1, 1);
+
+    auto &cache = WeightCache::instance();
+    auto before = cache.stats();
+    auto run = [&](Kernel const &kernel, Resources &res) {
+        auto routine = kernel.lower(res).routine;
+        std::vector<float> y(2 * 5 * 45);
+        void const *inputs[]{a.data(), b.data()};
+        void *outputs[]{y.data()};
+        routine(res, nullptr, inputs, outputs);
+        return y;
+    };
+
+    auto plain = MatMulCPU::build(info), packed = MatMulCPU::build(info, B->data);
+    auto res0 = Resources(), res1 = Resources();
+    auto ans = run(*plain, res0);
+    // 打包不改变累加的顺序，结果完全相同
+    EXPECT_EQ(run(*packed, res1), ans);
+    EXPECT_FALSE(res0.fetch<PackedWeights>());
+    auto weights = res1.fetch<PackedWeights>();
+    ASSERT_TRUE(weights);
+    ASSERT_EQ(weights->blobs.size(), 1);
+    EXPECT_GE(weights->bytes(), B->bytesSize());
+    EXPECT_EQ(cache.stats().derived, before.derived + weights->bytes());
+
+    // 分叉出的资源表共享打包的副本，重新降级复用仍然存活的副本
+    auto forked = res1.fork();
+    EXPECT_EQ(forked.fetch<PackedWeights>(), weights);
+    auto res2 = Resources();
+    EXPECT_EQ(run(*packed, res2), ans);
+    EXPECT_EQ(res2.fetch<PackedWeights>()->blobs[0].first, weights->blobs[0].first);
+    EXPECT_EQ(cache.stats().derived, before.derived + weights->bytes());
+
+    // 最后一个资源表释放后副本随之释放
+    res1 = Resources();
+    forked = Resources();
+    res2 = Resources();
+    EXPECT_EQ(cache.stats().derived, before.derived);
+}
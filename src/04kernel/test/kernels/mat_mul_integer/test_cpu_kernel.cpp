@@ -12,12 +12,13 @@ TEST(kernel, MatMulIntegerCpu) {
     auto kernel = MatMulIntegerCpu::build(MatMulIntegerInfo(TensorRefs{*A, *B}));
     ASSERT_TRUE(kernel);
     auto res = runtime::Resources();
-    auto [routine, workspaceSize] = kernel->lower(res);
+    auto lowered = kernel->lower(res);
+    auto const &routine = lowered.routine;
     // put input data
     std::vector<uint8_t>
         dataA{1, 2, 3, 4, 5, 6},
         dataB{1, 2, 3},
-        workspace(workspaceSize);
+        workspace(lowered.workspaceSize);
     std::vector<int32_t>
         result(Y->elementsSize()),
         ans{14, 32};
@@ -20,9 +20,11 @@ TEST(kernel, MatMulIntegerCublas) {
     auto gpuKernel = MatMulIntegerCublas::build(info);
     ASSERT_TRUE(cpuKernel && gpuKernel);
     auto res = runtime::Resources();
-    auto [cpuRoutine, workspace] = cpuKernel->lower(res);
-    auto [gpuRoutine, workspace_] = gpuKernel->lower(res);
-    ASSERT_EQ(workspace, workspace_);
+    auto cpuLowered = cpuKernel->lower(res),
+         gpuLowered = gpuKernel->lower(res);
+    auto const &cpuRoutine = cpuLowered.routine,
+               &gpuRoutine = gpuLowered.routine;
+    ASSERT_EQ(cpuLowered.workspaceSize, gpuLowered.workspaceSize);
     // put input data
     std::vector<uint8_t>
         dataA(A->elementsSize()),
@@ -0,0 +1,281 @@
+#include "../src/kernels/pool/cpu_kernel.hh"
+#include "../src/kernels/pool/global_cpu_kernel.hh"
+#include "../helpers.h"
+#include <cmath>
+#include <gtest/gtest.h>
+
+using namespace refactor;
+using namespace kernel;
+
+struct PoolCase {
+    size_t n, c, h, w, kh, kw;
+    int64_t dilations[2], pads[4], strides[2];
+    bool ceil, countIncludePad;
+
+    size_t out(int i) const {
+        auto in = static_cast<int64_t>(i ? w : h), k = static_cast<int64_t>(i ? kw : kh),
+             s = strides[i], pb = pads[i];
+        auto span = in + pb + pads[i + 2] - (k - 1) * dilations[i] - 1;
+        auto ans = (ceil ? span + s - 1 : span) / s + 1;
+        if (ceil && (ans - 1) * s >= in + pb) { --ans; }
+        return ans;
+    }
+    size_t ho() const { return out(0); }
+    size_t wo() const { return out(1); }
+    size_t inputs() const { return n * c * h * w; }
+    size_t outputs() const { return n * c * ho() * wo(); }
+    PoolAttributes attributes() const { return PoolAttributes(2, dilations, pads, strides); }
+    KernelShape kernelShape() const { return {static_cast<ddim_t>(kh), static_cast<ddim_t>(kw)}; }
+};
+
+// 逐个输出元素计算的 NCHW 池化，作为参考结果和性能基准
+static void naivePool(PoolType type, int64_t p, PoolCase const &c, float const *x, float *y) {
+    auto ho = c.ho(), wo = c.wo();
+    auto inside = [](int64_t i, int64_t lo, int64_t hi) { return lo <= i && i < hi; };
+    for (auto plane : range0_(c.n * c.c))
+        for (auto oh : range0_(ho))
+            for (auto ow : range0_(wo)) {
+                float acc = type == PoolType::Max ? -INFINITY : 0;
+                size_t count = 0;
+                for (auto kh : range0_(c.kh))
+                    for (auto kw : range0_(c.kw)) {
+                        int64_t ih = oh * c.strides[0] + kh * c.dilations[0] - c.pads[0],
+                                iw = ow * c.strides[1] + kw * c.dilations[1] - c.pads[1];
+                        if (c.countIncludePad &&
+                            inside(ih, -c.pads[0], c.h + c.pads[2]) &&
+                            inside(iw, -c.pads[1], c.w + c.pads[3])) {
+                            ++count;
+                        }
+                        if (!inside(ih, 0, c.h) || !inside(iw, 0, c.w)) { continue; }
+                        if (!c.countIncludePad) { ++count; }
+                        auto v = x[(plane * c.h + ih) * c.w + iw];
+                        switch (type) {
+                            case PoolType::Max:
+                                acc = std::max(acc, v);
+                                break;
+                            case PoolType::Average:
+                                acc += v;
+                                break;
+                            default:
+                                acc += std::pow(std::abs(v), static_cast<float>(p));
+                                break;
+                        }
+                    }
+                auto &ans = y[(plane * ho + oh) * wo + ow];
+                switch (type) {
+                    case PoolType::Max:
+                        ans = acc;
+                        break;
+                    case PoolType::Average:
+                        ans = acc / count;
+                        break;
+                    default:
+                        ans = std::pow(acc, 1.f / p);
+                        break;
+                }
+            }
+}
+
+// [N,C,HW] -> [N,HW,C]
+static std::vector<float> toNHWC(std::vector<float> const &src, size_t n, size_t c, size_t hw) {
+    std::vector<float> ans(src.size());
+    for (auto i : range0_(n))
+        for (auto j : range0_(c))
+            for (auto k : range0_(hw))
+                ans[(i * hw + k) * c + j] = src[(i * c + j) * hw + k];
+    return ans;
+}
+
+static KernelBox buildPool(PoolType type, int64_t p, PoolCase const &c, bool nhwc) {
+    auto layout = nhwc ? LayoutType::NHWC : LayoutType::NCHW;
+    auto shape = [&](size_t h, size_t w) {
+        return nhwc ? Shape{dim_t(c.n), dim_t(h), dim_t(w), dim_t(c.c)}
+                    : Shape{dim_t(c.n), dim_t(c.c), dim_t(h), dim_t(w)};
+    };
+    auto x = Tensor::share(DataType::F32, shape(c.h, c.w), layout),
+         y = Tensor::share(DataType::F32, shape(c.ho(), c.wo()), layout);
+    return PoolCpu::build(type, c.ceil, c.countIncludePad, p, c.kernelShape(), c.attributes(), *x, *y);
+}
+
+static std::vector<float> runPool(Kernel const &kernel, std::vector<float> const &x, size_t outputs) {
+    auto res = runtime::Resources();
+    auto routine = kernel.lower(res).routine;
+    std::vector<float> y(outputs);
+    void const *inputs[]{x.data()};
+    void *outputs_[]{y.data()};
+    routine(res, nullptr, inputs, outputs_);
+    return y;
+}
+
+static void testPool(PoolType type, int64_t p, PoolCase const &c) {
+    auto x = randomVector(c.inputs(), 7);
+    std::vector<float> ans(c.outputs());
+    naivePool(type, p, c, x.data(), ans.data());
+
+    auto kernel = buildPool(type, p, c, false);
+    ASSERT_TRUE(kernel);
+    auto y = runPool(*kernel, x, c.outputs());
+    for (auto i : range0_(ans.size())) {
+        ASSERT_NEAR(y[i], ans[i], 1e-5) << "nchw at " << i;
+    }
+
+    kernel = buildPool(type, p, c, true);
+    ASSERT_TRUE(kernel);
+    y = runPool(*kernel, toNHWC(x, c.n, c.c, c.h * c.w), c.outputs());
+    ans = toNHWC(ans, c.n, c.c, c.ho() * c.wo());
+    for (auto i : range0_(ans.size())) {
+        ASSERT_NEAR(y[i], ans[i], 1e-5) << "nhwc at " << i;
+    }
+}
+
+static PoolCase const CASES[]{
+    {2, 3, 9, 11, 3, 3, {1, 1}, {0, 0, 0, 0}, {1, 1}, false, false},
+    {2, 3, 9, 11, 3, 3, {1, 1}, {1, 1, 1, 1}, {2, 2}, false, false},
+    {1, 5, 12, 10, 2, 3, {1, 1}, {0, 1, 1, 0}, {2, 3}, false, false},
+    {1, 4, 13, 13, 3, 3, {2, 2}, {2, 1, 2, 1}, {1, 2}, false, false},
+    {2, 3, 10, 10, 3, 3, {1, 1}, {0, 0, 0, 0}, {2, 2}, true, false},
+    {1, 4, 11, 9, 3, 2, {1, 2}, {1, 0, 1, 1}, {3, 2}, true, false},
+    // 输出行足够长，按行累加
+    {1, 3, 9, 40, 3, 3, {1, 1}, {1, 1, 1, 1}, {1, 1}, false, false},
+    {1, 2, 8, 70, 3, 3, {1, 2}, {1, 2, 0, 1}, {2, 2}, true, false},
+};
+
+TEST(kernel, PoolCpu_Max) {
+    for (auto const &c : CASES) {
+        testPool(PoolType::Max, 2, c);
+    }
+}
+
+TEST(kernel, PoolCpu_Average) {
+    for (auto c : CASES) {
+        testPool(PoolType::Average, 2, c);
+        c.countIncludePad = true;
+        testPool(PoolType::Average, 2, c);
+    }
+}
+
+TEST(kernel, PoolCpu_Lp) {
+    for (auto p : {1, 2, 3}) {
+        for (auto const &c : CASES) {
+            testPool(PoolType::Lp, p, c);
+        }
+    }
+}
+
+TEST(kernel, PoolCpu_1D) {
+    // 1D 池化与 H 为 1 的 2D 池化结果相同
+    PoolCase c{2, 3, 1, 17, 1, 3, {1, 2}, {0, 1, 0, 2}, {1, 2}, true, true};
+    auto x = randomVector(c.inputs(), 11);
+    std::vector<float> ans(c.outputs());
+    naivePool(PoolType::Average, 2, c, x.data(), ans.data());
+
+    int64_t const dilations[]{2}, pads[]{1, 2}, strides[]{2};
+    auto xt = Tensor::share(DataType::F32, Shape{2, 3, 17}),
+         yt = Tensor::share(DataType::F32, Shape{2, 3, dim_t(c.wo())});
+    auto kernel = PoolCpu::build(PoolType::Average, true, true, 2, {3},
+                                 PoolAttributes(1, dilations, pads, strides), *xt, *yt);
+    ASSERT_TRUE(kernel);
+    auto y = runPool(*kernel, x, c.outputs());
+    for (auto i : range0_(ans.size())) {
+        ASSERT_NEAR(y[i], ans[i], 1e-5);
+    }
+}
+
+TEST(kernel, PoolCpu_Unsupported) {
+    auto const &c = CASES[1];
+    auto x = Tensor::share(DataType::F32, Shape{2, 3, 9, 11});
+    // 输出形状与参数不一致
+    auto y = Tensor::share(DataType::F32, Shape{2, 3, 4, 5});
+    EXPECT_FALSE(PoolCpu::build(PoolType::Max, false, false, 2, c.kernelShape(), c.attributes(), *x, *y));
+    // 整数类型
+    auto xi = Tensor::share(DataType::I32, Shape{2, 3, 9, 11}),
+         yi = Tensor::share(DataType::I32, Shape{2, 3, 5, 6});
+    EXPECT_FALSE(PoolCpu::build(PoolType::Max, false, false, 2, c.kernelShape(), c.attributes(), *xi, *yi));
+    // 3D 池化
+    int64_t const ones[]{1, 1, 1}, zeros[]{0, 0, 0, 0, 0, 0};
+    auto x3 = Tensor::share(DataType::F32, Shape{1, 2, 4, 4, 4}),
+         y3 = Tensor::share(DataType::F32, Shape{1, 2, 2, 2, 2});
+    EXPECT_FALSE(PoolCpu::build(PoolType::Max, false, false, 2, {3, 3, 3},
+                                PoolAttributes(3, ones, zeros, ones), *x3, *y3));
+}
+
+TEST(kernel, GlobalPoolCpu) {
+    size_t n = 2, c = 37, h = 7, w = 9;
+    auto x = randomVector(n * c * h * w, 13);
+    struct {
+        PoolType type;
+        int64_t p;
+    } const cases[]{
+        {PoolType::Max, 2},
+        {PoolType::Average, 2},
+        {PoolType::Lp, 1},
+        {PoolType::Lp, 2},
+        {PoolType::Lp, 3},
+    };
+    for (auto [type, p] : cases) {
+        PoolCase whole{n, c, h, w, h, w, {1, 1}, {0, 0, 0, 0}, {1, 1}, false, false};
+        std::vector<float> ans(n * c);
+        naivePool(type, p, whole, x.data(), ans.data());
+
+        for (auto nhwc : {false, true}) {
+            auto layout = nhwc ? LayoutType::NHWC : LayoutType::NCHW;
+            auto xt = Tensor::share(DataType::F32, nhwc ? Shape{2, 7, 9, 37} : Shape{2, 37, 7, 9}, layout),
+                 yt = Tensor::share(DataType::F32, nhwc ? Shape{2, 1, 1, 37} : Shape{2, 37, 1, 1}, layout);
+            auto kernel = GlobalPoolCpu::build(type, p, *xt, *yt);
+            ASSERT_TRUE(kernel);
+            auto y = runPool(*kernel, nhwc ? toNHWC(x, n, c, h * w) : x, n * c);
+            for (auto i : range0_(ans.size())) {
+                ASSERT_NEAR(y[i], ans[i], 1e-5 * std::max(1.f, std::abs(ans[i]))) << type.toString() << (nhwc ? " nhwc" : " nchw");
+            }
+        }
+    }
+}
+
+TEST(kernel, DISABLED_PoolCpu_Benchmark) {
+    struct Layer {
+        std::string_view name;
+        PoolType type;
+        PoolCase c;
+    } const layers[]{
+        {"resnet50 maxpool 3x3/2", PoolType::Max, {1, 64, 112, 112, 3, 3, {1, 1}, {1, 1, 1, 1}, {2, 2}, false, false}},
+        {"googlenet maxpool 3x3/2", PoolType::Max, {1, 192, 56, 56, 3, 3, {1, 1}, {0, 0, 0, 0}, {2, 2}, true, false}},
+        {"inception avgpool 3x3/1", PoolType::Average, {1, 288, 35, 35, 3, 3, {1, 1}, {1, 1, 1, 1}, {1, 1}, false, false}},
+        {"vgg16 maxpool 2x2/2", PoolType::Max, {1, 128, 112, 112, 2, 2, {1, 1}, {0, 0, 0, 0}, {2, 2}, false, false}},
+        {"resnet50 avgpool 7x7 x8", PoolType::Average, {8, 2048, 7, 7, 7, 7, {1, 1}, {0, 0, 0, 0}, {1, 1}, false, false}},
+    };
+
+    auto micros = [](auto &&f) { return secondsPerRun(f) * 1e6; };
+
+    fmt::println("us per f32 pool, naive loop against the windowed CPU kernel in NCHW and NHWC and the global kernel");
+    for (auto const &[name, type, c] : layers) {
+        auto x = randomVector(c.inputs(), 1);
+        std::vector<float> y(c.outputs());
+        auto line = fmt::format("  {:<26} naive {:9.1f}", name,
+                                micros([&] { naivePool(type, 2, c, x.data(), y.data()); }));
+        for (auto nhwc : {false, true}) {
+            auto kernel = buildPool(type, 2, c, nhwc);
+            auto res = runtime::Resources();
+            auto routine = kernel->lower(res).routine;
+            void const *inputs[]{x.data()};
+            void *outputs[]{y.data()};
+            line += fmt::format("  {} {:9.1f}", nhwc ? "nhwc" : "nchw",
+                                micros([&] { routine(res, nullptr, inputs, outputs); }));
+        }
+        // 窗口覆盖整个平面时也可以用全局池化计算
+        if (c.ho() == 1 && c.wo() == 1) {
+            for (auto nhwc : {false, true}) {
+                auto layout = nhwc ? LayoutType::NHWC : LayoutType::NCHW;
+                auto xt = Tensor::share(DataType::F32, nhwc ? Shape{dim_t(c.n), dim_t(c.h), dim_t(c.w), dim_t(c.c)} : Shape{dim_t(c.n), dim_t(c.c), dim_t(c.h), dim_t(c.w)}, layout),
+                     yt = Tensor::share(DataType::F32, nhwc ? Shape{dim_t(c.n), 1, 1, dim_t(c.c)} : Shape{dim_t(c.n), dim_t(c.c), 1, 1}, layout);
+                auto kernel = GlobalPoolCpu::build(type, 2, *xt, *yt);
+                auto res = runtime::Resources();
+                auto routine = kernel->lower(res).routine;
+                void const *inputs[]{x.data()};
+                void *outputs[]{y.data()};
+                line += fmt::format("  global {} {:9.1f}", nhwc ? "nhwc" : "nchw",
+                                    micros([&] { routine(res, nullptr, inputs, outputs); }));
+            }
+        }
+        fmt::println("{}", line);
+    }
+}
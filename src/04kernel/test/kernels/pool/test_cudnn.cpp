@@ -16,7 +16,7 @@ void testPoolCudnn(PoolType poolType, int rank, const int64_t *pads, const int64
     int64_t const dilations[] = {1, 1};
     PoolAttributes poolAttributes(rank, dilations, pads, strides);
 
-    auto kernel = PoolCudnn::build(poolType, ceil, kernelShape, poolAttributes, *dataTensor, *yTensor);
+    auto kernel = PoolCudnn::build(poolType, ceil, false, kernelShape, poolAttributes, *dataTensor, *yTensor);
     ASSERT_TRUE(kernel);
     auto res = runtime::Resources();
     auto routine = kernel->lower(res).routine;
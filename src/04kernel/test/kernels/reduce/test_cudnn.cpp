@@ -15,10 +15,11 @@ static void testReducemean(const Shape &shape, const std::vector<float> &data,
     auto kernel = ReduceCudnn::build(axes, ReduceType::Mean, {*dataTensor});
     ASSERT_TRUE(kernel);
     auto res = runtime::Resources();
-    auto [routine, workspaceSize] = kernel->lower(res);
+    auto lowered = kernel->lower(res);
+    auto const &routine = lowered.routine;
     // cuda malloc
     auto &dev = *device::init(Device::Type::Nvidia, 0, "");
-    auto workspace = dev.malloc(workspaceSize),
+    auto workspace = dev.malloc(lowered.workspaceSize),
          gpuMemIn = dev.malloc(dataTensor->bytesSize()),
          gpuMemOut = dev.malloc(dataTensor->bytesSize());
     // put input output data
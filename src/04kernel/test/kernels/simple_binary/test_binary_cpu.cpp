@@ -111,3 +111,32 @@ TEST(kernel, BinaryCpuBroadcast) {
         EXPECT_FLOAT_EQ(18, x);
     }
 }
+
+TEST(kernel, BinaryCpuInplace) {
+    // build routine
+    auto a = Tensor::share(DataType::F32, Shape{20, 30, 50});
+    auto b = Tensor::share(DataType::F32, Shape{30, 1});
+    auto kernel = BinaryCpu::build(SimpleBinaryType::Sub, *a, *b);
+    ASSERT_TRUE(kernel);
+    // 被广播的 b 不能被输出覆盖
+    EXPECT_EQ(kernel->inplace(), std::vector<count_t>{0});
+    EXPECT_EQ(BinaryCpu::build(SimpleBinaryType::Sub, *a, *a)->inplace(), (std::vector<count_t>{0, 1}));
+    auto res = runtime::Resources();
+    auto routine = kernel->lower(res).routine;
+    // put input data
+    std::vector<float>
+        dataA(a->elementsSize()),
+        dataB(b->elementsSize());
+    for (auto i : range0_(dataA.size())) { dataA[i] = i; }
+    for (auto i : range0_(dataB.size())) { dataB[i] = i; }
+    // inference
+    {
+        void const *inputs[]{dataA.data(), dataB.data()};
+        void *outputs[]{dataA.data()};
+        routine(res, nullptr, inputs, outputs);
+    }
+    // check
+    for (auto i : range0_(dataA.size())) {
+        EXPECT_FLOAT_EQ(i - i / 50 % 30, dataA[i]);
+    }
+}
@@ -60,3 +60,33 @@ TEST(kernel, SplitCpu) {
         }
     }
 }
+
+TEST(kernel, SplitCpuZeroCopy) {
+    // 沿最外层的非 1 维切分，每个输出都是输入中的连续区间
+    auto dataTensor = Tensor::share(DataType::F32, Shape{1, 20, 7, 7});
+    std::vector<Arc<Tensor>> outputTensors{
+        Tensor::share(DataType::F32, Shape{1, 4, 7, 7}),
+        Tensor::share(DataType::F32, Shape{1, 16, 7, 7}),
+    };
+    auto kernel = SplitCpu::build(SplitInfo(1, {*outputTensors[0], *outputTensors[1]}));
+    ASSERT_TRUE(kernel);
+    auto sub = kernel->subBuffers();
+    EXPECT_EQ(sub.side, runtime::SubBuffers::Side::Outputs);
+    EXPECT_EQ(sub.offsets, (std::vector<size_t>{0, outputTensors[0]->bytesSize()}));
+
+    auto res = runtime::Resources();
+    auto routine = kernel->lower(res).routine;
+    std::vector<float> data(dataTensor->elementsSize());
+    std::iota(data.begin(), data.end(), 0);
+    auto answer = data;
+    // 输出已经指向输入中的对应区间，例程不再复制，输入保持不变
+    void const *inputs[]{data.data()};
+    void *outputs[]{data.data(), data.data() + outputTensors[0]->elementsSize()};
+    routine(res, nullptr, inputs, outputs);
+    EXPECT_EQ(data, answer);
+    // 部分输出不在对应区间时只复制这些输出
+    std::vector<float> second(outputTensors[1]->elementsSize());
+    outputs[1] = second.data();
+    routine(res, nullptr, inputs, outputs);
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), answer.begin() + outputTensors[0]->elementsSize()));
+}
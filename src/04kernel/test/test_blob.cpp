@@ -0,0 +1,112 @@
+#include "hardware/device_manager.h"
+#include "kernel/allocators.h"
+#include "kernel/graph.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <unistd.h>
+
+using namespace refactor;
+using namespace kernel;
+
+// 写入一个测试文件，前 `head` 字节之后是 `n` 个递增的 float
+static std::string writeFile(std::string name, size_t head, size_t n) {
+    auto path = (std::filesystem::temp_directory_path() / name).string();
+    std::vector<float> data(n);
+    std::iota(data.begin(), data.end(), 0.f);
+    std::ofstream file(path, std::ios::binary);
+    file << std::string(head, 'x');
+    file.write(reinterpret_cast<char const *>(data.data()), n * sizeof(float));
+    return path;
+}
+
+// 进程当前的常驻内存
+static size_t rss() {
+    size_t pages = 0, resident = 0;
+    std::ifstream("/proc/self/statm") >> pages >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// 一个节点的图，权重 w 是唯一的输入
+static Graph weightGraph(Arc<Blob> data, size_t size) {
+    graph_topo::Builder<count_t, Node, count_t, Edge> builder{{}, {}, {1}, {}, {}};
+    builder.topology.insert({0, {{0}, {1}}});
+    builder.nodes.insert({0, Node{nullptr, "n"}});
+    builder.edges.insert({0, {std::move(data), size, "w"}});
+    builder.edges.insert({1, {nullptr, size, "y"}});
+    auto [topology, nodes, edges] = builder.build();
+    return Graph(std::move(topology), std::move(nodes), std::move(edges));
+}
+
+TEST(kernel, BlobMap) {
+    constexpr static size_t N = 3000;
+    // 数据的起点不按页对齐
+    auto path = writeFile("blob_map.bin", 123, N);
+    for (auto prefetch : {false, true}) {
+        auto blob = Blob::map(path, 123, N * sizeof(float), prefetch);
+        EXPECT_TRUE(blob->mapped());
+        auto data = blob->get<float>();
+        for (auto i : range0_(N)) { ASSERT_EQ(data[i], i); }
+    }
+    EXPECT_FALSE(Blob::share(16).first->mapped());
+    EXPECT_THROW(Blob::map(path, 123, N * sizeof(float) + 1), std::runtime_error);
+    EXPECT_THROW(Blob::map(path + ".missing", 0, 4), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(kernel, BlobMapZeroCopy) {
+    constexpr static size_t N = 1024;
+    auto path = writeFile("blob_map_zero_copy.bin", 0, N);
+    auto blob = Blob::map(path, 0, N * sizeof(float));
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto stream = weightGraph(blob, N * sizeof(float)).lower(cpu, reusableAllocate);
+    auto const &edges = stream.graph().edges;
+    auto w = std::find_if(edges.begin(), edges.end(), [](auto const &e) { return e.name == "w"; });
+    ASSERT_NE(w, edges.end());
+    // CPU 上的权重就是文件映射本身
+    EXPECT_EQ(w->blob->get(), blob->get<void>());
+    std::filesystem::remove(path);
+}
+
+TEST(kernel, DISABLED_BlobMapStartup) {
+    constexpr static size_t N = 64ul << 20;
+    constexpr static size_t BYTES = N * sizeof(float);
+    auto path = writeFile("blob_map_startup.bin", 0, N);
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+
+    // 比较读入堆内存再复制到设备，与直接映射文件两种方式载入权重并降级的耗时和常驻内存
+    fmt::println("load and lower a {} MiB weight on cpu", BYTES >> 20);
+    for (auto map : {false, true}) {
+        using namespace std::chrono;
+        auto rss0 = rss();
+        auto t0 = high_resolution_clock::now();
+        Arc<Blob> blob;
+        if (map) {
+            blob = Blob::map(path, 0, BYTES);
+        } else {
+            auto [blob_, ptr] = Blob::share(BYTES);
+            std::ifstream(path, std::ios::binary).read(static_cast<char *>(ptr), BYTES);
+            blob = std::move(blob_);
+        }
+        auto stream = weightGraph(blob, BYTES).lower(cpu, reusableAllocate);
+        auto t1 = high_resolution_clock::now();
+        auto rss1 = rss();
+
+        // 推理访问全部权重后的常驻内存
+        auto const &edges = stream.graph().edges;
+        auto w = std::find_if(edges.begin(), edges.end(), [](auto const &e) { return e.name == "w"; });
+        auto data = w->blob->get<float>();
+        double sum = 0;
+        for (size_t i = 0; i < N; i += 1024) { sum += data[i]; }
+        EXPECT_GT(sum, 0);
+        auto rss2 = rss();
+
+        fmt::println("  {:<6} startup {:8.2f} ms, rss +{:>4} MiB after lowering, +{:>4} MiB after touching",
+                     map ? "mmap" : "read",
+                     duration_cast<duration<double, std::milli>>(t1 - t0).count(),
+                     (rss1 - rss0) >> 20, (rss2 - rss0) >> 20);
+    }
+    std::filesystem::remove(path);
+}
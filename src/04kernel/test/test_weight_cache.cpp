@@ -0,0 +1,122 @@
+#include "hardware/device_manager.h"
+#include "kernel/weight_cache.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace refactor;
+using namespace kernel;
+
+static Arc<Blob> weight(size_t n, float value) {
+    auto [blob, ptr] = Blob::share(n * sizeof(float));
+    std::fill_n(static_cast<float *>(ptr), n, value);
+    return blob;
+}
+
+TEST(kernel, WeightCacheRelease) {
+    auto &cache = WeightCache::instance();
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto data = weight(256, 1);
+
+    auto before = cache.stats();
+    auto a = cache.fetch(cpu, data, 1024),
+         b = cache.fetch(cpu, data, 1024);
+    // 同一份权重只有一个副本
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a->get<float>()[255], 1);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.resident, before.resident + 1024);
+    EXPECT_EQ(stats.misses, before.misses + 1);
+    EXPECT_EQ(stats.hits, before.hits + 1);
+    // 没有预算时，最后一个引用释放后副本随之释放
+    a = b = nullptr;
+    EXPECT_EQ(cache.stats().resident, before.resident);
+}
+
+TEST(kernel, WeightCacheBudget) {
+    auto &cache = WeightCache::instance();
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto x = weight(256, 1), y = weight(256, 2), z = weight(256, 3);
+
+    cache.setBudget(2048);
+    auto before = cache.stats();
+    cache.fetch(cpu, x, 1024);
+    cache.fetch(cpu, y, 1024);
+    cache.fetch(cpu, x, 1024);
+    // z 淘汰最久未用的 y
+    cache.fetch(cpu, z, 1024);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.pinned, 2048);
+    EXPECT_EQ(stats.resident, before.resident + 2048);
+    EXPECT_EQ(stats.evictions, before.evictions + 1);
+
+    cache.fetch(cpu, x, 1024);
+    cache.fetch(cpu, y, 1024);
+    stats = cache.stats();
+    EXPECT_EQ(stats.hits, before.hits + 2);
+    EXPECT_EQ(stats.misses, before.misses + 4);
+
+    // 流引用的副本不受预算约束
+    auto held = cache.fetch(cpu, z, 1024);
+    cache.setBudget(0);
+    stats = cache.stats();
+    EXPECT_EQ(stats.pinned, 0);
+    EXPECT_EQ(stats.resident, before.resident + 1024);
+    EXPECT_EQ(held->get<float>()[0], 3);
+}
+
+TEST(kernel, WeightCacheAddressReuse) {
+    auto &cache = WeightCache::instance();
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    cache.setBudget(1 << 20);
+    // 权重释放后新的权重可能复用同一个地址，不能取到旧的副本
+    for (auto i : range0_(8)) {
+        auto data = weight(256, static_cast<float>(i));
+        EXPECT_EQ(cache.fetch(cpu, data, 1024)->get<float>()[0], i);
+    }
+    cache.clear();
+    cache.setBudget(0);
+    EXPECT_EQ(cache.stats().pinned, 0);
+}
+
+TEST(kernel, WeightCacheModels) {
+    auto &cache = WeightCache::instance();
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto shared = weight(256, 1), own = weight(512, 2);
+
+    auto a0 = cache.fetch(cpu, shared, 1024, "a"),
+         a1 = cache.fetch(cpu, own, 2048, "a"),
+         b0 = cache.fetch(cpu, shared, 1024, "b"),
+         // 同一个模型再编译一次，副本只计一次
+        b1 = cache.fetch(cpu, shared, 1024, "b");
+    auto models = cache.stats().models;
+    EXPECT_EQ(models["a"], 3072);
+    EXPECT_EQ(models["b"], 1024);
+
+    a0 = a1 = nullptr;
+    models = cache.stats().models;
+    EXPECT_EQ(models["a"], 1024);
+    b0 = b1 = nullptr;
+    models = cache.stats().models;
+    EXPECT_FALSE(models.contains("a"));
+    EXPECT_FALSE(models.contains("b"));
+}
+
+TEST(kernel, WeightCacheThreads) {
+    constexpr static size_t THREADS = 8;
+    auto &cache = WeightCache::instance();
+    auto cpu = hardware::device::fetch(hardware::Device::Type::Cpu);
+    auto data = weight(1 << 16, 7);
+
+    auto before = cache.stats();
+    std::vector<Arc<hardware::Device::Blob>> blobs(THREADS);
+    std::vector<std::thread> threads;
+    for (auto i : range0_(THREADS)) {
+        threads.emplace_back([&, i] { blobs[i] = cache.fetch(cpu, data, 1 << 18, "threads"); });
+    }
+    for (auto &t : threads) { t.join(); }
+    // 同时缺失的线程各自复制，但最终都使用同一个副本
+    for (auto const &blob : blobs) { EXPECT_EQ(blob, blobs[0]); }
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.resident, before.resident + (1 << 18));
+    EXPECT_EQ(stats.models["threads"], 1 << 18);
+}
@@ -26,6 +26,8 @@ namespace refactor::computation {
         Graph(graph_topo::GraphTopo, std::vector<Node>, std::vector<Edge>) noexcept;
 
         void layoutPermute();
+        /// @brief 重排节点以降低按张量大小估计的激活内存峰值，返回重排前后估计的峰值字节数。
+        std::pair<size_t, size_t> reorderForMemory();
 
         kernel::Graph lower(Target) const;
         auto internal() const -> decltype(_internal) const &;
@@ -9,9 +9,10 @@ namespace refactor::computation {
 
     struct GlobalPool final : public Operator {
         PoolType type;
+        int64_t p;
 
-        constexpr GlobalPool(PoolType type_) noexcept
-            : Operator(), type(type_) {}
+        constexpr GlobalPool(PoolType type_, int64_t p_) noexcept
+            : Operator(), type(type_), p(p_) {}
 
         static size_t typeId(PoolType) noexcept;
         size_t opTypeId() const noexcept final;
@@ -11,11 +11,12 @@ namespace refactor::computation {
 
     struct Pool final : public Operator {
         PoolType type;
-        bool ceil;
+        bool ceil, countIncludePad;
+        int64_t p;
         KernelShape kernelShape;
         PoolAttributes attributes;
 
-        Pool(PoolType, bool, decltype(kernelShape), PoolAttributes) noexcept;
+        Pool(PoolType, bool, bool, int64_t, decltype(kernelShape), PoolAttributes) noexcept;
 
         static size_t typeId(PoolType) noexcept;
         size_t opTypeId() const noexcept final;
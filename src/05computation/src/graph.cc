@@ -44,7 +44,13 @@ namespace refactor::computation {
                            std::back_inserter(outputs_), [&](auto i) {
                                return std::cref(*graph.edges[i].tensor);
                            });
-            auto candidates = op->candidateKernels(target)->filter(std::move(inputs_), std::move(outputs_));
+            // 全图输入即使带有数据也可能在运行前被替换，不作为初始值
+            std::vector<bool> initializers(inputs.size());
+            std::transform(inputs.begin(), inputs.end(),
+                           initializers.begin(), [&](auto i) {
+                               return graph.edges[i].tensor->data && i >= graph.topology.globalInputsCount();
+                           });
+            auto candidates = op->candidateKernels(target)->filter(std::move(inputs_), std::move(outputs_), initializers);
             if (!candidates.empty()) {
                 nodes[nodeIdx].kernel = std::move(candidates.front());
             } else {
@@ -38,10 +38,10 @@ namespace refactor::computation {
     }
     auto Op::candidateKernels(Target target) const noexcept -> kernel::CollectorBox {
         using Collector_ = kernel::GlobalPoolCollector;
-        return std::make_unique<Collector_>(target, type);
+        return std::make_unique<Collector_>(target, type, p);
     }
     auto Op::serialize() const noexcept -> std::string {
-        return fmt::format("{}()", name());
+        return fmt::format("{}({})", name(), p);
     }
 
 }// namespace refactor::computation
@@ -5,11 +5,15 @@ namespace refactor::computation {
 
     Op::Pool(PoolType type_,
              bool ceil_,
+             bool countIncludePad_,
+             int64_t p_,
              decltype(kernelShape) kernelShape_,
              PoolAttributes attrs) noexcept
         : Operator(),
           type(type_),
           ceil(ceil_),
+          countIncludePad(countIncludePad_),
+          p(p_),
           kernelShape(std::move(kernelShape_)),
           attributes(std::move(attrs)) {}
 
@@ -48,12 +52,14 @@ namespace refactor::computation {
     }
     auto Op::candidateKernels(Target target) const noexcept -> kernel::CollectorBox {
         using Collector_ = kernel::PoolCollector;
-        return std::make_unique<Collector_>(target, type, ceil, kernelShape, attributes);
+        return std::make_unique<Collector_>(target, type, ceil, countIncludePad, p, kernelShape, attributes);
     }
     auto Op::serialize() const noexcept -> std::string {
-        return fmt::format("{}({}, {}, {})",
+        return fmt::format("{}({}, {}, {}, {}, {})",
                            name(),
                            ceil,
+                           countIncludePad,
+                           p,
                            vec2str(kernelShape),
                            attributes.toString());
     }
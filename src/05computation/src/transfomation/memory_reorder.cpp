@@ -0,0 +1,154 @@
+﻿#include "computation/graph.h"
+#include <numeric>
+
+namespace refactor::computation {
+
+    /// @brief 按张量大小估计的各节点执行顺序下的内存占用。
+    ///        只计入节点产生的中间张量，权重和全图输入输出不在栈上；
+    ///        恒等算子的输出与输入共用存储，存储的生存期记在最初产生它的边上。
+    class MemoryEstimator {
+        constexpr static auto NONE = std::numeric_limits<count_t>::max();
+
+        std::vector<std::vector<count_t>> _inputs, _outputs, _successors;
+        std::vector<count_t> _owner, _uses;
+        std::vector<size_t> _sizes;
+        std::vector<bool> _pinned;
+
+    public:
+        explicit MemoryEstimator(graph_topo::Graph<Node, Edge> const &graph)
+            : _inputs(graph.nodes.size()),
+              _outputs(graph.nodes.size()),
+              _successors(graph.nodes.size()),
+              _owner(graph.edges.size()),
+              _uses(graph.edges.size(), 0),
+              _sizes(graph.edges.size(), 0),
+              _pinned(graph.edges.size(), false) {
+            std::iota(_owner.begin(), _owner.end(), 0);
+            std::unordered_set<count_t> globalOutputs;
+            std::vector<count_t> producer(graph.edges.size(), NONE);
+            auto it = graph.topology.begin(), end_ = graph.topology.end();
+            while (it != end_) {
+                auto [nodeIdx, inputs, outputs] = *it++;
+                _inputs[nodeIdx].assign(inputs.begin(), inputs.end());
+                _outputs[nodeIdx].assign(outputs.begin(), outputs.end());
+                for (auto e : inputs) {
+                    if (producer[e] != NONE) { _successors[producer[e]].push_back(nodeIdx); }
+                }
+                auto const &op = graph.nodes[nodeIdx].op;
+                auto identity = op && op->isIdentity() && !inputs.empty();
+                for (auto e : outputs) {
+                    producer[e] = nodeIdx;
+                    if (identity) {
+                        _owner[e] = _owner[inputs[0]];
+                    } else if (auto const &tensor = graph.edges[e].tensor; tensor && !tensor->data) {
+                        _sizes[e] = tensor->bytesSize();
+                    }
+                }
+            }
+            for (auto e : it.globalOutputs()) {
+                _sizes[e] = 0;
+                _pinned[_owner[e]] = true;
+            }
+            for (auto const &inputs : _inputs) {
+                for (auto e : inputs) { ++_uses[_owner[e]]; }
+            }
+        }
+
+        /// @brief 按 `order` 执行时同时存活的字节数的最大值。
+        size_t peak(std::vector<count_t> const &order) const {
+            auto remaining = _uses;
+            size_t live = 0, ans = 0;
+            for (auto n : order) {
+                for (auto e : _outputs[n]) {
+                    if (_owner[e] == e) { live += _sizes[e]; }
+                }
+                ans = std::max(ans, live);
+                for (auto e : _outputs[n]) {
+                    if (_owner[e] == e && !remaining[e] && !_pinned[e]) { live -= _sizes[e]; }
+                }
+                for (auto e : _inputs[n]) {
+                    if (auto o = _owner[e]; !--remaining[o] && !_pinned[o]) { live -= _sizes[o]; }
+                }
+            }
+            return ans;
+        }
+
+        /// @brief 贪心的列表调度：每一步从就绪的节点中选择执行后存活字节数增加最少的，
+        ///        其次选择新分配最少的，再次选择最晚就绪的，使同一分支倾向于连续执行。
+        std::vector<count_t> schedule() const {
+            auto nodeCount = _inputs.size();
+            auto remaining = _uses;
+            std::vector<count_t> deps(nodeCount, 0);
+            for (auto const &successors : _successors) {
+                for (auto n : successors) { ++deps[n]; }
+            }
+            // 就绪的节点和它就绪的步数
+            std::vector<std::pair<count_t, count_t>> ready;
+            for (auto n : range0_(nodeCount)) {
+                if (!deps[n]) { ready.emplace_back(n, 0); }
+            }
+
+            std::vector<count_t> ans;
+            ans.reserve(nodeCount);
+            std::vector<count_t> freed;
+            while (!ready.empty()) {
+                auto score = [&](count_t n) {
+                    ptrdiff_t allocated = 0, released = 0;
+                    for (auto e : _outputs[n]) {
+                        if (_owner[e] == e) { allocated += _sizes[e]; }
+                    }
+                    freed.clear();
+                    for (auto e : _inputs[n]) {
+                        auto o = _owner[e];
+                        if (_pinned[o] || std::find(freed.begin(), freed.end(), o) != freed.end()) { continue; }
+                        freed.push_back(o);
+                        auto used = std::count_if(_inputs[n].begin(), _inputs[n].end(),
+                                                  [&](auto i) { return _owner[i] == o; });
+                        if (static_cast<count_t>(used) == remaining[o]) { released += _sizes[o]; }
+                    }
+                    return std::make_pair(allocated - released, allocated);
+                };
+                auto best = ready.begin();
+                auto bestScore = score(best->first);
+                for (auto it = ready.begin() + 1; it != ready.end(); ++it) {
+                    auto s = score(it->first);
+                    if (s < bestScore ||
+                        (s == bestScore && (it->second > best->second ||
+                                            (it->second == best->second && it->first < best->first)))) {
+                        best = it;
+                        bestScore = s;
+                    }
+                }
+                auto n = best->first;
+                ready.erase(best);
+                ans.push_back(n);
+                for (auto e : _inputs[n]) { --remaining[_owner[e]]; }
+                for (auto s : _successors[n]) {
+                    if (!--deps[s]) { ready.emplace_back(s, static_cast<count_t>(ans.size())); }
+                }
+            }
+            ASSERT(ans.size() == nodeCount, "Graph is not a DAG");
+            return ans;
+        }
+    };
+
+    std::pair<size_t, size_t> Graph::reorderForMemory() {
+        auto const &graph = _internal.contiguous();
+        MemoryEstimator estimator(graph);
+
+        std::vector<count_t> original(graph.nodes.size());
+        std::iota(original.begin(), original.end(), 0);
+        auto before = estimator.peak(original);
+
+        auto order = estimator.schedule();
+        auto after = estimator.peak(order);
+        // 启发式的结果不一定更好，不更好时保留原来的顺序
+        if (after >= before) { return {before, before}; }
+
+        // 连续图的节点序号就是链接图中节点的位置，链接图转回连续图时保持节点的顺序
+        auto ok = _internal.linked().reorder(order);
+        ASSERT(ok, "Memory reorder produced an invalid order");
+        return {before, after};
+    }
+
+}// namespace refactor::computation
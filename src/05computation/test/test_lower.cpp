@@ -0,0 +1,56 @@
+#include "computation/graph.h"
+#include "computation/operators/mat_mul.h"
+#include "hardware/device_manager.h"
+#include "kernel/allocators.h"
+#include <gtest/gtest.h>
+#include <numeric>
+
+namespace refactor::computation {
+
+    // y = x · b + x · w，b 是编译时带有数据的全图输入，w 是初始值。
+    TEST(Graph, LowerPrePacksInitializersOnly) {
+        using Linked = graph_topo::LinkedGraph<Node, Edge>;
+        constexpr static dim_t N = 8;
+
+        auto tensor = [] { return Tensor::share(DataType::F32, {N, N}, LayoutType::Others); };
+        auto fill = [](Tensor &t, float v) {
+            auto ptr = reinterpret_cast<float *>(t.malloc());
+            std::fill_n(ptr, t.elementsSize(), v);
+        };
+        auto x = Linked::shareEdge({tensor(), "x"}),
+             b = Linked::shareEdge({tensor(), "b"}),
+             w = Linked::shareEdge({tensor(), "w"});
+        fill(*b->info().tensor, 1);
+        fill(*w->info().tensor, 2);
+
+        Linked g;
+        g.setInputs({x, b});
+        auto xb = g.pushNode({std::make_unique<MatMul>(1, 0, false, false), "xb"}, {Linked::shareEdge({tensor(), "xb"})});
+        xb->connect(0, x);
+        xb->connect(1, b);
+        auto xw = g.pushNode({std::make_unique<MatMul>(1, 1, false, false), "xw"}, {Linked::shareEdge({tensor(), "y"})});
+        xw->connect(0, x);
+        xw->connect(1, w);
+        xw->connect(2, xb->outputs()[0]);
+        g.setOutputs({xw->outputs()[0]});
+        auto graph = Graph(g.intoGraph());
+
+        auto device = hardware::device::fetch(hardware::Device::Type::Cpu);
+        auto kernel = graph.lower(device->type());
+        for (auto const &node : kernel._internal.nodes) {
+            auto prePacked = node.kernel->description().find("pre-packed") != std::string_view::npos;
+            EXPECT_EQ(prePacked, node.name == "xw") << node.name;
+        }
+
+        // 编译后替换 b 的数据，结果必须使用新的值
+        auto stream = kernel.lower(device, kernel::reusableAllocate);
+        auto const &topology = graph.internal().contiguous().topology;
+        std::vector<float> ones(N * N, 1), threes(N * N, 3), y(N * N);
+        stream.setData(topology.globalInputs()[0], ones.data(), ones.size() * sizeof(float));
+        stream.setData(topology.globalInputs()[1], threes.data(), threes.size() * sizeof(float));
+        stream.run();
+        ASSERT_TRUE(stream.copyData(topology.globalOutputs()[0], y.data(), y.size() * sizeof(float)));
+        for (auto v : y) { ASSERT_EQ(v, N * 3 + N * 2); }
+    }
+
+}// namespace refactor::computation
@@ -0,0 +1,73 @@
+#include "computation/graph.h"
+#include "computation/operators/simple_binary.h"
+#include "computation/operators/simple_unary.h"
+#include "hardware/device_manager.h"
+#include "kernel/allocators.h"
+#include <gtest/gtest.h>
+
+namespace refactor::computation {
+
+    // 4 条 3 层的分支从同一个输入出发，依次相加汇合，节点按层排列。
+    // 按层执行时 4 条分支的中间结果同时存活，逐条分支执行并及时相加则最多同时存活 3 个。
+    static Graph breadthFirstBranches() {
+        using Linked = graph_topo::LinkedGraph<Node, Edge>;
+        constexpr static size_t BRANCHES = 4, DEPTH = 3;
+
+        auto tensor = [] { return Tensor::share(DataType::F32, {1, 16, 64, 64}, LayoutType::NCHW); };
+        auto edge = [&](std::string name) { return Linked::shareEdge({tensor(), std::move(name)}); };
+
+        Linked g;
+        auto input = edge("input");
+        g.setInputs({input});
+        std::vector<Rc<Linked::Edge>> heads(BRANCHES, input);
+        for (auto layer : range0_(DEPTH)) {
+            for (auto b : range0_(BRANCHES)) {
+                auto name = fmt::format("relu{}_{}", b, layer);
+                auto n = g.pushNode({std::make_unique<SimpleUnary>(SimpleUnaryType::Relu), name}, {edge(name)});
+                n->connect(0, heads[b]);
+                heads[b] = n->outputs()[0];
+            }
+        }
+        auto sum = heads[0];
+        for (auto b : range(1ul, BRANCHES)) {
+            auto name = fmt::format("add{}", b);
+            auto n = g.pushNode({std::make_unique<SimpleBinary>(SimpleBinaryType::Add), name}, {edge(name)});
+            n->connect(0, sum);
+            n->connect(1, heads[b]);
+            sum = n->outputs()[0];
+        }
+        g.setOutputs({sum});
+        return Graph(g.intoGraph());
+    }
+
+    static size_t plannedPeak(Graph const &g) {
+        auto device = hardware::device::fetch(hardware::Device::Type::Cpu);
+        auto kernel = g.lower(device->type());
+        runtime::Resources res;
+        auto peak = kernel.plan(kernel::reusableAllocate, res).peak;
+        // 只运行分配器得到的峰值与降级出的流一致
+        EXPECT_EQ(peak, kernel.lower(device, kernel::reusableAllocate).memoryReport().peak);
+        return peak;
+    }
+
+    TEST(Graph, ReorderForMemory) {
+        auto g = breadthFirstBranches();
+        auto nodes = g.internal().contiguous().nodes.size();
+        auto actualBefore = plannedPeak(g);
+
+        auto [predictedBefore, predictedAfter] = g.reorderForMemory();
+        auto actualAfter = plannedPeak(g);
+
+        constexpr size_t TENSOR = 16 * 64 * 64 * sizeof(float);
+        EXPECT_EQ(predictedBefore, 5 * TENSOR);
+        EXPECT_EQ(predictedAfter, 3 * TENSOR);
+        EXPECT_LT(actualAfter, actualBefore);
+        EXPECT_EQ(g.internal().contiguous().nodes.size(), nodes);
+
+        // 已经是最优的顺序不再改变
+        auto [before, after] = g.reorderForMemory();
+        EXPECT_EQ(before, predictedAfter);
+        EXPECT_EQ(after, before);
+    }
+
+}// namespace refactor::computation
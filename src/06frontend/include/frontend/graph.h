@@ -7,6 +7,7 @@
 
 namespace refactor::frontend {
 
+    /// @brief 初始化日志，只在第一次调用时生效，可以在多个线程上同时调用。
     void configLog();
 
     class Graph {
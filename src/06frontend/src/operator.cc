@@ -1,5 +1,6 @@
 ﻿#include "frontend/operator.h"
 #include "frontend/graph.h"
+#include <shared_mutex>
 
 namespace refactor::frontend {
 
@@ -87,14 +88,24 @@ namespace refactor::frontend {
     }
 
     static std::unordered_map<std::string, Operator::Builder> OP_BUILDERS;
+    /// @brief 注册通常只在加载模块时发生，构造算子可能在多个线程上同时进行。
+    static std::shared_mutex OP_BUILDERS_MUTEX;
 
     void Operator::register_(std::string opType, Builder builder) {
+        std::unique_lock lock(OP_BUILDERS_MUTEX);
         auto [it, ok] = OP_BUILDERS.try_emplace(std::move(opType), builder);
         ASSERT(ok || it->second == builder, "Duplicate operator type");
     }
     OpBox Operator::build(ModelContext const &ctx, std::string opType, Attributes attributes) {
-        if (auto it = OP_BUILDERS.find(opType); it != OP_BUILDERS.end()) {
-            return it->second(ctx, opType, std::move(attributes));
+        Builder builder = nullptr;
+        {
+            std::shared_lock lock(OP_BUILDERS_MUTEX);
+            if (auto it = OP_BUILDERS.find(opType); it != OP_BUILDERS.end()) {
+                builder = it->second;
+            }
+        }
+        if (builder) {
+            return builder(ctx, opType, std::move(attributes));
         }
         RUNTIME_ERROR(fmt::format("Unknown operator \"{}\"", opType));
     }
@@ -7,7 +7,8 @@ namespace refactor::onnx {
                      Ints const &kernel,
                      OptionalIntsRef const &dilations,
                      OptionalIntsRef const &pads,
-                     OptionalIntsRef const &strides) {
+                     OptionalIntsRef const &strides,
+                     bool ceil) {
         auto dim = input.size();
         if (dim != kernel.size()) {
             return Err(ERROR_MSG("Input shape not support"));
@@ -39,10 +40,19 @@ namespace refactor::onnx {
         Shape ans(dim, DimExpr(1));
         auto r = range0_(dim);
         std::transform(r.begin(), r.end(), ans.begin(),
-                       [&input, &kernel, dim, dilations_, pads_, strides_](auto i) {
+                       [&input, &kernel, dim, dilations_, pads_, strides_, ceil](auto i) {
                            auto d = input[i] + (pads_ ? (pads_[i] + pads_[i + dim]) : 0);
                            auto k = (kernel[i] - 1) * (dilations_ ? dilations_[i] : 1) + 1;
-                           return DimExpr((d - k) / (strides_ ? strides_[i] : 1) + 1);
+                           auto s = strides_ ? strides_[i] : 1;
+                           if (!ceil) {
+                               return DimExpr((d - k) / s + 1);
+                           }
+                           // 向上取整时，最后一个窗口必须从输入或开头的填充内开始
+                           auto ans = (d - k + s - 1) / s + 1;
+                           if ((ans - 1) * s >= input[i] + (pads_ ? pads_[i] : 0)) {
+                               --ans;
+                           }
+                           return DimExpr(ans);
                        });
         return Ok(std::move(ans));
     }
@@ -19,12 +19,14 @@ namespace refactor::onnx {
     /// @param dilations 空洞参数。
     /// @param pads 扩张参数。
     /// @param strides 跳步参数。
+    /// @param ceil 输出尺寸是否向上取整。
     /// @return 池化后的形状。
     ShapeResult pool(SmallInts<4> const &data,
                      Ints const &kernel,
                      OptionalIntsRef const &dilations,
                      OptionalIntsRef const &pads,
-                     OptionalIntsRef const &strides);
+                     OptionalIntsRef const &strides,
+                     bool ceil = false);
 
 }// namespace refactor::onnx
 
@@ -7,20 +7,22 @@ namespace refactor::onnx {
     using Op = GlobalPool;
     using Ty = PoolType;
 
-    Op::GlobalPool(Ty type_)
-        : Operator(), type(type_) {}
+    Op::GlobalPool(Ty type_, Int p_)
+        : Operator(), type(type_), p(p_) {}
 
     auto Op::build(ModelContext const &, std::string_view opType, Attributes attributes) -> OpBox {
+        if (opType == "onnx::GlobalLpPool") {
+            auto p = attributes.getOrInsert("p", {2}).int_();
+            return OpBox(std::make_unique<Op>(Ty::Lp, p));
+        }
+
         EXPECT_NO_ATTRI;
 
         if (opType == "onnx::GlobalAveragePool") {
-            return OpBox(std::make_unique<Op>(Ty::Average));
-        }
-        if (opType == "onnx::GlobalLpPool") {
-            return OpBox(std::make_unique<Op>(Ty::Lp));
+            return OpBox(std::make_unique<Op>(Ty::Average, 2));
         }
         if (opType == "onnx::GlobalMaxPool") {
-            return OpBox(std::make_unique<Op>(Ty::Max));
+            return OpBox(std::make_unique<Op>(Ty::Max, 2));
         }
         RUNTIME_ERROR(fmt::format("Unsupported global pool operator: {}", opType));
     }
@@ -69,6 +71,9 @@ namespace refactor::onnx {
         if (rank < 2) {
             return Err(InferError(ERROR_MSG("Input shape not support")));
         }
+        if (type == Ty::Lp && p <= 0) {
+            return Err(InferError(ERROR_MSG("p must be positive")));
+        }
         Shape output(rank, DimExpr(1));
         output[0] = input.shape[0];
         output[1] = input.shape[1];
@@ -94,7 +99,7 @@ namespace refactor::onnx {
                 UNREACHABLE();
         }
 
-        return std::make_unique<Op_>(type_);
+        return std::make_unique<Op_>(type_, p);
     }
 
 }// namespace refactor::onnx
@@ -9,8 +9,9 @@ namespace refactor::onnx {
 
     struct GlobalPool final : public Operator {
         PoolType type;
+        Int p;
 
-        explicit GlobalPool(PoolType);
+        GlobalPool(PoolType, Int p);
 
         static OpBox build(ModelContext const &, std::string_view, Attributes);
         static size_t typeId(PoolType);
@@ -8,13 +8,18 @@ namespace refactor::onnx {
     using Ty = PoolType;
 
     Op::Pool(Ty type_,
+             bool ceilMode_,
+             bool countIncludePad_,
+             Int p_,
              Ints kernelShape_,
              OptionalInts dilations_,
              OptionalInts pads_,
              OptionalInts strides_)
         : Operator(),
           type(type_),
-          ceilMode(false),
+          ceilMode(ceilMode_),
+          countIncludePad(countIncludePad_),
+          p(p_),
           kernelShape(std::move(kernelShape_)),
           dilations(std::move(dilations_)),
           pads(std::move(pads_)),
@@ -35,6 +40,9 @@ namespace refactor::onnx {
         if (auto opt = attributes.get("strides"); opt) {
             strides.emplace(std::move(opt->get().ints()));
         }
+        auto ceilMode = attributes.getOrInsert("ceil_mode", {0}).int_() != 0;
+        auto countIncludePad = attributes.getOrInsert("count_include_pad", {0}).int_() != 0;
+        auto p = attributes.getOrInsert("p", {2}).int_();
 
         Ty ty;
         if (opType == "onnx::AveragePool") {
@@ -43,13 +51,15 @@ namespace refactor::onnx {
             ty = Ty::Lp;
         } else if (opType == "onnx::MaxPool") {
             ty = Ty::Max;
-            return OpBox(std::make_unique<Op>(Ty::Max, kernelShape, dilations, pads, strides));
         } else {
             UNREACHABLEX(void, "Unsupported global pool operator: {}", opType);
         }
 
         return OpBox(std::make_unique<Op>(
             ty,
+            ceilMode,
+            countIncludePad,
+            p,
             std::move(kernelShape),
             std::move(dilations),
             std::move(pads),
@@ -107,7 +117,10 @@ namespace refactor::onnx {
             input_[i - 2] = d;
         }
 
-        auto res = pool(input_, kernelShape, dilations, pads, strides);
+        if (type == Ty::Lp && p <= 0) {
+            return Err(InferError(ERROR_MSG("p must be positive")));
+        }
+        auto res = pool(input_, kernelShape, dilations, pads, strides, ceilMode);
         if (res.isErr()) {
             return Err(InferError(ERROR_MSG(res.unwrapErr())));
         }
@@ -148,6 +161,8 @@ namespace refactor::onnx {
         return std::make_unique<Op_>(
             type_,
             ceilMode,
+            countIncludePad,
+            p,
             std::move(kernelShape_),
             computation::PoolAttributes(
                 rank - 2,
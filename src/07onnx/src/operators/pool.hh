@@ -9,11 +9,15 @@ namespace refactor::onnx {
 
     struct Pool final : public Operator {
         PoolType type;
-        bool ceilMode;
+        bool ceilMode, countIncludePad;
+        Int p;
         Ints kernelShape;
         OptionalInts dilations, pads, strides;
 
         explicit Pool(PoolType,
+                      bool ceilMode,
+                      bool countIncludePad,
+                      Int p,
                       Ints kernelShape,
                       OptionalInts dilations,
                       OptionalInts pads,
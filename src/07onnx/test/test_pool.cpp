@@ -0,0 +1,34 @@
+﻿#include "../src/operators/pool.hh"
+#include "onnx/operators.h"
+#include <gtest/gtest.h>
+
+using namespace refactor;
+using namespace frontend;
+using namespace onnx;
+
+TEST(infer, Pool) {
+    onnx::register_();
+    auto edges = Edges{
+        {Tensor::share(DataType::F32, Shape{DimExpr(1), DimExpr(192), DimExpr(56), DimExpr(56)}, {}), ""},
+    };
+    count_t inputs[]{0};
+    {
+        auto infered = Pool(PoolType::Max, false, false, 2, {3, 3}, {}, {}, {{2, 2}}).infer(TensorRefs(edges, inputs), {true});
+        if (infered.isErr()) { throw infered.unwrapErr(); }
+        auto y = std::move(infered.unwrap()[0]);
+        ASSERT_EQ(y->shape, (Shape{DimExpr(1), DimExpr(192), DimExpr(27), DimExpr(27)}));
+    }
+    {
+        auto infered = Pool(PoolType::Max, true, false, 2, {3, 3}, {}, {}, {{2, 2}}).infer(TensorRefs(edges, inputs), {true});
+        if (infered.isErr()) { throw infered.unwrapErr(); }
+        auto y = std::move(infered.unwrap()[0]);
+        ASSERT_EQ(y->shape, (Shape{DimExpr(1), DimExpr(192), DimExpr(28), DimExpr(28)}));
+    }
+    {
+        // 向上取整时，完全落在结尾填充中的窗口被舍去
+        auto infered = Pool(PoolType::Average, true, true, 2, {2, 2}, {}, {{0, 0, 3, 3}}, {{2, 2}}).infer(TensorRefs(edges, inputs), {true});
+        if (infered.isErr()) { throw infered.unwrapErr(); }
+        auto y = std::move(infered.unwrap()[0]);
+        ASSERT_EQ(y->shape, (Shape{DimExpr(1), DimExpr(192), DimExpr(29), DimExpr(29)}));
+    }
+}
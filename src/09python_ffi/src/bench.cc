@@ -0,0 +1,148 @@
+﻿#include "bench.h"
+#include "runtime/json.h"
+
+namespace refactor::python_ffi {
+
+    TimeStats TimeStats::from(runtime::Percentiles const &p) noexcept {
+        auto us = [](runtime::Duration d) {
+            return std::chrono::duration<double, std::micro>(d).count();
+        };
+        return {us(p.min), us(p.median), us(p.p99), us(p.max), us(p.mean)};
+    }
+
+    BenchReport::BenchReport(computation::Graph const &graph,
+                             runtime::Stream const &stream,
+                             runtime::BenchResult result,
+                             count_t warmup)
+        : warmup(warmup),
+          iterations(static_cast<count_t>(result.total.size())),
+          latency(TimeStats::from(runtime::Percentiles::of(std::move(result.total)))),
+          nodes(),
+          byOperator(),
+          byKernel(),
+          countersByKernel() {
+        auto const &nodes_ = graph.internal().contiguous().nodes;
+        auto const &routines = stream.graph().nodes;
+        nodes.reserve(nodes_.size());
+        for (auto i : range0_(nodes_.size())) {
+            auto const &[op, name] = nodes_[i];
+            auto time = TimeStats::from(runtime::Percentiles::of(std::move(result.nodes[i])));
+            auto const &routine = routines[i];
+            auto bytes = routine.bytesRead + routine.bytesWritten;
+            // 1 FLOP/us = 1e-3 GFLOP/s
+            auto perUs = [us = time.median](size_t n) { return us > 0 ? n / us * 1e-3 : 0.0; };
+            auto &node = nodes.emplace_back(NodeBench{
+                static_cast<count_t>(i),
+                name,
+                op ? std::string(op->name()) : "",
+                routine.description,
+                time,
+                routine.flops,
+                bytes,
+                perUs(routine.flops),
+                perUs(bytes),
+                std::nullopt,
+            });
+            if (!node.op.empty()) { byOperator[node.op] += time.mean; }
+            if (!node.kernel.empty()) { byKernel[node.kernel] += time.mean; }
+            if (!result.counters.empty()) {
+                node.counters = result.counters[i];
+                if (!node.kernel.empty()) {
+                    auto [it, ok] = countersByKernel.try_emplace(node.kernel, runtime::PerfCounts{});
+                    it->second += result.counters[i];
+                }
+            }
+        }
+    }
+
+    static std::string jsonStats(TimeStats const &t) {
+        return fmt::format(R"({{"min": {}, "median": {}, "p99": {}, "max": {}, "mean": {}}})",
+                           t.min, t.median, t.p99, t.max, t.mean);
+    }
+
+    static std::string jsonCounters(runtime::PerfCounts const &c) {
+        return fmt::format(R"({{"cycles": {}, "instructions": {}, "cache_references": {}, "cache_misses": {}, )"
+                           R"("branches": {}, "branch_misses": {}, "ipc": {}, "cache_miss_rate": {}, "branch_miss_rate": {}}})",
+                           c.cycles, c.instructions, c.cacheReferences, c.cacheMisses,
+                           c.branches, c.branchMisses, c.ipc(), c.cacheMissRate(), c.branchMissRate());
+    }
+
+    static std::string jsonTotals(std::map<std::string, double> const &totals) {
+        std::string ans("{");
+        for (auto const &[key, value] : totals) {
+            if (ans.size() > 1) { ans += ", "; }
+            ans += fmt::format("{}: {}", runtime::jsonString(key), value);
+        }
+        ans += '}';
+        return ans;
+    }
+
+    std::string BenchReport::toJson() const {
+        std::stringstream ss;
+        ss << "{\n"
+           << "  \"unit\": \"us\",\n"
+           << "  \"warmup\": " << warmup << ",\n"
+           << "  \"iterations\": " << iterations << ",\n"
+           << "  \"latency\": " << jsonStats(latency) << ",\n"
+           << "  \"by_operator\": " << jsonTotals(byOperator) << ",\n"
+           << "  \"by_kernel\": " << jsonTotals(byKernel) << ",\n";
+        if (!countersByKernel.empty()) {
+            ss << "  \"counters_by_kernel\": {";
+            auto first = true;
+            for (auto const &[kernel, counters] : countersByKernel) {
+                ss << (std::exchange(first, false) ? "\n" : ",\n")
+                   << "    " << runtime::jsonString(kernel) << ": " << jsonCounters(counters);
+            }
+            ss << "\n  },\n";
+        }
+        ss << "  \"nodes\": [";
+        for (auto const &node : nodes) {
+            ss << (node.index ? ",\n" : "\n")
+               << fmt::format(R"(    {{"index": {}, "name": {}, "op": {}, "kernel": {}, "time": {}, )"
+                              R"("flops": {}, "bytes": {}, "gflops": {}, "gbps": {})",
+                              node.index,
+                              runtime::jsonString(node.name),
+                              runtime::jsonString(node.op),
+                              runtime::jsonString(node.kernel),
+                              jsonStats(node.time),
+                              node.flops, node.bytes, node.gflops, node.gbps);
+            if (node.counters) { ss << ", \"counters\": " << jsonCounters(*node.counters); }
+            ss << '}';
+        }
+        ss << "\n  ]\n}\n";
+        return ss.str();
+    }
+
+    std::string BenchReport::roofline(double peakGflops, double peakGbps) const {
+        // 屋脊点：算术强度高于此值的节点受算力限制，否则受带宽限制
+        auto ridge = peakGbps > 0 ? peakGflops / peakGbps : 0.0;
+        std::stringstream ss;
+        ss << fmt::format("peak {:.1f} GFLOP/s, {:.1f} GB/s, ridge point {:.2f} FLOP/B\n",
+                          peakGflops, peakGbps, ridge)
+           << fmt::format("{:>5} {:<24} {:<16} {:>10} {:>10} {:>10} {:>10} {:>8} {:>7}\n",
+                          "#", "name", "op", "median/us", "FLOP/B", "GFLOP/s", "GB/s", "eff/%", "bound");
+        double totalUs = 0, totalFlops = 0, totalBytes = 0;
+        for (auto const &node : nodes) {
+            if (node.kernel.empty()) { continue; }
+            auto intensity = node.bytes ? static_cast<double>(node.flops) / node.bytes : 0.0;
+            auto computeBound = intensity >= ridge;
+            // 受算力限制的节点相对峰值算力计算效率，否则相对峰值带宽
+            auto efficiency = computeBound
+                                  ? (peakGflops > 0 ? node.gflops / peakGflops : 0.0)
+                                  : (peakGbps > 0 ? node.gbps / peakGbps : 0.0);
+            ss << fmt::format("{:>5} {:<24.24} {:<16.16} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.2f} {:>8.1f} {:>7}\n",
+                              node.index, node.name, node.op, node.time.median,
+                              intensity, node.gflops, node.gbps, efficiency * 100,
+                              computeBound ? "compute" : "memory");
+            totalUs += node.time.median;
+            totalFlops += node.flops;
+            totalBytes += node.bytes;
+        }
+        if (totalUs > 0) {
+            ss << fmt::format("total {:.2f} us, {:.2f} GFLOP/s, {:.2f} GB/s\n",
+                              totalUs, totalFlops / totalUs * 1e-3, totalBytes / totalUs * 1e-3);
+        }
+        return ss.str();
+    }
+
+}// namespace refactor::python_ffi
@@ -0,0 +1,52 @@
+﻿#ifndef PYTHON_FFI_BENCH_H
+#define PYTHON_FFI_BENCH_H
+
+#include "computation/graph.h"
+#include <map>
+#include <optional>
+
+namespace refactor::python_ffi {
+
+    /// @brief 一组计时的统计量，单位为微秒。
+    struct TimeStats {
+        double min, median, p99, max, mean;
+
+        static TimeStats from(runtime::Percentiles const &) noexcept;
+    };
+
+    struct NodeBench {
+        count_t index;
+        std::string name, op, kernel;
+        TimeStats time;
+        /// @brief 内核估计的单次运算量和访存量。
+        size_t flops, bytes;
+        /// @brief 按中位耗时计算的实际算力（GFLOP/s）和带宽（GB/s）。
+        double gflops, gbps;
+        /// @brief 所有迭代累计的硬件计数器读数，未开启或不可用时为空。
+        std::optional<runtime::PerfCounts> counters;
+    };
+
+    /// @brief 基准测试报告，可以导出为 JSON 以便跨模型版本比较。
+    struct BenchReport {
+        count_t warmup, iterations;
+        /// @brief 端到端延迟。
+        TimeStats latency;
+        std::vector<NodeBench> nodes;
+        /// @brief 按算子类型和内核描述汇总的每次推理平均耗时。
+        std::map<std::string, double> byOperator, byKernel;
+        /// @brief 按内核描述汇总的硬件计数器读数，未开启或不可用时为空。
+        std::map<std::string, runtime::PerfCounts> countersByKernel;
+
+        BenchReport(computation::Graph const &,
+                    runtime::Stream const &,
+                    runtime::BenchResult,
+                    count_t warmup);
+
+        std::string toJson() const;
+        /// @brief 以给定的机器峰值算力（GFLOP/s）和带宽（GB/s）生成屋顶线分析表。
+        std::string roofline(double peakGflops, double peakGbps) const;
+    };
+
+}// namespace refactor::python_ffi
+
+#endif// PYTHON_FFI_BENCH_H
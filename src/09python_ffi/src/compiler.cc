@@ -47,7 +47,8 @@ namespace refactor::python_ffi {
     Arc<Executor> Compiler::compileOn(
         Arc<hardware::Device> device,
         std::string allocator,
-        std::vector<std::string> passes) {
+        std::vector<std::string> passes,
+        std::string model) {
         _g.collectVariables();
         std::vector<std::string_view> unknownVariables;
         for (auto const &[_, v] : _g.variables()) {
@@ -76,21 +77,38 @@ namespace refactor::python_ffi {
             computation.layoutPermute();
         }
 
+        auto allocator_ = allocator == "flat"      ? kernel::flatAllocate
+                          : allocator == "planned" ? kernel::plannedAllocate
+                                                   : kernel::reusableAllocate;
+        // 重排前的峰值只运行分配器得到，不取得权重也不分配栈；
+        // 降级时预先变换的权重保留到正式降级结束，从权重缓存中复用
+        std::optional<MemoryReorder> memoryReorder;
+        runtime::Resources planned;
+        if (passes_.contains("mr")) {
+            device->setContext();
+            auto plannedBefore = computation.lower(device->type()).plan(allocator_, planned).peak;
+            auto [predictedBefore, predictedAfter] = computation.reorderForMemory();
+            memoryReorder = MemoryReorder{predictedBefore, predictedAfter, plannedBefore, 0};
+        }
+
         auto kernel = computation.lower(device->type());
-        auto stream = kernel.lower(std::move(device),
-                                   allocator == "flat"
-                                       ? kernel::flatAllocate
-                                       : kernel::reusableAllocate);
+        auto stream = kernel.lower(std::move(device), allocator_, model);
+        if (memoryReorder) {
+            memoryReorder->plannedAfter = stream.memoryReport().peak;
+        }
 
         return std::make_shared<Executor>(
             std::move(computation),
-            std::move(stream));
+            std::move(stream),
+            std::move(model),
+            memoryReorder);
     }
 
     Arc<Executor>
     Compiler::compile(std::string target,
                       std::string allocator,
-                      std::vector<std::string> passes) {
+                      std::vector<std::string> passes,
+                      std::string model) {
         using Target = hardware::Device::Type;
         // clang-format off
         auto target_ = target == "cpu"  ? Target::Cpu
@@ -99,7 +117,8 @@ namespace refactor::python_ffi {
         // clang-format on
         return compileOn(hardware::device::fetch(target_),
                          std::move(allocator),
-                         std::move(passes));
+                         std::move(passes),
+                         std::move(model));
     }
 
     std::vector<pybind11::array>
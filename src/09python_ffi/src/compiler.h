@@ -18,14 +18,17 @@ namespace refactor::python_ffi {
         void setInput(size_t index, pybind11::array);
         void setInputInfo(size_t index, int dataType, DimVec dims);
         std::unordered_set<std::string> fillEdgeInfo(bool calculate);
+        /// @brief `model` 是权重缓存按模型统计时使用的名字。
         Arc<Executor> compileOn(
             Arc<hardware::Device> device,
             std::string allocator,
-            std ::vector<std::string> passes);
+            std ::vector<std::string> passes,
+            std::string model);
         Arc<Executor> compile(
             std::string target,
             std::string allocator,
-            std ::vector<std::string> passes);
+            std ::vector<std::string> passes,
+            std::string model);
 
         std::vector<pybind11::array> zeroInputs() const;
         std::optional<pybind11::array> getTensor(CStr) const;
@@ -9,20 +9,68 @@
 
 namespace refactor::python_ffi {
 
-    Executor::Executor(computation::Graph graph, runtime::Stream stream)
+    RunFuture::RunFuture(Arc<runtime::Pipeline> pipeline,
+                         std::future<void> future,
+                         std::vector<pybind11::array> outputs)
+        : _pipeline(std::move(pipeline)),
+          _future(std::move(future)),
+          _outputs(std::move(outputs)) {}
+
+    RunFuture::~RunFuture() {
+        // 最后一个引用释放时流水线析构并等待执行线程退出，同样不能持有 GIL
+        pybind11::gil_scoped_release release;
+        if (_future.valid()) { _future.wait(); }
+        _pipeline.reset();
+    }
+
+    bool RunFuture::done() const {
+        return !_future.valid() ||
+               _future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    void RunFuture::wait() {
+        if (_future.valid()) {
+            pybind11::gil_scoped_release release;
+            _future.wait();
+        }
+    }
+
+    auto RunFuture::result() -> std::vector<pybind11::array> {
+        if (_future.valid()) {
+            wait();
+            // 失败时只抛出一次，之后 future 不再有效
+            std::exchange(_future, {}).get();
+        }
+        return _outputs;
+    }
+
+    Executor::Executor(computation::Graph graph, runtime::Stream stream, std::string model, std::optional<MemoryReorder> memoryReorder)
+        : Executor(std::make_shared<computation::Graph>(std::move(graph)),
+                   std::move(stream),
+                   std::move(model),
+                   memoryReorder) {}
+    Executor::Executor(decltype(_graph) graph, runtime::Stream stream, std::string model, std::optional<MemoryReorder> memoryReorder)
         : _graph(std::move(graph)),
-          _stream(std::move(stream)) {}
+          _stream(std::move(stream)),
+          _model(std::move(model)),
+          _pipeline(nullptr),
+          _memoryReorder(memoryReorder) {}
+
+    auto Executor::fork() const -> Arc<Executor> {
+        return std::make_shared<Executor>(_graph, _stream.fork(), _model, _memoryReorder);
+    }
 
     void Executor::dispatch(Arc<hardware::Device> device, std::string allocator) {
         auto stream = _graph
-                          .lower(device->type())
+                          ->lower(device->type())
                           .lower(std::move(device),
-                                 allocator == "flat"
-                                     ? kernel::flatAllocate
-                                     : kernel::reusableAllocate);
+                                 allocator == "flat"      ? kernel::flatAllocate
+                                 : allocator == "planned" ? kernel::plannedAllocate
+                                                          : kernel::reusableAllocate,
+                                 _model);
         std::swap(_stream, stream);
         std::vector<uint8_t> buffer;
-        auto const &graph = _graph.internal().contiguous();
+        auto const &graph = _graph->internal().contiguous();
         for (auto i : graph.topology.globalInputs()) {
             auto size = graph.edges[i].tensor->bytesSize();
             buffer.resize(size);
@@ -33,53 +81,100 @@ namespace refactor::python_ffi {
     }
 
     void Executor::setInput(count_t i, pybind11::array data) {
-        i = _graph.internal().contiguous().topology.globalInputs().at(i);
+        i = _graph->internal().contiguous().topology.globalInputs().at(i);
 
-        auto const &tensor = *_graph.internal().contiguous().edges[i].tensor;
+        auto const &tensor = *_graph->internal().contiguous().edges[i].tensor;
         ASSERT(tensor.bytesSize() == static_cast<size_t>(data.nbytes()), "input size mismatch");
         _stream.setData(i, data.data(), data.nbytes());
     }
 
     void Executor::setInputBlob(count_t i, Arc<hardware::Device::Blob> blob) {
-        i = _graph.internal().contiguous().topology.globalInputs().at(i);
+        i = _graph->internal().contiguous().topology.globalInputs().at(i);
 
-        auto const &tensor = *_graph.internal().contiguous().edges[i].tensor;
+        auto const &tensor = *_graph->internal().contiguous().edges[i].tensor;
         ASSERT(tensor.bytesSize() == blob->size(), "input size mismatch");
         _stream.setData(i, std::move(blob));
     }
 
     auto Executor::getOutput(count_t i) const -> pybind11::array {
-        i = _graph.internal().contiguous().topology.globalOutputs().at(i);
+        i = _graph->internal().contiguous().topology.globalOutputs().at(i);
 
-        auto const &tensor = *_graph.internal().contiguous().edges[i].tensor;
+        auto const &tensor = *_graph->internal().contiguous().edges[i].tensor;
         auto ans = pybind11::array(buildNumpyDType(tensor.dataType), std::move(tensor.shape));
         _stream.copyData(i, ans.mutable_data(), ans.nbytes());
         return ans;
     }
 
     auto Executor::getOutputBlob(count_t i) const -> Arc<hardware::Device::Blob> {
-        i = _graph.internal().contiguous().topology.globalOutputs().at(i);
+        i = _graph->internal().contiguous().topology.globalOutputs().at(i);
 
         return _stream.getData(i);
     }
 
+    void Executor::setParallelism(count_t threads) {
+        _stream.setParallelism(threads);
+    }
+
     void Executor::run() {
         _stream.run();
     }
 
-    void Executor::bench(bool sync) {
+    void Executor::setPipelineDepth(count_t depth) {
+        auto old = std::exchange(_pipeline, depth ? std::make_shared<runtime::Pipeline>(_stream, depth) : nullptr);
+        // 已提交的推理由 `RunFuture` 保活旧流水线；
+        // 否则旧流水线在这里析构，等待执行线程退出期间释放 GIL
+        pybind11::gil_scoped_release release;
+        old.reset();
+    }
+
+    auto Executor::submit(std::vector<pybind11::array> inputs) -> Arc<RunFuture> {
+        // 等待槽时释放了 GIL，此后只使用这里取得的流水线
+        auto pipeline = _pipeline;
+        ASSERT(pipeline, "Pipeline depth is not set");
+        auto const &graph = _graph->internal().contiguous();
+        auto globalInputs = graph.topology.globalInputs();
+        ASSERT(inputs.size() == globalInputs.size(), "input count mismatch");
+        for (auto i : range0_(inputs.size())) {
+            auto const &tensor = *graph.edges[globalInputs[i]].tensor;
+            ASSERT(tensor.bytesSize() == static_cast<size_t>(inputs[i].nbytes()), "input size mismatch");
+        }
+
+        // 输出数组由执行线程写入，提交前在持有 GIL 时分配好
+        std::vector<pybind11::array> outputs;
+        std::vector<std::tuple<count_t, void *, size_t>> buffers;
+        for (auto i : graph.topology.globalOutputs()) {
+            auto const &tensor = *graph.edges[i].tensor;
+            auto &array = outputs.emplace_back(buildNumpyDType(tensor.dataType), tensor.shape);
+            buffers.emplace_back(i, array.mutable_data(), array.nbytes());
+        }
+
+        count_t slot;
+        {
+            pybind11::gil_scoped_release release;
+            slot = pipeline->acquire();
+        }
+        auto &stream = pipeline->stream(slot);
+        try {
+            for (auto i : range0_(inputs.size())) {
+                stream.setData(globalInputs[i], inputs[i].data(), inputs[i].nbytes());
+            }
+        } catch (...) {
+            pipeline->release(slot);
+            throw;
+        }
+        auto future = pipeline->submit(slot, [buffers = std::move(buffers)](runtime::Stream &stream) {
+            for (auto [i, ptr, size] : buffers) { stream.copyData(i, ptr, size); }
+        });
+        return std::make_shared<RunFuture>(std::move(pipeline), std::move(future), std::move(outputs));
+    }
+
+    auto Executor::bench(bool sync, count_t warmup, count_t iterations, bool counters) -> BenchReport {
 #ifdef USE_CUDA
-        auto ans = _stream.bench(sync ? kernel::cuda::sync : nullptr);
+        auto ans = _stream.bench(sync ? kernel::cuda::sync : nullptr, warmup, iterations, counters);
 #else
-        auto ans = _stream.bench(nullptr);
+        auto ans = _stream.bench(nullptr, warmup, iterations, counters);
 #endif// USE_CUDA
-        auto const &nodes = _graph.internal().contiguous().nodes;
-        for (auto i : range0_(nodes.size())) {
-            fmt::println("{} {} {}",
-                         i,
-                         nodes[i].name,
-                         std::chrono::duration_cast<std::chrono::microseconds>(ans[i]).count());
-        }
+        return BenchReport(*_graph, _stream, std::move(ans), warmup);
     }
 
     static void writeBin(std::ofstream os, char const *ptr, size_t size) {
@@ -192,7 +287,7 @@ namespace refactor::python_ffi {
 
         size_t dataIdx = 0;
 
-        auto const &graph = _graph.internal().contiguous();
+        auto const &graph = _graph->internal().contiguous();
         auto it = graph.topology.begin();
         _stream.trace([&](count_t nodeIdx, void const *const *inputs, void const *const *outputs) {
             auto [nodeIdx_, i_, o_] = *it++;
@@ -247,8 +342,39 @@ namespace refactor::python_ffi {
         });
     }
 
+    void Executor::setProfiling(bool enable) {
+        _stream.setTimeline(enable ? std::make_shared<runtime::Timeline>() : nullptr);
+    }
+
+    void Executor::dumpTimeline(std::string path) const {
+        auto const &timeline = _stream.timeline();
+        ASSERT(timeline, "Profiling is not enabled");
+        std::ofstream os(path);
+        ASSERT(os, "Failed to open \"{}\"", path);
+        timeline->writeChromeTrace(os, _stream.graph());
+    }
+
+    auto Executor::memoryReport() const -> runtime::MemoryReport {
+        return _stream.memoryReport();
+    }
+
+    auto Executor::memoryReorder() const -> std::optional<MemoryReorder> {
+        return _memoryReorder;
+    }
+
+    void Executor::dumpMemoryPlan(std::string path) const {
+        std::ofstream os(path);
+        ASSERT(os, "Failed to open \"{}\"", path);
+        auto report = _stream.memoryReport();
+        if (path.ends_with(".json")) {
+            report.writeJson(os);
+        } else {
+            report.writeHtml(os);
+        }
+    }
+
     void Executor::debugInfo() const noexcept {
-        auto const &nodes = _graph.internal().contiguous().nodes;
+        auto const &nodes = _graph->internal().contiguous().nodes;
         for (auto i : range0_(nodes.size())) {
             fmt::println("{}. {}", i, nodes[i].name);
         }
@@ -1,26 +1,78 @@
 ﻿#ifndef PYTHON_FFI_EXECUTOR_H
 #define PYTHON_FFI_EXECUTOR_H
 
+#include "bench.h"
 #include "computation/graph.h"
 #include "functions.h"
+#include "runtime/pipeline.h"
 
 namespace refactor::python_ffi {
     using SharedTensor = Arc<frontend::Tensor>;
 
+    /// @brief 一次异步推理的结果。
+    ///        输出数组在提交时分配，执行线程在推理结束后直接写入，不需要 GIL。
+    class RunFuture {
+        /// @brief 推理提交到的流水线，执行器更换流水线后仍由在飞的推理保活。
+        Arc<runtime::Pipeline> _pipeline;
+        std::future<void> _future;
+        std::vector<pybind11::array> _outputs;
+
+    public:
+        RunFuture(Arc<runtime::Pipeline>, std::future<void>, std::vector<pybind11::array>);
+        /// @brief 执行线程仍可能写入输出，析构前必须等待推理结束。等待期间释放 GIL。
+        ~RunFuture();
+
+        bool done() const;
+        /// @brief 等待推理结束，等待期间释放 GIL。
+        void wait();
+        /// @brief 等待推理结束并返回全部输出。例程抛出的异常在这里重新抛出。
+        auto result() -> std::vector<pybind11::array>;
+    };
+
+    /// @brief 编译选项 `"mr"` 的效果：重排前后按张量大小估计的峰值，以及所选分配器为前后两种顺序规划出的峰值。
+    struct MemoryReorder {
+        size_t predictedBefore, predictedAfter, plannedBefore, plannedAfter;
+    };
+
+    /// @brief 执行器。`run`、`bench`、`dispatch` 和 `trace` 执行期间释放 GIL。
+    ///        同一个执行器不能在多个线程上同时使用；
+    ///        不同的执行器（包括分叉出的）可以在各自的线程上并行运行。
     class Executor {
-        computation::Graph _graph;
+        /// @brief 分叉出的执行器共享同一个计算图。
+        Arc<computation::Graph> _graph;
         runtime::Stream _stream;
+        /// @brief 编译时给出的模型名，重新降级时权重仍记在这个模型下。
+        std::string _model;
+        /// @brief 异步推理的流水线，未设置深度时为空。
+        Arc<runtime::Pipeline> _pipeline;
+        /// @brief 编译时重排节点的效果，没有重排时为空。
+        std::optional<MemoryReorder> _memoryReorder;
 
     public:
-        Executor(computation::Graph, runtime::Stream);
+        Executor(computation::Graph, runtime::Stream, std::string model, std::optional<MemoryReorder> = std::nullopt);
+        Executor(decltype(_graph), runtime::Stream, std::string model, std::optional<MemoryReorder> = std::nullopt);
+        auto fork() const -> Arc<Executor>;
         void dispatch(Arc<hardware::Device>, std::string allocator);
         void setInput(count_t, pybind11::array);
         void setInputBlob(count_t, Arc<hardware::Device::Blob>);
         auto getOutput(count_t) const -> pybind11::array;
         auto getOutputBlob(count_t) const -> Arc<hardware::Device::Blob>;
+        void setParallelism(count_t);
         void run();
-        void bench(bool sync);
+        /// @brief 设置异步推理同时在飞的数量，为 0 时关闭异步推理。
+        ///        流水线从当前的流分叉，之后对执行器的设置需要重新调用才会生效。
+        void setPipelineDepth(count_t);
+        /// @brief 以给定的全局输入提交一次异步推理，所有槽都被占用时阻塞。
+        auto submit(std::vector<pybind11::array>) -> Arc<RunFuture>;
+        auto bench(bool sync, count_t warmup, count_t iterations, bool counters) -> BenchReport;
         void trace(std::string path, std::string format);
+        void setProfiling(bool);
+        void dumpTimeline(std::string path) const;
+        auto memoryReport() const -> runtime::MemoryReport;
+        /// @brief 编译时记录的结果，`dispatch` 不会更新它。
+        auto memoryReorder() const -> std::optional<MemoryReorder>;
+        /// @brief 写出内存规划，扩展名为 .json 时写 JSON，否则写带 SVG 生存期图的 HTML。
+        void dumpMemoryPlan(std::string path) const;
         void debugInfo() const noexcept;
     };
 
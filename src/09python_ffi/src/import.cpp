@@ -1,7 +1,6 @@
 ﻿#include "import.h"
 #include "hardware/device_manager.h"
 #include <execution>
-#include <fstream>
 
 namespace refactor::python_ffi {
     using namespace frontend;
@@ -41,16 +40,15 @@ namespace refactor::python_ffi {
         int dataType,
         std::vector<int64_t> shape,
         std::string file,
-        int64_t offset) {
+        int64_t offset,
+        bool prefetch) {
         Shape shape_(shape.size(), DimExpr(1));
         std::transform(std::execution::unseq,
                        shape.begin(), shape.end(), shape_.begin(),
                        [](auto d) { return DimExpr(d); });
         auto ans = Tensor::share(*DataType::parse(dataType), std::move(shape_), {});
-        std::ifstream stream(file, std::ios::binary);
-        ASSERT(stream.is_open(), "No such file: \"{}\"", file);
-        stream.seekg(offset);
-        stream.read(static_cast<char *>(ans->malloc()), ans->bytesSize());
+        // 权重直接映射外部数据文件，CPU 上推理时不再复制
+        ans->data = kernel::Blob::map(file, offset, ans->bytesSize(), prefetch);
         return ans;
     }
 
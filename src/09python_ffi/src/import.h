@@ -19,7 +19,8 @@ namespace refactor::python_ffi {
         int dataType,
         std::vector<int64_t> shape,
         std::string file,
-        int64_t offset);
+        int64_t offset,
+        bool prefetch);
     SharedOp makeOp(AttributeMap, Name opType, AttributeMap);
     Arc<Compiler> makeCompiler(
         std::unordered_map<Name, std::pair<NameVec, NameVec>> topology,
@@ -1,6 +1,7 @@
 ﻿#include "communication/operators.h"
 #include "hardware/device.h"
 #include "import.h"
+#include "kernel/weight_cache.h"
 #include "llm/operators.h"
 #include "onnx/operators.h"
 #include <pybind11/stl.h>// keep this line to convert stl types
@@ -12,6 +13,8 @@ namespace refactor::python_ffi {
 
     PYBIND11_MODULE(python_ffi, m) {
         using return_ = py::return_value_policy;
+        // 耗时的编译和推理调用释放 GIL，多个 Python 线程可以同时驱动不同的执行器
+        using release_ = py::call_guard<py::gil_scoped_release>;
         using namespace frontend;
 
         onnx::register_();
@@ -31,7 +34,22 @@ namespace refactor::python_ffi {
             .def("_make_tensor"    , &makeTensor                 , return_::move      )
             .def("_make_data"      , &makeTensorWithData         , return_::move      )
             .def("_make_data_ex"   , &makeTensorWithExternalData , return_::move      )
-            .def("_make_compiler"  , &makeCompiler               , return_::move      );
+            .def("_make_compiler"  , &makeCompiler               , return_::move      )
+            .def("weight_cache_stats"     , [] { return kernel::WeightCache::instance().stats(); })
+            .def("set_weight_cache_budget", [](size_t bytes) { kernel::WeightCache::instance().setBudget(bytes); })
+            .def("clear_weight_cache"     , [] { kernel::WeightCache::instance().clear(); });
+
+        py::class_<kernel::WeightCacheStats>(m, "WeightCacheStats")
+            .def_readonly("resident"   , &kernel::WeightCacheStats::resident  )
+            .def_readonly("entries"    , &kernel::WeightCacheStats::entries   )
+            .def_readonly("pinned"     , &kernel::WeightCacheStats::pinned    )
+            .def_readonly("budget"     , &kernel::WeightCacheStats::budget    )
+            .def_readonly("hits"       , &kernel::WeightCacheStats::hits      )
+            .def_readonly("misses"     , &kernel::WeightCacheStats::misses    )
+            .def_readonly("evictions"  , &kernel::WeightCacheStats::evictions )
+            .def_readonly("derived"    , &kernel::WeightCacheStats::derived   )
+            .def_readonly("derived_entries", &kernel::WeightCacheStats::derivedEntries)
+            .def_readonly("models"     , &kernel::WeightCacheStats::models    );
 
         py::class_<Compiler , Arc<Compiler>>(m, "Compiler" )
             .def("substitute"      , &Compiler::substitute       , return_::automatic )
@@ -40,19 +58,108 @@ namespace refactor::python_ffi {
             .def("check_variables" , &Compiler::fillEdgeInfo     , return_::move      )
             .def("zero_inputs"     , &Compiler::zeroInputs       , return_::move      )
             .def("get_tensor"      , &Compiler::getTensor        , return_::move      )
-            .def("compile"         , &Compiler::compile          , return_::move      )
-            .def("compile_on"      , &Compiler::compileOn        , return_::move      )
+            .def("compile"         , &Compiler::compile          , return_::move      , release_(),
+                 py::arg("target"), py::arg("allocator"), py::arg("passes"), py::arg("model") = "")
+            .def("compile_on"      , &Compiler::compileOn        , return_::move      , release_(),
+                 py::arg("device"), py::arg("allocator"), py::arg("passes"), py::arg("model") = "")
             .def("serialize"       , &Compiler::serialize        , return_::automatic );
 
+        py::class_<TimeStats  >(m, "TimeStats"  )
+            .def_readonly("min"    , &TimeStats::min    )
+            .def_readonly("median" , &TimeStats::median )
+            .def_readonly("p99"    , &TimeStats::p99    )
+            .def_readonly("max"    , &TimeStats::max    )
+            .def_readonly("mean"   , &TimeStats::mean   );
+
+        py::class_<runtime::PerfCounts>(m, "PerfCounts")
+            .def_readonly("cycles"           , &runtime::PerfCounts::cycles          )
+            .def_readonly("instructions"     , &runtime::PerfCounts::instructions    )
+            .def_readonly("cache_references" , &runtime::PerfCounts::cacheReferences )
+            .def_readonly("cache_misses"     , &runtime::PerfCounts::cacheMisses     )
+            .def_readonly("branches"         , &runtime::PerfCounts::branches        )
+            .def_readonly("branch_misses"    , &runtime::PerfCounts::branchMisses    )
+            .def_property_readonly("ipc"             , &runtime::PerfCounts::ipc            )
+            .def_property_readonly("cache_miss_rate" , &runtime::PerfCounts::cacheMissRate  )
+            .def_property_readonly("branch_miss_rate", &runtime::PerfCounts::branchMissRate );
+
+        py::class_<NodeBench  >(m, "NodeBench"  )
+            .def_readonly("index"  , &NodeBench::index  )
+            .def_readonly("name"   , &NodeBench::name   )
+            .def_readonly("op"     , &NodeBench::op     )
+            .def_readonly("kernel" , &NodeBench::kernel )
+            .def_readonly("time"   , &NodeBench::time   )
+            .def_readonly("flops"  , &NodeBench::flops  )
+            .def_readonly("bytes"  , &NodeBench::bytes  )
+            .def_readonly("gflops" , &NodeBench::gflops )
+            .def_readonly("gbps"   , &NodeBench::gbps   )
+            .def_readonly("counters", &NodeBench::counters);
+
+        py::class_<BenchReport>(m, "BenchReport")
+            .def_readonly("warmup"     , &BenchReport::warmup     )
+            .def_readonly("iterations" , &BenchReport::iterations )
+            .def_readonly("latency"    , &BenchReport::latency    )
+            .def_readonly("nodes"      , &BenchReport::nodes      )
+            .def_readonly("by_operator", &BenchReport::byOperator )
+            .def_readonly("by_kernel"  , &BenchReport::byKernel   )
+            .def_readonly("counters_by_kernel", &BenchReport::countersByKernel)
+            .def("to_json"             , &BenchReport::toJson     , return_::move      )
+            .def("roofline"            , &BenchReport::roofline   , return_::move      ,
+                 py::arg("peak_gflops"), py::arg("peak_gbps"));
+
+        py::class_<runtime::MemoryBuffer>(m, "MemoryBuffer")
+            .def_property_readonly("kind"  , [](runtime::MemoryBuffer const &b) {
+                return b.kind == runtime::MemoryBuffer::Kind::Edge ? "edge" : "workspace"; })
+            .def_readonly("index"  , &runtime::MemoryBuffer::index  )
+            .def_readonly("name"   , &runtime::MemoryBuffer::name   )
+            .def_readonly("offset" , &runtime::MemoryBuffer::offset )
+            .def_readonly("size"   , &runtime::MemoryBuffer::size   )
+            .def_readonly("first"  , &runtime::MemoryBuffer::first  )
+            .def_readonly("last"   , &runtime::MemoryBuffer::last   );
+
+        py::class_<runtime::MemoryReport>(m, "MemoryReport")
+            .def_readonly("stack"        , &runtime::MemoryReport::stack         )
+            .def_readonly("peak"         , &runtime::MemoryReport::peak          )
+            .def_readonly("peak_step"    , &runtime::MemoryReport::peakStep      )
+            .def_readonly("fragmentation", &runtime::MemoryReport::fragmentation )
+            .def_readonly("live"         , &runtime::MemoryReport::live          )
+            .def_readonly("buffers"      , &runtime::MemoryReport::buffers       )
+            .def("at_peak"               , &runtime::MemoryReport::atPeak        , return_::move);
+
+        py::class_<MemoryReorder>(m, "MemoryReorder")
+            .def_readonly("predicted_before", &MemoryReorder::predictedBefore)
+            .def_readonly("predicted_after" , &MemoryReorder::predictedAfter )
+            .def_readonly("planned_before"  , &MemoryReorder::plannedBefore  )
+            .def_readonly("planned_after"   , &MemoryReorder::plannedAfter   );
+
+        py::class_<RunFuture, Arc<RunFuture>>(m, "RunFuture")
+            .def("done"            , &RunFuture::done            , return_::automatic )
+            .def("wait"            , &RunFuture::wait            , return_::automatic )
+            .def("result"          , &RunFuture::result          , return_::move      )
+            .def("__await__"       , [](py::object self) {
+                // 在默认线程池中等待，不阻塞事件循环
+                auto loop = py::module_::import("asyncio").attr("get_running_loop")();
+                return loop.attr("run_in_executor")(py::none(), self.attr("result")).attr("__await__")();
+            });
+
         py::class_<Executor , Arc<Executor>>(m, "Executor" )
-            .def("dispatch"        , &Executor::dispatch         , return_::automatic )
+            .def("fork"            , &Executor::fork             , return_::move      )
+            .def("dispatch"        , &Executor::dispatch         , return_::automatic , release_())
             .def("set_input"       , &Executor::setInput         , return_::automatic )
             .def("set_input_blob"  , &Executor::setInputBlob     , return_::automatic )
             .def("get_output"      , &Executor::getOutput        , return_::move      )
             .def("get_output_blob" , &Executor::getOutputBlob    , return_::move      )
-            .def("run"             , &Executor::run              , return_::automatic )
-            .def("bench"           , &Executor::bench            , return_::automatic )
-            .def("trace"           , &Executor::trace            , return_::automatic )
+            .def("set_parallelism" , &Executor::setParallelism   , return_::automatic )
+            .def("run"             , &Executor::run              , return_::automatic , release_())
+            .def("set_pipeline_depth", &Executor::setPipelineDepth, return_::automatic )
+            .def("submit"          , &Executor::submit           , return_::move      )
+            .def("bench"           , &Executor::bench            , return_::move      , release_(),
+                 py::arg("sync") = false, py::arg("warmup") = 10, py::arg("iterations") = 100, py::arg("counters") = false)
+            .def("trace"           , &Executor::trace            , return_::automatic , release_())
+            .def("set_profiling"   , &Executor::setProfiling     , return_::automatic )
+            .def("dump_timeline"   , &Executor::dumpTimeline     , return_::automatic )
+            .def("memory_report"   , &Executor::memoryReport     , return_::move      )
+            .def("memory_reorder"  , &Executor::memoryReorder    , return_::move      )
+            .def("dump_memory_plan", &Executor::dumpMemoryPlan   , return_::automatic )
             .def("dbg"             , &Executor::debugInfo        , return_::automatic );
 
         // clang-format on
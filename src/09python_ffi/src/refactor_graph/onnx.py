@@ -12,16 +12,21 @@ from python_ffi import (
     _make_tensor,
     _make_compiler,
     _make_operator,
+    weight_cache_stats,
+    set_weight_cache_budget,
+    clear_weight_cache,
 )
 
 
-def make_compiler(model: ModelProto, external_data_path: str = "") -> Compiler:
+def make_compiler(
+    model: ModelProto, external_data_path: str = "", prefetch: bool = False
+) -> Compiler:
     edges: dict[str, Tensor] = dict()
     for tensor in model.graph.initializer:
         if tensor.data_location == 1:
             edi = ExternalDataInfo(tensor)
             print(
-                "load {:> 10} bytes from {} for {}".format(
+                "map {:> 10} bytes from {} for {}".format(
                     edi.length if edi.length != None else "all",
                     edi.location,
                     tensor.name,
@@ -32,6 +37,7 @@ def make_compiler(model: ModelProto, external_data_path: str = "") -> Compiler:
                 tensor.dims,
                 external_data_path + "/" + edi.location,
                 edi.offset if edi.offset != None else 0,
+                prefetch,
             )
         else:
             edges[tensor.name] = _make_data(to_array(tensor))